@@ -35,10 +35,10 @@
 #include "stmlib/dsp/filter.h"
 #include "stmlib/dsp/parameter_interpolator.h"
 #include "stmlib/dsp/units.h"
-#include "stmlib/utils/random.h"
 
 #include "plaits/dsp/dsp.h"
 #include "plaits/dsp/oscillator/sine_oscillator.h"
+#include "plaits/dsp/voice_random.h"
 
 namespace plaits {
 
@@ -166,7 +166,7 @@ class AnalogSnareDrum {
       shell = stmlib::SoftClip(shell);
       
       // C56 / R194 / Q48 / C54 / R188 / D54
-      float noise = 2.0f * stmlib::Random::GetFloat() - 1.0f;
+      float noise = 2.0f * VoiceRandom::GetFloat() - 1.0f;
       if (noise < 0.0f) noise = 0.0f;
       noise_envelope_ *= noise_envelope_decay;
       noise *= (sustain ? sustain_gain_value : noise_envelope_) * snappy * 2.0f;
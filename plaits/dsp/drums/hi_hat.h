@@ -37,7 +37,6 @@
 #include "stmlib/dsp/filter.h"
 #include "stmlib/dsp/parameter_interpolator.h"
 #include "stmlib/dsp/units.h"
-#include "stmlib/utils/random.h"
 
 #include "plaits/dsp/dsp.h"
 #include "plaits/dsp/oscillator/oscillator.h"
@@ -177,6 +176,7 @@ class HiHat {
     hpf_.Init();
   }
   
+  // noise holds size uniform random values.
   void Render(
       bool sustain,
       bool trigger,
@@ -185,6 +185,7 @@ class HiHat {
       float tone,
       float decay,
       float noisiness,
+      const float* noise,
       float* temp_1,
       float* temp_2,
       float* out,
@@ -221,7 +222,7 @@ class HiHat {
       noise_clock_ += noise_f;
       if (noise_clock_ >= 1.0f) {
         noise_clock_ -= 1.0f;
-        noise_sample_ = stmlib::Random::GetFloat() - 0.5f;
+        noise_sample_ = noise[i] - 0.5f;
       }
       out[i] += noisiness * (noise_sample_ - out[i]);
     }
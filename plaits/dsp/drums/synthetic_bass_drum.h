@@ -32,9 +32,9 @@
 
 #include "stmlib/dsp/dsp.h"
 #include "stmlib/dsp/units.h"
-#include "stmlib/utils/random.h"
 
 #include "plaits/dsp/dsp.h"
+#include "plaits/dsp/voice_random.h"
 #include "plaits/resources.h"
 
 namespace plaits {
@@ -76,7 +76,7 @@ class SyntheticBassDrumAttackNoise {
   }
   
   float Render() {
-    float sample = stmlib::Random::GetFloat();
+    float sample = VoiceRandom::GetFloat();
     ONE_POLE(lp_, sample, 0.05f);
     ONE_POLE(hp_, lp_, 0.005f);
     return lp_ - hp_;
@@ -102,6 +102,8 @@ class SyntheticBassDrum {
     fm_lp_ = 0.0f;
     body_env_lp_ = 0.0f;
     body_env_ = 0.0f;
+    transient_env_ = 0.0f;
+    transient_env_lp_ = 0.0f;
     body_env_pulse_width_ = 0;
     fm_pulse_width_ = 0;
     tone_lp_ = 0.0f;
@@ -170,7 +172,7 @@ class SyntheticBassDrum {
         size);
     
     while (size--) {
-      ONE_POLE(phase_noise_, stmlib::Random::GetFloat() - 0.5f, 0.002f);
+      ONE_POLE(phase_noise_, VoiceRandom::GetFloat() - 0.5f, 0.002f);
       
       float mix = 0.0f;
 
@@ -40,6 +40,7 @@
 #include "stmlib/dsp/units.h"
 
 #include "plaits/dsp/dsp.h"
+#include "plaits/dsp/voice_random.h"
 
 namespace plaits {
 
@@ -169,7 +170,7 @@ class SyntheticSnareDrum {
       drum *= drum_amplitude_ * drum_level;
       drum = drum_lp_.Process<stmlib::FILTER_MODE_LOW_PASS>(drum);
       
-      float noise = stmlib::Random::GetFloat();
+      float noise = VoiceRandom::GetFloat();
       float snare = snare_lp_.Process<stmlib::FILTER_MODE_LOW_PASS>(noise);
       snare = snare_hp_.Process<stmlib::FILTER_MODE_HIGH_PASS>(snare);
       snare = (snare + 0.1f) * (snare_amplitude_ + fm_) * snare_level;
@@ -29,6 +29,8 @@
 #ifndef PLAITS_DSP_DSP_H_
 #define PLAITS_DSP_DSP_H_
 
+#include <cmath>
+
 #include "stmlib/stmlib.h"
 
 namespace plaits {
@@ -47,8 +49,30 @@ static const float kSampleRate = 48000.0f;
 static const float kCorrectedSampleRate = 47872.34f;
 const float a0 = (440.0f / 8.0f) / kCorrectedSampleRate;
 
-const size_t kMaxBlockSize = 24;
-const size_t kBlockSize = 12;
+// Block size of the audio DAC loop, for which all the coefficients of the
+// filters and envelopes updated once per block have been tuned.
+const size_t kHardwareBlockSize = 12;
+
+// Host builds can render larger blocks, to amortize the per-block setup of
+// the engines (e.g. -DPLAITS_BLOCK_SIZE=256 for offline rendering).
+#ifdef PLAITS_BLOCK_SIZE
+const size_t kBlockSize = PLAITS_BLOCK_SIZE;
+#else
+const size_t kBlockSize = kHardwareBlockSize;
+#endif  // PLAITS_BLOCK_SIZE
+
+const size_t kMaxBlockSize = 2 * kBlockSize;
+
+// Coefficient of a one-pole filter updated once every kBlockSize samples,
+// with the same time constant as coefficient at the hardware block size.
+inline float BlockRateCoefficient(float coefficient) {
+  if (kBlockSize == kHardwareBlockSize) {
+    return coefficient;
+  }
+  return 1.0f - powf(
+      1.0f - coefficient,
+      static_cast<float>(kBlockSize) / static_cast<float>(kHardwareBlockSize));
+}
 
 }  // namespace plaits
 
@@ -89,7 +89,7 @@ void AdditiveEngine::UpdateAmplitudes(
     // normalized spectrum, and both of them cause more annoyances than this
     // "incorrect" solution.
     
-    ONE_POLE(amplitudes[j], gain, 0.001f);
+    ONE_POLE(amplitudes[j], gain, BlockRateCoefficient(0.001f));
     sum += amplitudes[j];
   }
 
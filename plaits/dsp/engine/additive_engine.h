@@ -50,6 +50,14 @@ class AdditiveEngine : public Engine {
       float* aux,
       size_t size,
       bool* already_enveloped);
+  
+#ifdef TEST
+  void set_harmonic_silence_threshold(float threshold) {
+    for (int i = 0; i < kNumHarmonicOscillators; ++i) {
+      harmonic_oscillator_[i].set_silence_threshold(threshold);
+    }
+  }
+#endif  // TEST
  
  private:
   void UpdateAmplitudes(
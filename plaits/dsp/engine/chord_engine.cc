@@ -205,8 +205,8 @@ void ChordEngine::Render(
     float* aux,
     size_t size,
     bool* already_enveloped) {
-  ONE_POLE(morph_lp_, parameters.morph, 0.1f);
-  ONE_POLE(timbre_lp_, parameters.timbre, 0.1f);
+  ONE_POLE(morph_lp_, parameters.morph, BlockRateCoefficient(0.1f));
+  ONE_POLE(timbre_lp_, parameters.timbre, BlockRateCoefficient(0.1f));
 
   const int chord_index = chord_index_quantizer_.Process(
       parameters.harmonics * 1.02f, kChordNumChords);
@@ -46,6 +46,9 @@ void FMEngine::Init(BufferAllocator* allocator) {
   previous_amount_ = 0.0f;
   previous_feedback_ = 0.0f;
   previous_sample_ = 0.0f;
+  
+  sub_fir_ = 0.0f;
+  carrier_fir_ = 0.0f;
 }
 
 void FMEngine::Reset() {
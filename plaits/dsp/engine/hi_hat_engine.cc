@@ -34,10 +34,12 @@ namespace plaits {
 using namespace stmlib;
 
 void HiHatEngine::Init(BufferAllocator* allocator) {
+  random_.Init(0x48484154);
   hi_hat_1_.Init();
   hi_hat_2_.Init();
   temp_buffer_[0] = allocator->Allocate<float>(kMaxBlockSize);
   temp_buffer_[1] = allocator->Allocate<float>(kMaxBlockSize);
+  temp_buffer_[2] = allocator->Allocate<float>(kMaxBlockSize);
 }
 
 void HiHatEngine::Reset() {
@@ -52,6 +54,7 @@ void HiHatEngine::Render(
     bool* already_enveloped) {
   const float f0 = NoteToFrequency(parameters.note);
   
+  random_.FillUniform(temp_buffer_[2], size);
   hi_hat_1_.Render(
       parameters.trigger & TRIGGER_UNPATCHED,
       parameters.trigger & TRIGGER_RISING_EDGE,
@@ -60,11 +63,13 @@ void HiHatEngine::Render(
       parameters.timbre,
       parameters.morph,
       parameters.harmonics,
+      temp_buffer_[2],
       temp_buffer_[0],
       temp_buffer_[1],
       out,
       size);
   
+  random_.FillUniform(temp_buffer_[2], size);
   hi_hat_2_.Render(
       parameters.trigger & TRIGGER_UNPATCHED,
       parameters.trigger & TRIGGER_RISING_EDGE,
@@ -73,6 +78,7 @@ void HiHatEngine::Render(
       parameters.timbre,
       parameters.morph,
       parameters.harmonics,
+      temp_buffer_[2],
       temp_buffer_[0],
       temp_buffer_[1],
       aux,
@@ -32,6 +32,7 @@
 
 #include "plaits/dsp/drums/hi_hat.h"
 #include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/noise/block_random_generator.h"
 
 namespace plaits {
   
@@ -49,10 +50,11 @@ class HiHatEngine : public Engine {
       bool* already_enveloped);
 
  private:
+  BlockRandomGenerator random_;
   HiHat<SquareNoise, SwingVCA, true> hi_hat_1_;
   HiHat<RingModNoise, LinearVCA, false> hi_hat_2_;
   
-  float* temp_buffer_[2];
+  float* temp_buffer_[3];
   
   DISALLOW_COPY_AND_ASSIGN(HiHatEngine);
 };
@@ -36,6 +36,7 @@ using namespace std;
 using namespace stmlib;
 
 void NoiseEngine::Init(BufferAllocator* allocator) {
+  random_.Init(0x4e4f4953);
   clocked_noise_[0].Init();
   clocked_noise_[1].Init();
   lp_hp_filter_.Init();
@@ -70,8 +71,11 @@ void NoiseEngine::Render(
       parameters.timbre * (128.0f - clock_lowest_note) + clock_lowest_note);
   const float q = 0.5f * SemitonesToRatio(parameters.morph * 120.0f);
   const bool sync = parameters.trigger & TRIGGER_RISING_EDGE;
-  clocked_noise_[0].Render(sync, clock_f, aux, size);
-  clocked_noise_[1].Render(sync, clock_f * f1 / f0, temp_buffer_, size);
+  random_.FillBipolar(aux, size);
+  clocked_noise_[0].Render(sync, clock_f, aux, aux, size);
+  random_.FillBipolar(temp_buffer_, size);
+  clocked_noise_[1].Render(
+      sync, clock_f * f1 / f0, temp_buffer_, temp_buffer_, size);
   
   ParameterInterpolator f0_modulation(&previous_f0_, f0, size);
   ParameterInterpolator f1_modulation(&previous_f1_, f1, size);
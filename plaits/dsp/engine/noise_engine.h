@@ -32,6 +32,7 @@
 #include "stmlib/dsp/filter.h"
 
 #include "plaits/dsp/engine/engine.h"
+#include "plaits/dsp/noise/block_random_generator.h"
 #include "plaits/dsp/noise/clocked_noise.h"
 
 namespace plaits {
@@ -50,6 +51,7 @@ class NoiseEngine : public Engine {
       bool* already_enveloped);
   
  private:
+  BlockRandomGenerator random_;
   ClockedNoise clocked_noise_[2];
   stmlib::Svf lp_hp_filter_;
   stmlib::Svf bp_filter_[2];
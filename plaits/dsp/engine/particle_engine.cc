@@ -36,6 +36,7 @@ using namespace std;
 using namespace stmlib;
 
 void ParticleEngine::Init(BufferAllocator* allocator) {
+  random_.Init(0x50415254);
   for (int i = 0; i < kNumParticles; ++i) {
     particle_[i].Init();
   }
@@ -73,7 +74,10 @@ void ParticleEngine::Render(
   fill(&out[0], &out[size], 0.0f);
   fill(&aux[0], &aux[size], 0.0f);
   
+  // The diffuser takes all the engine RAM, so the noise lives on the stack.
+  float noise[kMaxBlockSize + 2];
   for (int i = 0; i < kNumParticles; ++i) {
+    random_.FillUniform(noise, size + 2);
     particle_[i].Render(
         sync,
         density,
@@ -81,6 +85,7 @@ void ParticleEngine::Render(
         f0,
         spread,
         q,
+        noise,
         out,
         aux,
         size);
@@ -31,6 +31,7 @@
 
 #include "plaits/dsp/engine/engine.h"
 #include "plaits/dsp/fx/diffuser.h"
+#include "plaits/dsp/noise/block_random_generator.h"
 #include "plaits/dsp/noise/particle.h"
 
 namespace plaits {
@@ -51,6 +52,7 @@ class ParticleEngine : public Engine {
       bool* already_enveloped);
 
  private:
+  BlockRandomGenerator random_;
   Particle particle_[kNumParticles];
   Diffuser diffuser_;
   stmlib::Svf post_filter_;
@@ -58,6 +58,12 @@ class SpeechEngine : public Engine {
   inline void set_speed(float speed) {
     speed_ = speed;
   }
+  
+#ifdef TEST
+  inline void set_lpc_frames_per_block(int frames_per_block) {
+    lpc_speech_synth_controller_.set_frames_per_block(frames_per_block);
+  }
+#endif  // TEST
 
  private:
   stmlib::HysteresisQuantizer word_bank_quantizer_;
@@ -42,7 +42,8 @@ void StringEngine::Init(BufferAllocator* allocator) {
     f0_[i] = 0.01f;
   }
   active_string_ = kNumStrings - 1;
-  f0_delay_.Init(allocator->Allocate<float>(16));
+  f0_delay_.Init(allocator->Allocate<float>(
+      DelayLine<float, 16>::kBufferSize));
 }
 
 void StringEngine::Reset() {
@@ -41,6 +41,7 @@ void SwarmEngine::Init(BufferAllocator* allocator) {
     float rank = (static_cast<float>(i) - n) / n;
     swarm_voice_[i].Init(rank);
   }
+  oscillators_.Init();
 }
 
 void SwarmEngine::Reset() { }
@@ -63,22 +64,21 @@ void SwarmEngine::Render(
   const bool burst_mode = !(parameters.trigger & TRIGGER_UNPATCHED);
   const bool start_burst = parameters.trigger & TRIGGER_RISING_EDGE;
 
-  fill(&out[0], &out[size], 0.0f);
-  fill(&aux[0], &aux[size], 0.0f);
-  
+  float frequency[kNumSwarmVoices];
+  float amplitude[kNumSwarmVoices];
   for (int i = 0; i < kNumSwarmVoices; ++i) {
-    swarm_voice_[i].Render(
+    swarm_voice_[i].Step(
         f0,
         density,
         burst_mode,
         start_burst,
         spread,
         size_ratio,
-        out,
-        aux,
-        size);
+        &frequency[i],
+        &amplitude[i]);
     size_ratio *= 0.97f;
   }
+  oscillators_.Render(frequency, amplitude, out, aux, size);
 }
 
 }  // namespace plaits
@@ -29,19 +29,31 @@
 #ifndef PLAITS_DSP_ENGINE_SWARM_ENGINE_H_
 #define PLAITS_DSP_ENGINE_SWARM_ENGINE_H_
 
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif  // __SSE__
+
+#include "stmlib/dsp/parameter_interpolator.h"
 #include "stmlib/dsp/polyblep.h"
 #include "stmlib/dsp/units.h"
-#include "stmlib/utils/random.h"
 
 #include "plaits/dsp/engine/engine.h"
 #include "plaits/dsp/oscillator/oscillator.h"
 #include "plaits/dsp/oscillator/string_synth_oscillator.h"
 #include "plaits/dsp/oscillator/sine_oscillator.h"
+#include "plaits/dsp/voice_random.h"
 #include "plaits/resources.h"
 
 namespace plaits {
 
+// Host builds can grow the swarm (e.g. -DPLAITS_SWARM_VOICES=32).
+#ifdef PLAITS_SWARM_VOICES
+const int kNumSwarmVoices = PLAITS_SWARM_VOICES;
+#else
 const int kNumSwarmVoices = 8;
+#endif  // PLAITS_SWARM_VOICES
 
 class GrainEnvelope {
  public:
@@ -55,6 +67,7 @@ class GrainEnvelope {
     fm_ = 0.0f;
     amplitude_ = 0.5f;
     previous_size_ratio_ = 0.0f;
+    filter_coefficient_ = 0.0f;
   }
   
   inline void Step(float rate, bool burst_mode, bool start_burst) {
@@ -73,12 +86,12 @@ class GrainEnvelope {
     
     if (randomize) {
       from_ += interval_;
-      interval_ = stmlib::Random::GetFloat() - from_;
+      interval_ = VoiceRandom::GetFloat() - from_;
       // Randomize the duration of the grain.
       if (burst_mode) {
-        fm_ *= 0.8f + 0.2f * stmlib::Random::GetFloat();
+        fm_ *= 0.8f + 0.2f * VoiceRandom::GetFloat();
       } else {
-        fm_ = 0.5f + 1.5f * stmlib::Random::GetFloat();
+        fm_ = 0.5f + 1.5f * VoiceRandom::GetFloat();
       }
     }
   }
@@ -107,10 +120,13 @@ class GrainEnvelope {
     if ((size_ratio >= 1.0f) ^ (previous_size_ratio_ >= 1.0f)) {
       filter_coefficient_ = 0.5f;
     }
-    filter_coefficient_ *= 0.95f;
+    filter_coefficient_ *= 1.0f - BlockRateCoefficient(0.05f);
     
     previous_size_ratio_ = size_ratio;
-    ONE_POLE(amplitude_, target_amplitude, 0.5f - filter_coefficient_);
+    ONE_POLE(
+        amplitude_,
+        target_amplitude,
+        BlockRateCoefficient(0.5f - filter_coefficient_));
     return amplitude_;
   }
   
@@ -126,31 +142,286 @@ class GrainEnvelope {
   DISALLOW_COPY_AND_ASSIGN(GrainEnvelope);
 };
 
-class AdditiveSawOscillator {
+class SwarmVoice {
  public:
-  AdditiveSawOscillator() { }
-  ~AdditiveSawOscillator() { }
-
-  inline void Init() {
-    phase_ = 0.0f;
-    next_sample_ = 0.0f;
-    frequency_ = 0.01f;
-    gain_ = 0.0f;
+  SwarmVoice() { }
+  ~SwarmVoice() { }
+  
+  void Init(float rank) {
+    rank_ = rank;
+    envelope_.Init();
+  }
+  
+  // Advances the grain envelope by one block, and returns the frequency and
+  // amplitude of the voice's oscillators.
+  void Step(
+      float f0,
+      float density,
+      bool burst_mode,
+      bool start_burst,
+      float spread,
+      float size_ratio,
+      float* frequency,
+      float* amplitude) {
+    envelope_.Step(density, burst_mode, start_burst);
+    
+    const float scale = 1.0f / kNumSwarmVoices;
+    *amplitude = envelope_.amplitude(size_ratio) * scale;
+
+    const float expo_amount = envelope_.frequency(size_ratio);
+    f0 *= stmlib::SemitonesToRatio(48.0f * expo_amount * spread * rank_);
+    
+    const float linear_amount = rank_ * (rank_ + 0.01f) * spread * 0.25f;
+    *frequency = f0 * (1.0f + linear_amount);
   }
+  
+ private:
+  float rank_;
+
+  GrainEnvelope envelope_;
+  
+  DISALLOW_COPY_AND_ASSIGN(SwarmVoice);
+};
 
+// The sawtooth and sine oscillators of all the voices, stored as arrays of
+// states so that a single pass renders all of them. On the host, this pass
+// processes 4 voices per vector.
+template<int num_voices>
+class SwarmOscillatorBank {
+ public:
+  SwarmOscillatorBank() { }
+  ~SwarmOscillatorBank() { }
+  
+  void Init() {
+    for (int i = 0; i < num_voices; ++i) {
+      saw_phase_[i] = 0.0f;
+      saw_next_sample_[i] = 0.0f;
+      saw_frequency_[i] = 0.01f;
+      saw_gain_[i] = 0.0f;
+      
+      sine_x_[i] = 1.0f;
+      sine_y_[i] = 0.0f;
+      sine_epsilon_[i] = 0.0f;
+      sine_amplitude_[i] = 0.0f;
+    }
+  }
+  
+  // Writes the sum of the sawtooths to saw, and of the sines to sine.
   inline void Render(
+      const float* frequency,
+      const float* amplitude,
+      float* saw,
+      float* sine,
+      size_t size) {
+#ifdef __SSE__
+    Render(
+        Vectorized<num_voices % 4 == 0>(),
+        frequency, amplitude, saw, sine, size);
+#else
+    RenderScalar(frequency, amplitude, saw, sine, size);
+#endif  // __SSE__
+  }
+  
+  // Reference implementation, one voice at a time.
+  void RenderScalar(
+      const float* frequency,
+      const float* amplitude,
+      float* saw,
+      float* sine,
+      size_t size) {
+    std::fill(&saw[0], &saw[size], 0.0f);
+    std::fill(&sine[0], &sine[size], 0.0f);
+    for (int i = 0; i < num_voices; ++i) {
+      float saw_frequency, sine_epsilon, sine_amplitude;
+      ComputeTargets(
+          i, frequency[i], amplitude[i],
+          &saw_frequency, &sine_epsilon, &sine_amplitude);
+      RenderSaw(i, saw_frequency, amplitude[i], saw, size);
+      RenderSine(i, sine_epsilon, sine_amplitude, sine, size);
+    }
+  }
+  
+#ifdef __SSE__
+  void RenderSse(
+      const float* frequency,
+      const float* amplitude,
+      float* saw,
+      float* sine,
+      size_t size) {
+    STATIC_ASSERT(num_voices % 4 == 0, whole_vectors);
+    float saw_frequency[num_voices];
+    float sine_epsilon[num_voices];
+    float sine_amplitude[num_voices];
+    for (int i = 0; i < num_voices; ++i) {
+      ComputeTargets(
+          i, frequency[i], amplitude[i],
+          &saw_frequency[i], &sine_epsilon[i], &sine_amplitude[i]);
+    }
+    
+    // Same increments as stmlib::ParameterInterpolator. The states stay in
+    // registers for the whole block.
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 block_size = _mm_set1_ps(static_cast<float>(size));
+    __m128 saw_phase[kNumVectors];
+    __m128 saw_next_sample[kNumVectors];
+    __m128 saw_f[kNumVectors];
+    __m128 saw_f_increment[kNumVectors];
+    __m128 saw_gain[kNumVectors];
+    __m128 saw_gain_increment[kNumVectors];
+    __m128 sine_x[kNumVectors];
+    __m128 sine_y[kNumVectors];
+    __m128 sine_e[kNumVectors];
+    __m128 sine_e_increment[kNumVectors];
+    __m128 sine_am[kNumVectors];
+    __m128 sine_am_increment[kNumVectors];
+    for (int v = 0; v < kNumVectors; ++v) {
+      const int i = v * 4;
+      saw_phase[v] = _mm_loadu_ps(&saw_phase_[i]);
+      saw_next_sample[v] = _mm_loadu_ps(&saw_next_sample_[i]);
+      saw_f[v] = _mm_loadu_ps(&saw_frequency_[i]);
+      saw_f_increment[v] = _mm_div_ps(
+          _mm_sub_ps(_mm_loadu_ps(&saw_frequency[i]), saw_f[v]), block_size);
+      saw_gain[v] = _mm_loadu_ps(&saw_gain_[i]);
+      saw_gain_increment[v] = _mm_div_ps(
+          _mm_sub_ps(_mm_loadu_ps(&amplitude[i]), saw_gain[v]), block_size);
+      sine_x[v] = _mm_loadu_ps(&sine_x_[i]);
+      sine_y[v] = _mm_loadu_ps(&sine_y_[i]);
+      sine_e[v] = _mm_loadu_ps(&sine_epsilon_[i]);
+      sine_e_increment[v] = _mm_div_ps(
+          _mm_sub_ps(_mm_loadu_ps(&sine_epsilon[i]), sine_e[v]), block_size);
+      sine_am[v] = _mm_loadu_ps(&sine_amplitude_[i]);
+      sine_am_increment[v] = _mm_div_ps(
+          _mm_sub_ps(_mm_loadu_ps(&sine_amplitude[i]), sine_am[v]),
+          block_size);
+    }
+    
+    for (size_t j = 0; j < size; ++j) {
+      __m128 saw_sum = _mm_setzero_ps();
+      __m128 sine_sum = _mm_setzero_ps();
+      for (int v = 0; v < kNumVectors; ++v) {
+        const __m128 f = saw_f[v] = _mm_add_ps(saw_f[v], saw_f_increment[v]);
+        saw_gain[v] = _mm_add_ps(saw_gain[v], saw_gain_increment[v]);
+        __m128 phase = _mm_add_ps(saw_phase[v], f);
+        const __m128 wrap = _mm_cmpge_ps(phase, one);
+        __m128 this_sample = saw_next_sample[v];
+        __m128 next_sample = _mm_setzero_ps();
+        // A lane only wraps every few dozen samples or more: the division
+        // and the blep are skipped when none of them does.
+        if (_mm_movemask_ps(wrap)) {
+          phase = _mm_sub_ps(phase, _mm_and_ps(wrap, one));
+          const __m128 t = _mm_div_ps(phase, f);
+          const __m128 t_next = _mm_sub_ps(one, t);
+          this_sample = _mm_sub_ps(
+              this_sample,
+              _mm_and_ps(wrap, _mm_mul_ps(_mm_mul_ps(half, t), t)));
+          next_sample = _mm_and_ps(
+              wrap, _mm_mul_ps(_mm_mul_ps(half, t_next), t_next));
+        }
+        saw_next_sample[v] = _mm_add_ps(next_sample, phase);
+        saw_phase[v] = phase;
+        saw_sum = _mm_add_ps(saw_sum, _mm_mul_ps(
+            _mm_sub_ps(_mm_mul_ps(two, this_sample), one), saw_gain[v]));
+        
+        const __m128 e = sine_e[v] = _mm_add_ps(
+            sine_e[v], sine_e_increment[v]);
+        sine_am[v] = _mm_add_ps(sine_am[v], sine_am_increment[v]);
+        sine_x[v] = _mm_add_ps(sine_x[v], _mm_mul_ps(e, sine_y[v]));
+        sine_y[v] = _mm_sub_ps(sine_y[v], _mm_mul_ps(e, sine_x[v]));
+        sine_sum = _mm_add_ps(sine_sum, _mm_mul_ps(sine_am[v], sine_x[v]));
+      }
+      
+      // Horizontal sums of both accumulators at once.
+      __m128 s = _mm_add_ps(
+          _mm_unpacklo_ps(saw_sum, sine_sum),
+          _mm_unpackhi_ps(saw_sum, sine_sum));
+      s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+      saw[j] = _mm_cvtss_f32(s);
+      sine[j] = _mm_cvtss_f32(_mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+    }
+    
+    for (int v = 0; v < kNumVectors; ++v) {
+      const int i = v * 4;
+      _mm_storeu_ps(&saw_phase_[i], saw_phase[v]);
+      _mm_storeu_ps(&saw_next_sample_[i], saw_next_sample[v]);
+      _mm_storeu_ps(&saw_frequency_[i], saw_f[v]);
+      _mm_storeu_ps(&saw_gain_[i], saw_gain[v]);
+      _mm_storeu_ps(&sine_x_[i], sine_x[v]);
+      _mm_storeu_ps(&sine_y_[i], sine_y[v]);
+      _mm_storeu_ps(&sine_epsilon_[i], sine_e[v]);
+      _mm_storeu_ps(&sine_amplitude_[i], sine_am[v]);
+    }
+  }
+#endif  // __SSE__
+  
+ private:
+#ifdef __SSE__
+  // Picks the path at compile time, so that RenderSse only gets
+  // instantiated for banks of whole vectors.
+  template<bool vectorized>
+  struct Vectorized { };
+  
+  inline void Render(
+      Vectorized<true>,
+      const float* frequency,
+      const float* amplitude,
+      float* saw,
+      float* sine,
+      size_t size) {
+    RenderSse(frequency, amplitude, saw, sine, size);
+  }
+  
+  inline void Render(
+      Vectorized<false>,
+      const float* frequency,
+      const float* amplitude,
+      float* saw,
+      float* sine,
+      size_t size) {
+    RenderScalar(frequency, amplitude, saw, sine, size);
+  }
+#endif  // __SSE__
+
+  // Clamps the frequencies and amplitudes like the scalar oscillators do,
+  // and renormalizes the sine oscillators.
+  inline void ComputeTargets(
+      int i,
+      float frequency,
+      float amplitude,
+      float* saw_frequency,
+      float* sine_epsilon,
+      float* sine_amplitude) {
+    *saw_frequency = std::min(frequency, kMaxFrequency);
+    
+    if (frequency >= 0.25f) {
+      frequency = 0.25f;
+      amplitude = 0.0f;
+    } else {
+      amplitude *= 1.0f - frequency * 4.0f;
+    }
+    *sine_epsilon = FastSineOscillator::Fast2Sin(frequency);
+    *sine_amplitude = amplitude;
+    
+    const float norm = sine_x_[i] * sine_x_[i] + sine_y_[i] * sine_y_[i];
+    if (norm <= 0.5f || norm >= 2.0f) {
+      const float scale = stmlib::fast_rsqrt_carmack(norm);
+      sine_x_[i] *= scale;
+      sine_y_[i] *= scale;
+    }
+  }
+  
+  inline void RenderSaw(
+      int i,
       float frequency,
       float level,
       float* out,
       size_t size) {
-    if (frequency >= kMaxFrequency) {
-      frequency = kMaxFrequency;
-    }
-    stmlib::ParameterInterpolator fm(&frequency_, frequency, size);
-    stmlib::ParameterInterpolator gain(&gain_, level, size);
+    stmlib::ParameterInterpolator fm(&saw_frequency_[i], frequency, size);
+    stmlib::ParameterInterpolator gain(&saw_gain_[i], level, size);
 
-    float next_sample = next_sample_;
-    float phase = phase_;
+    float next_sample = saw_next_sample_[i];
+    float phase = saw_phase_[i];
 
     while (size--) {
       float this_sample = next_sample;
@@ -170,65 +441,47 @@ class AdditiveSawOscillator {
       next_sample += phase;
       *out++ += (2.0f * this_sample - 1.0f) * gain.Next();
     }
-    phase_ = phase;
-    next_sample_ = next_sample;
+    saw_phase_[i] = phase;
+    saw_next_sample_[i] = next_sample;
   }
-
- private:
-  // Oscillator state.
-  float phase_;
-  float next_sample_;
-
-  // For interpolation of parameters.
-  float frequency_;
-  float gain_;
-
-  DISALLOW_COPY_AND_ASSIGN(AdditiveSawOscillator);
-};
-
-class SwarmVoice {
- public:
-  SwarmVoice() { }
-  ~SwarmVoice() { }
   
-  void Init(float rank) {
-    rank_ = rank;
-    envelope_.Init();
-    saw_.Init();
-    sine_.Init();
+  inline void RenderSine(
+      int i,
+      float epsilon,
+      float amplitude,
+      float* out,
+      size_t size) {
+    stmlib::ParameterInterpolator e(&sine_epsilon_[i], epsilon, size);
+    stmlib::ParameterInterpolator am(&sine_amplitude_[i], amplitude, size);
+    float x = sine_x_[i];
+    float y = sine_y_[i];
+    while (size--) {
+      const float epsilon = e.Next();
+      x += epsilon * y;
+      y -= epsilon * x;
+      *out++ += am.Next() * x;
+    }
+    sine_x_[i] = x;
+    sine_y_[i] = y;
   }
   
-  void Render(
-      float f0,
-      float density,
-      bool burst_mode,
-      bool start_burst,
-      float spread,
-      float size_ratio,
-      float* saw,
-      float* sine,
-      size_t size) {
-    envelope_.Step(density, burst_mode, start_burst);
-    
-    const float scale = 1.0f / kNumSwarmVoices;
-    const float amplitude = envelope_.amplitude(size_ratio) * scale;
-
-    const float expo_amount = envelope_.frequency(size_ratio);
-    f0 *= stmlib::SemitonesToRatio(48.0f * expo_amount * spread * rank_);
-    
-    const float linear_amount = rank_ * (rank_ + 0.01f) * spread * 0.25f;
-    f0 *= 1.0f + linear_amount;
-
-    saw_.Render(f0, amplitude, saw, size);
-    sine_.Render(f0, amplitude, sine, size);
+  enum {
+    kNumVectors = num_voices / 4
   };
   
- private:
-  float rank_;
-
-  GrainEnvelope envelope_;
-  AdditiveSawOscillator saw_;
-  FastSineOscillator sine_;
+  // Sawtooth oscillators.
+  float saw_phase_[num_voices];
+  float saw_next_sample_[num_voices];
+  float saw_frequency_[num_voices];
+  float saw_gain_[num_voices];
+  
+  // Sine oscillators.
+  float sine_x_[num_voices];
+  float sine_y_[num_voices];
+  float sine_epsilon_[num_voices];
+  float sine_amplitude_[num_voices];
+  
+  DISALLOW_COPY_AND_ASSIGN(SwarmOscillatorBank);
 };
 
 class SwarmEngine : public Engine {
@@ -246,6 +499,7 @@ class SwarmEngine : public Engine {
   
  private:
   SwarmVoice swarm_voice_[kNumSwarmVoices];
+  SwarmOscillatorBank<kNumSwarmVoices> oscillators_;
   
   DISALLOW_COPY_AND_ASSIGN(SwarmEngine);
 };
@@ -93,9 +93,11 @@ void WavetableEngine::Render(
     bool* already_enveloped) {
   const float f0 = NoteToFrequency(parameters.note);
   
-  ONE_POLE(x_pre_lp_, parameters.timbre * 6.9999f, 0.2f);
-  ONE_POLE(y_pre_lp_, parameters.morph * 6.9999f, 0.2f);
-  ONE_POLE(z_pre_lp_, parameters.harmonics * 6.9999f, 0.05f);
+  const float xy_pre_lp_coefficient = BlockRateCoefficient(0.2f);
+  const float z_pre_lp_coefficient = BlockRateCoefficient(0.05f);
+  ONE_POLE(x_pre_lp_, parameters.timbre * 6.9999f, xy_pre_lp_coefficient);
+  ONE_POLE(y_pre_lp_, parameters.morph * 6.9999f, xy_pre_lp_coefficient);
+  ONE_POLE(z_pre_lp_, parameters.harmonics * 6.9999f, z_pre_lp_coefficient);
   
   const float x = x_pre_lp_;
   const float y = y_pre_lp_;
@@ -31,6 +31,8 @@
 
 #include "stmlib/stmlib.h"
 
+#include "plaits/dsp/dsp.h"
+
 namespace plaits {
 
 class LPGEnvelope {
@@ -43,6 +45,7 @@ class LPGEnvelope {
     gain_ = 1.0f;
     frequency_ = 0.5f;
     hf_bleed_ = 0.0f;
+    ramp_up_ = false;
   }
   
   inline void Trigger() {
@@ -75,9 +78,9 @@ class LPGEnvelope {
     float vactrol_state_4 = vactrol_state_2 * vactrol_state_2;
     float tail = 1.0f - vactrol_state_;
     float tail_2 = tail * tail;
-    float vactrol_coefficient = (vactrol_error > 0.0f)
+    float vactrol_coefficient = BlockRateCoefficient((vactrol_error > 0.0f)
         ? 0.6f
-        : short_decay + (1.0f - vactrol_state_4) * decay_tail;
+        : short_decay + (1.0f - vactrol_state_4) * decay_tail);
     vactrol_state_ += vactrol_coefficient * vactrol_error;
     
     gain_ = vactrol_state_;
@@ -0,0 +1,134 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Fills whole blocks with white noise from several independent generators.
+
+#ifndef PLAITS_DSP_NOISE_BLOCK_RANDOM_GENERATOR_H_
+#define PLAITS_DSP_NOISE_BLOCK_RANDOM_GENERATOR_H_
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+#include "stmlib/stmlib.h"
+
+namespace plaits {
+
+const int kBlockRandomGeneratorNumLanes = 4;
+
+// Four xorshift32 generators, each seeded with a SplitMix32 hash of the seed.
+// Sample n of a block comes from lane n % 4, so the lanes advance together
+// and map onto one SSE register on the host. Only the top 24 bits of each
+// state are used, which makes the conversion to float exact.
+class BlockRandomGenerator {
+ public:
+  BlockRandomGenerator() { }
+  ~BlockRandomGenerator() { }
+
+  void Init(uint32_t seed) {
+    for (int i = 0; i < kBlockRandomGeneratorNumLanes; ++i) {
+      seed += 0x9e3779b9;
+      uint32_t z = seed;
+      z = (z ^ (z >> 16)) * 0x85ebca6b;
+      z = (z ^ (z >> 13)) * 0xc2b2ae35;
+      z ^= z >> 16;
+      // xorshift never leaves the all-zero state.
+      state_[i] = z ? z : 0x6d2b79f5;
+    }
+  }
+
+  // Uniform in [0, 1).
+  inline void FillUniform(float* out, size_t size) {
+    Fill<false>(out, size);
+  }
+
+  // Uniform in [-1, 1).
+  inline void FillBipolar(float* out, size_t size) {
+    Fill<true>(out, size);
+  }
+
+ private:
+  template<bool bipolar>
+  inline void Fill(float* out, size_t size) {
+#ifdef __SSE2__
+    const __m128 scale = _mm_set1_ps(
+        bipolar ? 1.0f / 8388608.0f : 1.0f / 16777216.0f);
+    __m128i x = _mm_loadu_si128((const __m128i*) state_);
+    while (size) {
+      x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+      x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+      x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+      const __m128i bits = bipolar
+          ? _mm_srai_epi32(x, 8)
+          : _mm_srli_epi32(x, 8);
+      const __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(bits), scale);
+      if (size >= kBlockRandomGeneratorNumLanes) {
+        _mm_storeu_ps(out, v);
+        out += kBlockRandomGeneratorNumLanes;
+        size -= kBlockRandomGeneratorNumLanes;
+      } else {
+        float tail[kBlockRandomGeneratorNumLanes];
+        _mm_storeu_ps(tail, v);
+        for (size_t i = 0; i < size; ++i) {
+          out[i] = tail[i];
+        }
+        size = 0;
+      }
+    }
+    _mm_storeu_si128((__m128i*) state_, x);
+#else
+    while (size) {
+      for (int i = 0; i < kBlockRandomGeneratorNumLanes; ++i) {
+        uint32_t x = state_[i];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state_[i] = x;
+        if (static_cast<size_t>(i) < size) {
+          out[i] = bipolar
+              ? static_cast<float>(static_cast<int32_t>(x) >> 8) *
+                  (1.0f / 8388608.0f)
+              : static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+        }
+      }
+      if (size >= kBlockRandomGeneratorNumLanes) {
+        out += kBlockRandomGeneratorNumLanes;
+        size -= kBlockRandomGeneratorNumLanes;
+      } else {
+        size = 0;
+      }
+    }
+#endif  // __SSE2__
+  }
+
+  uint32_t state_[kBlockRandomGeneratorNumLanes];
+
+  DISALLOW_COPY_AND_ASSIGN(BlockRandomGenerator);
+};
+
+}  // namespace plaits
+
+#endif  // PLAITS_DSP_NOISE_BLOCK_RANDOM_GENERATOR_H_
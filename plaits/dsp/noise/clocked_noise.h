@@ -32,7 +32,6 @@
 #include "stmlib/dsp/dsp.h"
 #include "stmlib/dsp/parameter_interpolator.h"
 #include "stmlib/dsp/polyblep.h"
-#include "stmlib/utils/random.h"
 
 namespace plaits {
 
@@ -48,7 +47,13 @@ class ClockedNoise {
     frequency_ = 0.001f;
   }
 
-  void Render(bool sync, float frequency, float* out, size_t size) {
+  // noise holds size bipolar random values. It can be the same buffer as out.
+  void Render(
+      bool sync,
+      float frequency,
+      const float* noise,
+      float* out,
+      size_t size) {
     CONSTRAIN(frequency, 0.0f, 1.0f);
     
     stmlib::ParameterInterpolator fm(&frequency_, frequency, size);
@@ -65,7 +70,7 @@ class ClockedNoise {
       next_sample = 0.0f;
 
       const float frequency = fm.Next();
-      const float raw_sample = stmlib::Random::GetFloat() * 2.0f - 1.0f;
+      const float raw_sample = *noise++;
       float raw_amount = 4.0f * (frequency - 0.25f);
       CONSTRAIN(raw_amount, 0.0f, 1.0f);
       
@@ -29,13 +29,13 @@
 #ifndef PLAITS_DSP_NOISE_DUST_H_
 #define PLAITS_DSP_NOISE_DUST_H_
 
-#include "stmlib/utils/random.h"
+#include "plaits/dsp/voice_random.h"
 
 namespace plaits {
 
 inline float Dust(float frequency) {
   float inv_frequency = 1.0f / frequency;
-  float u = stmlib::Random::GetFloat();
+  float u = VoiceRandom::GetFloat();
   if (u < frequency) {
     return u * inv_frequency;
   } else {
@@ -31,7 +31,6 @@
 
 #include "stmlib/dsp/dsp.h"
 #include "stmlib/dsp/filter.h"
-#include "stmlib/utils/random.h"
 
 namespace plaits {
 
@@ -45,6 +44,7 @@ class Particle {
     filter_.Init();
   }
   
+  // noise holds size + 2 uniform random values.
   inline void Render(
       bool sync,
       float density,
@@ -52,10 +52,12 @@ class Particle {
       float frequency,
       float spread,
       float q,
+      const float* noise,
       float* out,
       float* aux,
       size_t size) {
-    float u = stmlib::Random::GetFloat();
+    const float frequency_u = 2.0f * noise[size + 1] - 1.0f;
+    float u = *noise++;
     if (sync) {
       u = density;
     }
@@ -65,9 +67,8 @@ class Particle {
       if (u <= density) {
         s = u * gain;
         if (can_radomize_frequency) {
-          const float u = 2.0f * stmlib::Random::GetFloat() - 1.0f;
           const float f = std::min(
-              stmlib::SemitonesToRatio(spread * u) * frequency,
+              stmlib::SemitonesToRatio(spread * frequency_u) * frequency,
               0.25f);
           pre_gain_ = 0.5f / stmlib::Sqrt(q * f * stmlib::Sqrt(density));
           filter_.set_f_q<stmlib::FREQUENCY_DIRTY>(f, q);
@@ -77,7 +78,7 @@ class Particle {
       }
       *aux++ += s;
       *out++ += filter_.Process<stmlib::FILTER_MODE_BAND_PASS>(pre_gain_ * s);
-      u = stmlib::Random::GetFloat();
+      u = *noise++;
     }
   }
  
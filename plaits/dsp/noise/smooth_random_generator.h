@@ -30,7 +30,7 @@
 #define PLAITS_DSP_NOISE_SMOOTH_RANDOM_GENERATOR_H_
 
 #include "stmlib/stmlib.h"
-#include "stmlib/utils/random.h"
+#include "plaits/dsp/voice_random.h"
 
 namespace plaits {
 
@@ -50,7 +50,7 @@ class SmoothRandomGenerator {
     if (phase_ >= 1.0f) {
       phase_ -= 1.0f;
       from_ += interval_;
-      interval_ = stmlib::Random::GetFloat() * 2.0f - 1.0f - from_;
+      interval_ = VoiceRandom::GetFloat() * 2.0f - 1.0f - from_;
     }
     float t = phase_ * phase_ * (3.0f - 2.0f * phase_);
     return from_ + interval_ * t;
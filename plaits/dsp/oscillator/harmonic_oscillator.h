@@ -34,10 +34,18 @@
 #include "stmlib/dsp/dsp.h"
 #include "stmlib/dsp/parameter_interpolator.h"
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif  // __SSE__
+
 #include "plaits/resources.h"
 
 namespace plaits {
 
+// Harmonics whose amplitude stays below this level (-80 dB) over the block
+// are not rendered, as long as no louder harmonic sits above them.
+const float kHarmonicSilenceThreshold = 1.0e-4f;
+
 template<int num_harmonics>
 class HarmonicOscillator {
  public:
@@ -50,7 +58,17 @@ class HarmonicOscillator {
     for (int i = 0; i < num_harmonics; ++i) {
       amplitude_[i] = 0.0f;
     }
+#ifdef TEST
+    silence_threshold_ = kHarmonicSilenceThreshold;
+#endif  // TEST
+  }
+  
+#ifdef TEST
+  // Lets the tests compare the output with and without the skip.
+  void set_silence_threshold(float threshold) {
+    silence_threshold_ = threshold;
   }
+#endif  // TEST
   
   template<int first_harmonic_index>
   void Render(
@@ -62,37 +80,90 @@ class HarmonicOscillator {
       frequency = 0.5f;
     }
     
-    stmlib::ParameterInterpolator am[num_harmonics];
     stmlib::ParameterInterpolator fm(&frequency_, frequency, size);
     
+    // The recurrence has to run through every harmonic up to the last
+    // audible one, but everything above it can be skipped. The skipped
+    // harmonics jump straight to their (inaudible) target amplitude.
+#ifdef TEST
+    const float threshold = silence_threshold_;
+#else
+    const float threshold = kHarmonicSilenceThreshold;
+#endif  // TEST
+    float amplitude[num_harmonics];
+    float increment[num_harmonics];
+    int num_audible = 0;
     for (int i = 0; i < num_harmonics; ++i) {
       float f = frequency * static_cast<float>(first_harmonic_index + i);
       if (f >= 0.5f) {
         f = 0.5f;
       }
-      am[i].Init(&amplitude_[i], amplitudes[i] * (1.0f - f * 2.0f), size);
+      const float target = amplitudes[i] * (1.0f - f * 2.0f);
+      if (fabsf(amplitude_[i]) > threshold || fabsf(target) > threshold) {
+        num_audible = i + 1;
+      }
+      amplitude[i] = amplitude_[i];
+      increment[i] = (target - amplitude_[i]) / static_cast<float>(size);
+      amplitude_[i] = target;
+    }
+    
+    if (num_audible == 0) {
+      while (size--) {
+        phase_ += fm.Next();
+        if (phase_ >= 1.0f) {
+          phase_ -= 1.0f;
+        }
+        if (first_harmonic_index == 1) {
+          *out++ = 0.0f;
+        }
+      }
+      return;
     }
 
-    while (size--) {
-      phase_ += fm.Next();
-      if (phase_ >= 1.0f) {
-        phase_ -= 1.0f;
+#ifdef __SSE__
+    // 4 consecutive samples per vector: each lane runs the same recurrence
+    // as the scalar loop below, so the output is identical.
+    while (size >= 4) {
+      float two_x_v[4];
+      float previous_v[4];
+      float current_v[4];
+      for (int j = 0; j < 4; ++j) {
+        Start<first_harmonic_index>(
+            fm.Next(), &two_x_v[j], &previous_v[j], &current_v[j]);
+      }
+      const __m128 two_x = _mm_loadu_ps(two_x_v);
+      __m128 previous = _mm_loadu_ps(previous_v);
+      __m128 current = _mm_loadu_ps(current_v);
+      __m128 sum = _mm_setzero_ps();
+      for (int i = 0; i < num_audible; ++i) {
+        const float a_0 = amplitude[i] += increment[i];
+        const float a_1 = amplitude[i] += increment[i];
+        const float a_2 = amplitude[i] += increment[i];
+        const float a_3 = amplitude[i] += increment[i];
+        const __m128 a = _mm_setr_ps(a_0, a_1, a_2, a_3);
+        sum = _mm_add_ps(sum, _mm_mul_ps(a, current));
+        const __m128 temp = current;
+        current = _mm_sub_ps(_mm_mul_ps(two_x, current), previous);
+        previous = temp;
       }
-      const float two_x = 2.0f * stmlib::Interpolate(lut_sine, phase_, 1024.0f);
-      float previous, current;
       if (first_harmonic_index == 1) {
-        previous = 1.0f;
-        current = two_x * 0.5f;
+        _mm_storeu_ps(out, sum);
       } else {
-        const float k = first_harmonic_index;
-        previous = stmlib::InterpolateWrap(
-            lut_sine, phase_ * (k - 1.0f) + 0.25f, 1024.0f);
-        current = stmlib::InterpolateWrap(lut_sine, phase_ * k, 1024.0f);
+        _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), sum));
       }
+      out += 4;
+      size -= 4;
+    }
+#endif  // __SSE__
+
+    while (size--) {
+      float two_x, previous, current;
+      Start<first_harmonic_index>(fm.Next(), &two_x, &previous, &current);
       
       float sum = 0.0f;
-      for (int i = 0; i < num_harmonics; ++i) {
-        sum += am[i].Next() * current;
+      for (int i = 0; i < num_audible; ++i) {
+        amplitude[i] += increment[i];
+        sum += amplitude[i] * current;
         float temp = current;
         current = two_x * current - previous;
         previous = temp;
@@ -103,9 +174,36 @@ class HarmonicOscillator {
         *out++ += sum;
       }
     }
+    
+    for (int i = 0; i < num_audible; ++i) {
+      amplitude_[i] = amplitude[i];
+    }
   }
 
  private:
+  // Advances the phase and computes the first two terms of the recurrence.
+  template<int first_harmonic_index>
+  inline void Start(
+      float frequency,
+      float* two_x,
+      float* previous,
+      float* current) {
+    phase_ += frequency;
+    if (phase_ >= 1.0f) {
+      phase_ -= 1.0f;
+    }
+    *two_x = 2.0f * stmlib::Interpolate(lut_sine, phase_, 1024.0f);
+    if (first_harmonic_index == 1) {
+      *previous = 1.0f;
+      *current = *two_x * 0.5f;
+    } else {
+      const float k = first_harmonic_index;
+      *previous = stmlib::InterpolateWrap(
+          lut_sine, phase_ * (k - 1.0f) + 0.25f, 1024.0f);
+      *current = stmlib::InterpolateWrap(lut_sine, phase_ * k, 1024.0f);
+    }
+  }
+  
   // Oscillator state.
   float phase_;
 
@@ -113,6 +211,10 @@ class HarmonicOscillator {
   float frequency_;
   float amplitude_[num_harmonics];
   
+#ifdef TEST
+  float silence_threshold_;
+#endif  // TEST
+  
   DISALLOW_COPY_AND_ASSIGN(HarmonicOscillator);
 };
 
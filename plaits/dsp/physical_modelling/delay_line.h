@@ -25,6 +25,7 @@
 // -----------------------------------------------------------------------------
 //
 // Delay line (same implementation as from stmlib, but does not own its buffer).
+// The length is a power of two, so that indices wrap with a mask.
 
 #ifndef PLAITS_DSP_PHYSICAL_MODELLING_DELAY_LINE_H_
 #define PLAITS_DSP_PHYSICAL_MODELLING_DELAY_LINE_H_
@@ -35,29 +36,39 @@
 
 namespace plaits {
 
+// The first samples of the line are mirrored past its end, so that
+// interpolated reads can fetch consecutive samples without wrapping.
+const size_t kDelayLineGuardSize = 4;
+
 template<typename T, size_t max_delay>
 class DelayLine {
  public:
   DelayLine() { }
   ~DelayLine() { }
   
-  void Init(float* buffer) {
+  // Size of the buffer passed to Init.
+  static const size_t kBufferSize = max_delay + kDelayLineGuardSize;
+  
+  void Init(T* buffer) {
     line_ = buffer;
     Reset();
   }
   
   void Reset() {
-    std::fill(&line_[0], &line_[max_delay], T(0));
+    std::fill(&line_[0], &line_[kBufferSize], T(0));
     write_ptr_ = 0;
   }
   
   inline void Write(const T sample) {
     line_[write_ptr_] = sample;
-    write_ptr_ = (write_ptr_ - 1 + max_delay) % max_delay;
+    if (write_ptr_ < kDelayLineGuardSize) {
+      line_[write_ptr_ + max_delay] = sample;
+    }
+    write_ptr_ = (write_ptr_ - 1) & kMask;
   }
   
   inline const T Allpass(const T sample, size_t delay, const T coefficient) {
-    T read = line_[(write_ptr_ + delay) % max_delay];
+    T read = line_[(write_ptr_ + delay) & kMask];
     T write = sample + coefficient * read;
     Write(write);
     return -write * coefficient + read;
@@ -70,18 +81,19 @@ class DelayLine {
   
   inline const T Read(float delay) const {
     MAKE_INTEGRAL_FRACTIONAL(delay)
-    const T a = line_[(write_ptr_ + delay_integral) % max_delay];
-    const T b = line_[(write_ptr_ + delay_integral + 1) % max_delay];
+    const T* x = &line_[(write_ptr_ + delay_integral) & kMask];
+    const T a = x[0];
+    const T b = x[1];
     return a + (b - a) * T(delay_fractional);
   }
   
   inline const T ReadHermite(float delay) const {
     MAKE_INTEGRAL_FRACTIONAL(delay)
-    int32_t t = (write_ptr_ + delay_integral + max_delay);
-    const T xm1 = line_[(t - 1) % max_delay];
-    const T x0 = line_[(t) % max_delay];
-    const T x1 = line_[(t + 1) % max_delay];
-    const T x2 = line_[(t + 2) % max_delay];
+    const T* x = &line_[(write_ptr_ + delay_integral - 1) & kMask];
+    const T xm1 = x[0];
+    const T x0 = x[1];
+    const T x1 = x[2];
+    const T x2 = x[3];
     const T c = (x1 - xm1) * 0.5f;
     const T v = x0 - x1;
     const T w = c + v;
@@ -92,6 +104,9 @@ class DelayLine {
   }
 
  private:
+  static const size_t kMask = max_delay - 1;
+  STATIC_ASSERT((max_delay & kMask) == 0, max_delay_power_of_two);
+  
   size_t write_ptr_;
   T* line_;
   
@@ -131,6 +131,23 @@ void Resonator::Process(
     harmonic += f0;
     q *= q_loss;
   }
+  
+  if (batch_counter) {
+    // Silence the unused modes of the last, incomplete batch.
+    while (batch_counter < kModeBatchSize) {
+      mode_f[batch_counter] = 0.0f;
+      mode_q[batch_counter] = 1.0f;
+      mode_a[batch_counter] = 0.0f;
+      ++batch_counter;
+    }
+    batch_processor->Process<FILTER_MODE_BAND_PASS, true>(
+        mode_f,
+        mode_q,
+        mode_a,
+        in,
+        out,
+        size);
+  }
 }
 
 }  // namespace plaits
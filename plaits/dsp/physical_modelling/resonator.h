@@ -31,13 +31,25 @@
 
 #include "stmlib/dsp/filter.h"
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif  // __SSE__
+
 namespace plaits {
 
 const int kMaxNumModes = 24;
-const int kModeBatchSize = 4;
 
+#ifdef __SSE__
+// Each mode is a chain of dependent multiplies and adds, so what matters on
+// the host is how many chains are in flight: the whole bank goes through a
+// single call, 4 modes per vector.
+const int kModeBatchSize = kMaxNumModes;
+#else
 // We render 4 modes simultaneously since there are enough registers to hold
 // all state variables.
+const int kModeBatchSize = 4;
+#endif  // __SSE__
+
 template<int batch_size>
 class ResonatorSvf {
  public:
@@ -51,7 +63,24 @@ class ResonatorSvf {
   }
   
   template<stmlib::FilterMode mode, bool add>
-  void Process(
+  inline void Process(
+      const float* f,
+      const float* q,
+      const float* gain,
+      const float* in,
+      float* out,
+      size_t size) {
+#ifdef __SSE__
+    Process<mode, add>(
+        Vectorized<batch_size % 4 == 0>(), f, q, gain, in, out, size);
+#else
+    ProcessScalar<mode, add>(f, q, gain, in, out, size);
+#endif  // __SSE__
+  }
+  
+  // Reference implementation, and the only one on the module.
+  template<stmlib::FilterMode mode, bool add>
+  void ProcessScalar(
       const float* f,
       const float* q,
       const float* gain,
@@ -97,8 +126,113 @@ class ResonatorSvf {
       state_2_[i] = state_2[i];
     }
   }
+
+#ifdef __SSE__
+  // Same recurrences as ProcessScalar, with one mode per lane. The states
+  // are bit-identical; the output only differs by rounding, since the modes
+  // are summed lane-wise before the final horizontal add.
+  template<stmlib::FilterMode mode, bool add>
+  void ProcessSse(
+      const float* f,
+      const float* q,
+      const float* gain,
+      const float* in,
+      float* out,
+      size_t size) {
+    STATIC_ASSERT(batch_size % 4 == 0, whole_vectors);
+    const int num_vectors = batch_size / 4;
+    __m128 g[num_vectors];
+    __m128 r_plus_g[num_vectors];
+    __m128 h[num_vectors];
+    __m128 state_1[num_vectors];
+    __m128 state_2[num_vectors];
+    __m128 gains[num_vectors];
+    for (int v = 0; v < num_vectors; ++v) {
+      float g_v[4], r_plus_g_v[4], h_v[4];
+      for (int i = 0; i < 4; ++i) {
+        const int n = v * 4 + i;
+        const float g_n = stmlib::OnePole::tan<stmlib::FREQUENCY_FAST>(f[n]);
+        const float r_n = 1.0f / q[n];
+        g_v[i] = g_n;
+        h_v[i] = 1.0f / (1.0f + r_n * g_n + g_n * g_n);
+        r_plus_g_v[i] = r_n + g_n;
+      }
+      g[v] = _mm_loadu_ps(g_v);
+      r_plus_g[v] = _mm_loadu_ps(r_plus_g_v);
+      h[v] = _mm_loadu_ps(h_v);
+      state_1[v] = _mm_loadu_ps(&state_1_[v * 4]);
+      state_2[v] = _mm_loadu_ps(&state_2_[v * 4]);
+      gains[v] = _mm_loadu_ps(&gain[v * 4]);
+    }
+    
+    while (size--) {
+      const __m128 s_in = _mm_set1_ps(*in++);
+      __m128 s_out = _mm_setzero_ps();
+      for (int v = 0; v < num_vectors; ++v) {
+        const __m128 hp = _mm_mul_ps(
+            _mm_sub_ps(
+                _mm_sub_ps(s_in, _mm_mul_ps(r_plus_g[v], state_1[v])),
+                state_2[v]),
+            h[v]);
+        const __m128 g_hp = _mm_mul_ps(g[v], hp);
+        const __m128 bp = _mm_add_ps(g_hp, state_1[v]);
+        state_1[v] = _mm_add_ps(g_hp, bp);
+        const __m128 g_bp = _mm_mul_ps(g[v], bp);
+        const __m128 lp = _mm_add_ps(g_bp, state_2[v]);
+        state_2[v] = _mm_add_ps(g_bp, lp);
+        s_out = _mm_add_ps(s_out, _mm_mul_ps(
+            gains[v],
+            (mode == stmlib::FILTER_MODE_LOW_PASS) ? lp : bp));
+      }
+      s_out = _mm_add_ps(s_out, _mm_movehl_ps(s_out, s_out));
+      s_out = _mm_add_ss(
+          s_out,
+          _mm_shuffle_ps(s_out, s_out, _MM_SHUFFLE(1, 1, 1, 1)));
+      if (add) {
+        *out++ += _mm_cvtss_f32(s_out);
+      } else {
+        *out++ = _mm_cvtss_f32(s_out);
+      }
+    }
+    for (int v = 0; v < num_vectors; ++v) {
+      _mm_storeu_ps(&state_1_[v * 4], state_1[v]);
+      _mm_storeu_ps(&state_2_[v * 4], state_2[v]);
+    }
+  }
+#endif  // __SSE__
   
  private:
+#ifdef __SSE__
+  // Picks the path at compile time, so that ProcessSse only gets
+  // instantiated for banks of whole vectors.
+  template<bool vectorized>
+  struct Vectorized { };
+  
+  template<stmlib::FilterMode mode, bool add>
+  inline void Process(
+      Vectorized<true>,
+      const float* f,
+      const float* q,
+      const float* gain,
+      const float* in,
+      float* out,
+      size_t size) {
+    ProcessSse<mode, add>(f, q, gain, in, out, size);
+  }
+  
+  template<stmlib::FilterMode mode, bool add>
+  inline void Process(
+      Vectorized<false>,
+      const float* f,
+      const float* q,
+      const float* gain,
+      const float* in,
+      float* out,
+      size_t size) {
+    ProcessScalar<mode, add>(f, q, gain, in, out, size);
+  }
+#endif  // __SSE__
+
   float state_1_[batch_size];
   float state_2_[batch_size];
   
@@ -33,9 +33,9 @@
 #include "stmlib/dsp/dsp.h"
 #include "stmlib/dsp/parameter_interpolator.h"
 #include "stmlib/dsp/units.h"
-#include "stmlib/utils/random.h"
 
 #include "plaits/dsp/dsp.h"
+#include "plaits/dsp/voice_random.h"
 #include "plaits/resources.h"
 
 namespace plaits {
@@ -44,8 +44,10 @@ using namespace std;
 using namespace stmlib;
 
 void String::Init(BufferAllocator* allocator) {
-  string_.Init(allocator->Allocate<float>(kDelayLineSize));
-  stretch_.Init(allocator->Allocate<float>(kDelayLineSize / 4));
+  string_.Init(allocator->Allocate<float>(
+      DelayLine<float, kDelayLineSize>::kBufferSize));
+  stretch_.Init(allocator->Allocate<float>(
+      DelayLine<float, kDelayLineSize / 4>::kBufferSize));
   delay_ = 100.0f;
   Reset();
 }
@@ -146,7 +148,7 @@ void String::ProcessInternal(
       float s = 0.0f;
       
       if (non_linearity == STRING_NON_LINEARITY_DISPERSION) {
-        float noise = Random::GetFloat() - 0.5f;
+        float noise = VoiceRandom::GetFloat() - 0.5f;
         ONE_POLE(dispersion_noise_, noise, noise_filter)
         delay *= 1.0f + dispersion_noise_ * noise_amount;
       } else {
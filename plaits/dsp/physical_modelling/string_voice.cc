@@ -31,9 +31,9 @@
 #include <algorithm>
 
 #include "stmlib/dsp/units.h"
-#include "stmlib/utils/random.h"
 
 #include "plaits/dsp/noise/dust.h"
+#include "plaits/dsp/voice_random.h"
 
 namespace plaits {
 
@@ -90,7 +90,7 @@ void StringVoice::Render(
     size_t tail = size - noise_samples;
     float* start = temp;
     while (noise_samples--) {
-      *start++ = 2.0f * Random::GetFloat() - 1.0f;
+      *start++ = 2.0f * VoiceRandom::GetFloat() - 1.0f;
     }
     while (tail--) {
       *start++ = 0.0f;
@@ -30,9 +30,8 @@
 
 #include <algorithm>
 
-#include "stmlib/utils/random.h"
-
 #include "plaits/dsp/oscillator/oscillator.h"
+#include "plaits/dsp/voice_random.h"
 #include "plaits/resources.h"
 
 namespace plaits {
@@ -90,7 +89,7 @@ void LPCSpeechSynth::Render(
     }
     
     float e[11];
-    e[10] = Random::GetSample() > 0 ? noise_energy_ : -noise_energy_;
+    e[10] = VoiceRandom::GetSample() > 0 ? noise_energy_ : -noise_energy_;
     if (excitation_pulse_sample_index_ < LUT_LPC_EXCITATION_PULSE_SIZE) {
       int8_t s = lut_lpc_excitation_pulse[excitation_pulse_sample_index_];
       next_sample += static_cast<float>(s) / 128.0f * pulse_energy_;
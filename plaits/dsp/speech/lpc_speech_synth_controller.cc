@@ -123,6 +123,7 @@ void LPCSpeechSynthWordBank::Init(
 
 void LPCSpeechSynthWordBank::Reset() {
   loaded_bank_ = -1;
+  loading_bank_ = -1;
   num_frames_ = 0;
   num_words_ = 0;
   fill(
@@ -130,77 +131,87 @@ void LPCSpeechSynthWordBank::Reset() {
       &word_boundaries_[kLPCSpeechSynthMaxWords], 0);
 }
 
-size_t LPCSpeechSynthWordBank::LoadNextWord(const uint8_t* data) {
-  BitStream bitstream;
-  bitstream.Init(data);
-
-  LPCSpeechSynth::Frame frame;
-  frame.energy = 0;
-  frame.period = 0;
-  frame.k0 = 0;
-  frame.k1 = 0;
-  frame.k2 = 0;
-  frame.k3 = 0;
-  frame.k4 = 0;
-  frame.k5 = 0;
-  frame.k6 = 0;
-  frame.k7 = 0;
-  frame.k8 = 0;
-  frame.k9 = 0;
-
-  while (true) {
-    int energy = bitstream.GetBits(4);
+void LPCSpeechSynthWordBank::DecodeFrames(int max_frames) {
+  LPCSpeechSynth::Frame& frame = frame_;
+  while (max_frames--) {
+    if (start_of_word_) {
+      word_boundaries_[num_words_] = num_frames_;
+      bitstream_.Init(data_);
+      frame.energy = 0;
+      frame.period = 0;
+      frame.k0 = 0;
+      frame.k1 = 0;
+      frame.k2 = 0;
+      frame.k3 = 0;
+      frame.k4 = 0;
+      frame.k5 = 0;
+      frame.k6 = 0;
+      frame.k7 = 0;
+      frame.k8 = 0;
+      frame.k9 = 0;
+      start_of_word_ = false;
+    }
+    
+    int energy = bitstream_.GetBits(4);
     if (energy == 0) {
       frame.energy = 0;
     } else if (energy == 0xf) {
-      bitstream.Flush();
-      break;
+      bitstream_.Flush();
+      size_t consumed = bitstream_.ptr() - data_;
+      data_ += consumed;
+      remaining_bytes_ -= consumed;
+      ++num_words_;
+      start_of_word_ = true;
+      if (!remaining_bytes_) {
+        word_boundaries_[num_words_] = num_frames_;
+        loaded_bank_ = loading_bank_;
+        loading_bank_ = -1;
+        break;
+      }
+      continue;
     } else {
       frame.energy = energy_lut_[energy];
-      bool repeat = bitstream.GetBits(1);
-      frame.period = period_lut_[bitstream.GetBits(6)];
+      bool repeat = bitstream_.GetBits(1);
+      frame.period = period_lut_[bitstream_.GetBits(6)];
       if (!repeat) {
-        frame.k0 = k0_lut_[bitstream.GetBits(5)];
-        frame.k1 = k1_lut_[bitstream.GetBits(5)];
-        frame.k2 = k2_lut_[bitstream.GetBits(4)];
-        frame.k3 = k3_lut_[bitstream.GetBits(4)];
+        frame.k0 = k0_lut_[bitstream_.GetBits(5)];
+        frame.k1 = k1_lut_[bitstream_.GetBits(5)];
+        frame.k2 = k2_lut_[bitstream_.GetBits(4)];
+        frame.k3 = k3_lut_[bitstream_.GetBits(4)];
         if (frame.period) {
-          frame.k4 = k4_lut_[bitstream.GetBits(4)];
-          frame.k5 = k5_lut_[bitstream.GetBits(4)];
-          frame.k6 = k6_lut_[bitstream.GetBits(4)];
-          frame.k7 = k7_lut_[bitstream.GetBits(3)];
-          frame.k8 = k8_lut_[bitstream.GetBits(3)];
-          frame.k9 = k9_lut_[bitstream.GetBits(3)];
+          frame.k4 = k4_lut_[bitstream_.GetBits(4)];
+          frame.k5 = k5_lut_[bitstream_.GetBits(4)];
+          frame.k6 = k6_lut_[bitstream_.GetBits(4)];
+          frame.k7 = k7_lut_[bitstream_.GetBits(3)];
+          frame.k8 = k8_lut_[bitstream_.GetBits(3)];
+          frame.k9 = k9_lut_[bitstream_.GetBits(3)];
         }
       }
     }
     frames_[num_frames_++] = frame;
   }
-  return bitstream.ptr() - data;
 }
 
-bool LPCSpeechSynthWordBank::Load(int bank) {
-  if (bank == loaded_bank_ || bank >= num_banks_) {
+bool LPCSpeechSynthWordBank::Load(int bank, int max_frames) {
+  if (bank >= num_banks_) {
     return false;
   }
-
-  num_frames_ = 0;
-  num_words_ = 0;
   
-  const uint8_t* data = word_banks_[bank].data;
-  size_t size = word_banks_[bank].size;
+  bool new_bank = bank != loaded_bank_ && bank != loading_bank_;
+  if (new_bank) {
+    loaded_bank_ = -1;
+    loading_bank_ = bank;
+    num_frames_ = 0;
+    num_words_ = 0;
+    data_ = word_banks_[bank].data;
+    remaining_bytes_ = word_banks_[bank].size;
+    start_of_word_ = true;
+  }
   
-  while (size) {
-    word_boundaries_[num_words_] = num_frames_;
-    size_t consumed = LoadNextWord(data);
-
-    data += consumed;
-    size -= consumed;
-    ++num_words_;
+  if (loading_bank_ != -1) {
+    DecodeFrames(max_frames);
   }
-  word_boundaries_[num_words_] = num_frames_;
-  loaded_bank_ = bank;
-  return true;
+  return new_bank;
 }
 
 void LPCSpeechSynthController::Init(LPCSpeechSynthWordBank* word_bank) {
@@ -210,6 +221,10 @@ void LPCSpeechSynthController::Init(LPCSpeechSynthWordBank* word_bank) {
   playback_frame_ = -1;
   last_playback_frame_ = -1;
   remaining_frame_samples_ = 0;
+  trigger_pending_ = false;
+#ifdef TEST
+  frames_per_block_ = kLPCSpeechSynthFramesPerBlock;
+#endif  // TEST
 
   fill(&sample_[0], &sample_[2], 0.0f);
   fill(&next_sample_[0], &next_sample_[2], 0.0f);
@@ -243,13 +258,29 @@ void LPCSpeechSynthController::Render(
             : (formant_shift > 0.6f ? (formant_shift - 0.6f) * -45.0f : 0.0f)));
   
   if (bank != -1) {
-    bool reset_everything = word_bank_->Load(bank);
+#ifdef TEST
+    const int max_frames = frames_per_block_;
+#else
+    const int max_frames = kLPCSpeechSynthFramesPerBlock;
+#endif  // TEST
+    bool reset_everything = word_bank_->Load(bank, max_frames);
     if (reset_everything) {
       playback_frame_ = -1;
       last_playback_frame_ = -1;
     }
   }
   
+  // The frames of a bank cannot be played before it is fully decoded. Until
+  // then, the synth holds its current frame and triggers are deferred.
+  const bool ready = bank == -1 || word_bank_->ready();
+  if (!ready) {
+    trigger_pending_ = trigger_pending_ || trigger;
+    trigger = false;
+  } else if (trigger_pending_) {
+    trigger = true;
+    trigger_pending_ = false;
+  }
+  
   const int num_frames = bank == -1
       ? kLPCSpeechSynthNumVowels
       : word_bank_->num_frames();
@@ -275,23 +306,25 @@ void LPCSpeechSynthController::Render(
     remaining_frame_samples_ = 0;
   }
   
-  if (playback_frame_ == -1 && remaining_frame_samples_ == 0) {
-    synth_.PlayFrame(
-        frames,
-        address * (static_cast<float>(num_frames) - 1.0001f),
-        true);
-  } else {
-    if (remaining_frame_samples_ == 0) {
-      synth_.PlayFrame(frames, float(playback_frame_), false);
-      remaining_frame_samples_ = kSampleRate / kLPCSpeechSynthFPS * \
-          time_stretch;
-      ++playback_frame_;
-      if (playback_frame_ >= last_playback_frame_) {
-        bool back_to_scan_mode = bank == -1 || free_running;
-        playback_frame_ = back_to_scan_mode ? -1 : last_playback_frame_;
+  if (ready) {
+    if (playback_frame_ == -1 && remaining_frame_samples_ == 0) {
+      synth_.PlayFrame(
+          frames,
+          address * (static_cast<float>(num_frames) - 1.0001f),
+          true);
+    } else {
+      if (remaining_frame_samples_ == 0) {
+        synth_.PlayFrame(frames, float(playback_frame_), false);
+        remaining_frame_samples_ = kSampleRate / kLPCSpeechSynthFPS * \
+            time_stretch;
+        ++playback_frame_;
+        if (playback_frame_ >= last_playback_frame_) {
+          bool back_to_scan_mode = bank == -1 || free_running;
+          playback_frame_ = back_to_scan_mode ? -1 : last_playback_frame_;
+        }
       }
+      remaining_frame_samples_ -= min(size, remaining_frame_samples_);
     }
-    remaining_frame_samples_ -= min(size, remaining_frame_samples_);
   }
   
   ParameterInterpolator gain_modulation(&gain_, gain, size);
@@ -92,6 +92,10 @@ const int kLPCSpeechSynthNumPhonemes = \
     kLPCSpeechSynthNumVowels + kLPCSpeechSynthNumConsonants;
 const float kLPCSpeechSynthFPS = 40.0f;
 
+// Maximum number of frames decoded per block after a bank change, so that the
+// decoding cost is spread over several blocks instead of causing a spike.
+const int kLPCSpeechSynthFramesPerBlock = 32;
+
 struct LPCSpeechSynthWordBankData {
   const uint8_t* data;
   size_t size;
@@ -107,9 +111,15 @@ class LPCSpeechSynthWordBank {
       int num_banks,
       stmlib::BufferAllocator* allocator);
   
-  bool Load(int index);
+  // Starts decoding a bank if it is not the one loaded (returns true), and
+  // decodes at most max_frames of it.
+  bool Load(int index, int max_frames);
   void Reset();
   
+  // False while a bank is still being decoded. Its frames and word
+  // boundaries are incomplete until then.
+  inline bool ready() const { return loading_bank_ == -1; }
+  
   inline int num_frames() const { return num_frames_; }
   inline const LPCSpeechSynth::Frame* frames() const { return frames_; }
   
@@ -127,18 +137,26 @@ class LPCSpeechSynthWordBank {
   }
   
  private:
-  size_t LoadNextWord(const uint8_t* data);
+  void DecodeFrames(int max_frames);
   
   const LPCSpeechSynthWordBankData* word_banks_;
   
   int num_banks_;
   int loaded_bank_;
+  int loading_bank_;
   int num_frames_;
   int num_words_;
   int word_boundaries_[kLPCSpeechSynthMaxWords];
   
   LPCSpeechSynth::Frame* frames_;
   
+  // Decoder state, kept between blocks.
+  const uint8_t* data_;
+  size_t remaining_bytes_;
+  bool start_of_word_;
+  BitStream bitstream_;
+  LPCSpeechSynth::Frame frame_;
+  
   static uint8_t energy_lut_[16];
   static uint8_t period_lut_[64];
   static int16_t k0_lut_[32];
@@ -174,6 +192,14 @@ class LPCSpeechSynthController {
       float* output,
       size_t size);
   
+#ifdef TEST
+  // Lets the tests decode a bank in one go, as before the decoding was
+  // spread over blocks.
+  void set_frames_per_block(int frames_per_block) {
+    frames_per_block_ = frames_per_block;
+  }
+#endif  // TEST
+  
  private:
   float clock_phase_;
   float sample_[2];
@@ -184,9 +210,14 @@ class LPCSpeechSynthController {
   int playback_frame_;
   int last_playback_frame_;
   size_t remaining_frame_samples_;
+  bool trigger_pending_;
 
   LPCSpeechSynthWordBank* word_bank_;
   
+#ifdef TEST
+  int frames_per_block_;
+#endif  // TEST
+  
   static const LPCSpeechSynth::Frame phonemes_[kLPCSpeechSynthNumPhonemes];
   
   DISALLOW_COPY_AND_ASSIGN(LPCSpeechSynthController);
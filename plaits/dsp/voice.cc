@@ -28,11 +28,16 @@
 
 #include "plaits/dsp/voice.h"
 
+#include "plaits/dsp/voice_random.h"
+
 namespace plaits {
 
 using namespace std;
 using namespace stmlib;
 
+/* static */
+VOICE_RANDOM_STATE uint32_t VoiceRandom::rng_state_ = 0x21;
+
 void Voice::Init(BufferAllocator* allocator) {
   engines_.Init();
   engines_.RegisterInstance(&virtual_analog_engine_, false, 0.8f, 0.8f);
@@ -62,6 +67,13 @@ void Voice::Init(BufferAllocator* allocator) {
   previous_engine_index_ = -1;
   engine_cv_ = 0.0f;
   
+  engine_crossfade_ = false;
+  crossfade_position_ = kEngineCrossfadeSize;
+  crossfade_history_ptr_ = 0;
+  for (size_t i = 0; i < kEngineCrossfadeSize; ++i) {
+    crossfade_history_[i].out = crossfade_history_[i].aux = 0;
+  }
+  
   out_post_processor_.Init();
   aux_post_processor_.Init();
 
@@ -117,6 +129,9 @@ void Voice::Render(
   if (engine_index != previous_engine_index_) {
     e->Reset();
     out_post_processor_.Reset();
+    if (engine_crossfade_ && previous_engine_index_ != -1) {
+      StartEngineCrossfade();
+    }
     previous_engine_index_ = engine_index;
   }
   EngineParameters p;
@@ -132,10 +147,10 @@ void Voice::Render(
     p.trigger = TRIGGER_UNPATCHED;
   }
   
-  const float short_decay = (200.0f * kBlockSize) / kSampleRate *
+  const float short_decay = (200.0f * kHardwareBlockSize) / kSampleRate *
       SemitonesToRatio(-96.0f * patch.decay);
 
-  decay_envelope_.Process(short_decay * 2.0f);
+  decay_envelope_.Process(BlockRateCoefficient(short_decay * 2.0f));
 
   const float compressed_level = max(
       1.3f * modulations.level / (0.3f + fabsf(modulations.level)),
@@ -204,7 +219,7 @@ void Voice::Render(
   // Compute LPG parameters.
   if (!lpg_bypass) {
     const float hf = patch.lpg_colour;
-    const float decay_tail = (20.0f * kBlockSize) / kSampleRate *
+    const float decay_tail = (20.0f * kHardwareBlockSize) / kSampleRate *
         SemitonesToRatio(-72.0f * patch.decay + 12.0f * hf) - short_decay;
     
     if (modulations.level_patched) {
@@ -236,6 +251,45 @@ void Voice::Render(
       &frames->aux,
       size,
       2);
+  
+  if (engine_crossfade_) {
+    RenderEngineCrossfade(frames, size);
+  }
+}
+
+void Voice::StartEngineCrossfade() {
+  // The engines share their RAM, so the previous one cannot keep running.
+  // Instead, its last output is played backwards from the most recent
+  // sample, which keeps the waveform continuous at the switch.
+  size_t ptr = crossfade_history_ptr_;
+  for (size_t i = 0; i < kEngineCrossfadeSize; ++i) {
+    ptr = ptr == 0 ? kEngineCrossfadeSize - 1 : ptr - 1;
+    crossfade_tail_[i] = crossfade_history_[ptr];
+  }
+  crossfade_position_ = 0;
+}
+
+void Voice::RenderEngineCrossfade(Frame* frames, size_t size) {
+  const float step = 1.0f / float(kEngineCrossfadeSize + 1);
+  for (size_t i = 0; i < size && crossfade_position_ < kEngineCrossfadeSize;
+       ++i) {
+    const Frame& tail = crossfade_tail_[crossfade_position_++];
+    const float fade_in = float(crossfade_position_) * step;
+    frames[i].out = static_cast<short>(
+        tail.out + fade_in * float(frames[i].out - tail.out));
+    frames[i].aux = static_cast<short>(
+        tail.aux + fade_in * float(frames[i].aux - tail.aux));
+  }
+  
+  // Keep the last frames actually sent out, in case the engine changes again
+  // during the fade.
+  size_t i = size > kEngineCrossfadeSize ? size - kEngineCrossfadeSize : 0;
+  size_t ptr = crossfade_history_ptr_;
+  for (; i < size; ++i) {
+    crossfade_history_[ptr] = frames[i];
+    ptr = ptr == kEngineCrossfadeSize - 1 ? 0 : ptr + 1;
+  }
+  crossfade_history_ptr_ = ptr;
 }
   
 }  // namespace plaits
@@ -61,7 +61,26 @@ namespace plaits {
 
 const int kMaxEngines = 16;
 const int kMaxTriggerDelay = 8;
-const int kTriggerDelay = 5;
+
+// The trigger is delayed by about 1ms, counted in blocks. The delay line is
+// read right after the trigger of the current block is written, hence the
+// extra block.
+const float kTriggerDelayTime = 0.001f;
+const int kTriggerDelayBlocks = static_cast<int>(
+    kTriggerDelayTime * kSampleRate / static_cast<float>(kBlockSize) + 0.5f);
+const int kTriggerDelay = kTriggerDelayBlocks + 1 < kMaxTriggerDelay
+    ? kTriggerDelayBlocks + 1
+    : kMaxTriggerDelay - 1;
+
+// When the engine changes, the last output of the previous engine is played
+// backwards and faded out over about 1ms, while the new one fades in. This
+// adds two buffers of kEngineCrossfadeSize frames to the voice (384 bytes).
+const size_t kEngineCrossfadeSize = 48;
+
+// The engines share a 16 kB arena on the hardware. Their temporary buffers
+// grow with kMaxBlockSize in host builds rendering larger blocks.
+const size_t kVoiceRamSize = 16384 + \
+    4 * (kMaxBlockSize - 2 * kHardwareBlockSize) * sizeof(float);
 
 class ChannelPostProcessor {
  public:
@@ -163,9 +182,14 @@ class Voice {
       Frame* frames,
       size_t size);
   inline int active_engine() const { return previous_engine_index_; }
+  inline void set_engine_crossfade(bool engine_crossfade) {
+    engine_crossfade_ = engine_crossfade;
+  }
     
  private:
   void ComputeDecayParameters(const Patch& settings);
+  void StartEngineCrossfade();
+  void RenderEngineCrossfade(Frame* frames, size_t size);
   
   inline float ApplyModulations(
       float base_value,
@@ -217,7 +241,7 @@ class Voice {
   DecayEnvelope decay_envelope_;
   LPGEnvelope lpg_envelope_;
   
-  float trigger_delay_line_[kMaxTriggerDelay];
+  float trigger_delay_line_[kMaxTriggerDelay + kDelayLineGuardSize];
   DelayLine<float, kMaxTriggerDelay> trigger_delay_;
   
   ChannelPostProcessor out_post_processor_;
@@ -225,6 +249,12 @@ class Voice {
   
   EngineRegistry<kMaxEngines> engines_;
   
+  bool engine_crossfade_;
+  size_t crossfade_position_;
+  size_t crossfade_history_ptr_;
+  Frame crossfade_history_[kEngineCrossfadeSize];
+  Frame crossfade_tail_[kEngineCrossfadeSize];
+  
   float out_buffer_[kMaxBlockSize];
   float aux_buffer_[kMaxBlockSize];
   
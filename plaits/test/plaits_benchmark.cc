@@ -0,0 +1,353 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// CPU benchmark for the engines of the Plaits voice.
+//
+// Every engine registered by Voice::Init is rendered through Voice::Render
+// while HARMONICS, TIMBRE, MORPH and the note are swept one at a time (the
+// others sit at mid-range), for several block sizes. Each setting reports the
+// cost per sample of its blocks: mean, 99th percentile and worst case. The
+// setting is measured several times and the run with the lowest mean is kept,
+// which filters out most of the noise from the host scheduler.
+//
+// Results go to stdout as JSON, one setting per line. Passing a previous run
+// with -b compares against it and exits with an error when the mean or p99 of
+// a setting regressed by more than the tolerance (-t, 1.25 by default).
+//
+// Usage: plaits_benchmark [-b baseline.json] [-t tolerance] [-e engine]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <xmmintrin.h>
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/dsp/voice.h"
+
+#include "stmlib/utils/buffer_allocator.h"
+
+using namespace std;
+using namespace stmlib;
+using namespace plaits;
+
+// In the order of Voice::Init.
+const char* const kEngineNames[] = {
+  "virtual_analog",
+  "waveshaping",
+  "fm",
+  "grain",
+  "additive",
+  "wavetable",
+  "chord",
+  "speech",
+  "swarm",
+  "noise",
+  "particle",
+  "string",
+  "modal",
+  "bass_drum",
+  "snare_drum",
+  "hi_hat",
+};
+const int kNumEngines = sizeof(kEngineNames) / sizeof(kEngineNames[0]);
+
+enum SweptParameter {
+  SWEPT_PARAMETER_HARMONICS,
+  SWEPT_PARAMETER_TIMBRE,
+  SWEPT_PARAMETER_MORPH,
+  SWEPT_PARAMETER_NOTE,
+  SWEPT_PARAMETER_LAST
+};
+
+const char* const kSweptParameterNames[] = {
+  "harmonics",
+  "timbre",
+  "morph",
+  "note",
+};
+
+const float kSweepValues[] = { 0.0f, 0.25f, 0.5f, 0.75f, 1.0f };
+const int kNumSweepValues = sizeof(kSweepValues) / sizeof(float);
+
+// Some engines process their buffers 4 samples at a time.
+const size_t kBlockSizes[] = { 4, 8, kBlockSize, kMaxBlockSize };
+const int kNumBlockSizes = sizeof(kBlockSizes) / sizeof(size_t);
+
+const int kNumRuns = 3;
+const size_t kWarmUpSamples = 4800;
+const size_t kMeasuredSamples = 24000;
+
+// Retrigger regularly, so that the percussive engines keep doing some work.
+const size_t kTriggerPeriod = 9600;
+const size_t kTriggerDuration = 48;
+
+const size_t kMaxRecords = kNumEngines * SWEPT_PARAMETER_LAST * \
+    kNumSweepValues * kNumBlockSizes;
+
+struct Record {
+  char engine[32];
+  char parameter[16];
+  float value;
+  size_t block_size;
+  float mean;
+  float p99;
+  float worst;
+};
+
+char ram_block[kVoiceRamSize];
+
+void InitPatch(int engine, Patch* patch, Modulations* modulations) {
+  patch->engine = engine;
+  patch->note = 48.0f;
+  patch->harmonics = 0.5f;
+  patch->timbre = 0.5f;
+  patch->morph = 0.5f;
+  patch->frequency_modulation_amount = 0.0f;
+  patch->timbre_modulation_amount = 0.0f;
+  patch->morph_modulation_amount = 0.0f;
+  patch->decay = 0.5f;
+  patch->lpg_colour = 0.5f;
+
+  modulations->engine = 0.0f;
+  modulations->note = 0.0f;
+  modulations->frequency = 0.0f;
+  modulations->harmonics = 0.0f;
+  modulations->timbre = 0.0f;
+  modulations->morph = 0.0f;
+  modulations->trigger = 0.0f;
+  modulations->level = 1.0f;
+  modulations->frequency_patched = false;
+  modulations->timbre_patched = false;
+  modulations->morph_patched = false;
+  modulations->trigger_patched = true;
+  modulations->level_patched = false;
+}
+
+void Sweep(SweptParameter parameter, float value, Patch* patch) {
+  switch (parameter) {
+    case SWEPT_PARAMETER_HARMONICS:
+      patch->harmonics = value;
+      break;
+    case SWEPT_PARAMETER_TIMBRE:
+      patch->timbre = value;
+      break;
+    case SWEPT_PARAMETER_MORPH:
+      patch->morph = value;
+      break;
+    default:
+      patch->note = 24.0f + 72.0f * value;
+      break;
+  }
+}
+
+void Measure(
+    Voice* voice,
+    const Patch& patch,
+    Modulations* modulations,
+    size_t block_size,
+    vector<float>* ns_per_sample,
+    Record* record) {
+  Voice::Frame frames[kMaxBlockSize];
+  size_t num_warm_up_blocks = kWarmUpSamples / block_size;
+  size_t num_blocks = num_warm_up_blocks + kMeasuredSamples / block_size;
+
+  ns_per_sample->clear();
+  for (size_t i = 0; i < num_blocks; ++i) {
+    size_t t = i * block_size;
+    modulations->trigger = t % kTriggerPeriod < kTriggerDuration ? 1.0f : 0.0f;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    voice->Render(patch, *modulations, frames, block_size);
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    if (i >= num_warm_up_blocks) {
+      float ns = chrono::duration<float, nano>(end - start).count();
+      ns_per_sample->push_back(ns / static_cast<float>(block_size));
+    }
+  }
+
+  vector<float>& v = *ns_per_sample;
+  sort(v.begin(), v.end());
+  float sum = 0.0f;
+  for (size_t i = 0; i < v.size(); ++i) {
+    sum += v[i];
+  }
+  record->block_size = block_size;
+  record->mean = sum / static_cast<float>(v.size());
+  record->p99 = v[(v.size() - 1) * 99 / 100];
+  record->worst = v.back();
+}
+
+void WriteRecord(const Record& r, bool last) {
+  printf(
+      "    { \"engine\": \"%s\", \"parameter\": \"%s\", \"value\": %.2f, "
+      "\"block_size\": %zu, \"mean_ns\": %.2f, \"p99_ns\": %.2f, "
+      "\"worst_ns\": %.2f }%s\n",
+      r.engine, r.parameter, r.value, r.block_size,
+      r.mean, r.p99, r.worst,
+      last ? "" : ",");
+}
+
+// Reads back the lines written by WriteRecord; everything else is skipped.
+size_t ReadBaseline(const char* file_name, Record* records, size_t max_size) {
+  FILE* fp = fopen(file_name, "r");
+  if (!fp) {
+    fprintf(stderr, "Could not open baseline %s\n", file_name);
+    exit(2);
+  }
+  char line[256];
+  size_t size = 0;
+  while (size < max_size && fgets(line, sizeof(line), fp)) {
+    Record* r = &records[size];
+    int n = sscanf(
+        line,
+        " { \"engine\": \"%31[^\"]\", \"parameter\": \"%15[^\"]\", "
+        "\"value\": %f, \"block_size\": %zu, \"mean_ns\": %f, "
+        "\"p99_ns\": %f, \"worst_ns\": %f",
+        r->engine, r->parameter, &r->value, &r->block_size,
+        &r->mean, &r->p99, &r->worst);
+    if (n == 7) {
+      ++size;
+    }
+  }
+  fclose(fp);
+  return size;
+}
+
+const Record* FindRecord(
+    const Record& r,
+    const Record* records,
+    size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    const Record& b = records[i];
+    if (!strcmp(b.engine, r.engine) &&
+        !strcmp(b.parameter, r.parameter) &&
+        b.block_size == r.block_size &&
+        fabsf(b.value - r.value) < 0.01f) {
+      return &b;
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+
+  const char* baseline_file_name = NULL;
+  float tolerance = 1.25f;
+  int only_engine = -1;
+  for (int i = 1; i < argc - 1; i += 2) {
+    if (!strcmp(argv[i], "-b")) {
+      baseline_file_name = argv[i + 1];
+    } else if (!strcmp(argv[i], "-t")) {
+      tolerance = atof(argv[i + 1]);
+    } else if (!strcmp(argv[i], "-e")) {
+      only_engine = atoi(argv[i + 1]);
+    }
+  }
+
+  static Record records[kMaxRecords];
+  static Record baseline[kMaxRecords];
+  size_t num_records = 0;
+  size_t baseline_size = baseline_file_name
+      ? ReadBaseline(baseline_file_name, baseline, kMaxRecords)
+      : 0;
+
+  BufferAllocator allocator(ram_block, sizeof(ram_block));
+  Voice voice;
+  voice.Init(&allocator);
+
+  Patch patch;
+  Modulations modulations;
+  vector<float> ns_per_sample;
+  ns_per_sample.reserve(kMeasuredSamples / kBlockSizes[0]);
+
+  for (int e = 0; e < kNumEngines; ++e) {
+    if (only_engine != -1 && e != only_engine) {
+      continue;
+    }
+    for (int p = 0; p < SWEPT_PARAMETER_LAST; ++p) {
+      for (int v = 0; v < kNumSweepValues; ++v) {
+        for (int b = 0; b < kNumBlockSizes; ++b) {
+          SweptParameter parameter = static_cast<SweptParameter>(p);
+          InitPatch(e, &patch, &modulations);
+          Sweep(parameter, kSweepValues[v], &patch);
+
+          Record* r = &records[num_records++];
+          strcpy(r->engine, kEngineNames[e]);
+          strcpy(r->parameter, kSweptParameterNames[p]);
+          r->value = kSweepValues[v];
+          for (int run = 0; run < kNumRuns; ++run) {
+            Record candidate = *r;
+            Measure(
+                &voice,
+                patch,
+                &modulations,
+                kBlockSizes[b],
+                &ns_per_sample,
+                &candidate);
+            if (run == 0 || candidate.mean < r->mean) {
+              *r = candidate;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  printf("{\n  \"sample_rate\": %.0f,\n  \"results\": [\n", kSampleRate);
+  for (size_t i = 0; i < num_records; ++i) {
+    WriteRecord(records[i], i == num_records - 1);
+  }
+  printf("  ]\n}\n");
+
+  int num_regressions = 0;
+  for (size_t i = 0; baseline_size && i < num_records; ++i) {
+    const Record& r = records[i];
+    const Record* b = FindRecord(r, baseline, baseline_size);
+    if (!b) {
+      continue;
+    }
+    // The worst case is dominated by the host scheduler; it is reported,
+    // but not checked.
+    if (r.mean > b->mean * tolerance || r.p99 > b->p99 * tolerance) {
+      fprintf(
+          stderr,
+          "%s %s=%.2f block_size=%zu: mean %.2f ns (was %.2f), "
+          "p99 %.2f ns (was %.2f)\n",
+          r.engine, r.parameter, r.value, r.block_size,
+          r.mean, b->mean, r.p99, b->p99);
+      ++num_regressions;
+    }
+  }
+  if (num_regressions) {
+    fprintf(stderr, "%d settings regressed\n", num_regressions);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,215 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Polyphony benchmark for the Plaits voice.
+//
+// Each engine renders a bank of voices (-v, 32 by default) through
+// PolyphonicVoice, on one thread and then on -j threads (the number of
+// hardware threads by default). The voices play different notes with
+// different settings, and are retriggered at staggered times. Each run
+// reports how much faster than real time the bank renders, and how many such
+// voices a core sustains in real time. The mix must not depend on the number
+// of threads: each run also reports whether it is identical to the mix
+// rendered on one thread, and the program fails if it is not.
+//
+// Results go to stdout as JSON, one run per line.
+//
+// Usage: plaits_polyphony_benchmark [-v voices] [-j threads] [-e engine]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <xmmintrin.h>
+
+#include "plaits/dsp/dsp.h"
+#include "plaits/test/polyphonic_voice.h"
+
+using namespace std;
+using namespace plaits;
+
+// In the order of Voice::Init.
+const char* const kEngineNames[] = {
+  "virtual_analog",
+  "waveshaping",
+  "fm",
+  "grain",
+  "additive",
+  "wavetable",
+  "chord",
+  "speech",
+  "swarm",
+  "noise",
+  "particle",
+  "string",
+  "modal",
+  "bass_drum",
+  "snare_drum",
+  "hi_hat",
+};
+const int kNumEngines = sizeof(kEngineNames) / sizeof(kEngineNames[0]);
+
+const size_t kWarmUpSamples = 4800;
+const size_t kMeasuredSamples = 96000;
+
+const size_t kTriggerPeriod = 9600;
+const size_t kTriggerDuration = 48;
+
+void InitVoice(
+    int engine,
+    int voice,
+    int num_voices,
+    Patch* patch,
+    Modulations* modulations) {
+  float x = static_cast<float>(voice) / static_cast<float>(num_voices);
+  patch->engine = engine;
+  patch->note = 36.0f + static_cast<float>((voice * 7) % 36);
+  patch->harmonics = x;
+  patch->timbre = 1.0f - x;
+  patch->morph = 0.25f + 0.5f * x;
+  patch->frequency_modulation_amount = 0.0f;
+  patch->timbre_modulation_amount = 0.0f;
+  patch->morph_modulation_amount = 0.0f;
+  patch->decay = 0.5f;
+  patch->lpg_colour = 0.5f;
+
+  modulations->engine = 0.0f;
+  modulations->note = 0.0f;
+  modulations->frequency = 0.0f;
+  modulations->harmonics = 0.0f;
+  modulations->timbre = 0.0f;
+  modulations->morph = 0.0f;
+  modulations->trigger = 0.0f;
+  modulations->level = 1.0f;
+  modulations->frequency_patched = false;
+  modulations->timbre_patched = false;
+  modulations->morph_patched = false;
+  modulations->trigger_patched = true;
+  modulations->level_patched = false;
+}
+
+// Returns the wall-clock time taken to render num_samples, in seconds, and
+// folds the mix into an FNV-1a hash.
+float Run(
+    PolyphonicVoice* poly,
+    size_t start,
+    size_t num_samples,
+    uint32_t* hash) {
+  float out[kMaxBlockSize];
+  float aux[kMaxBlockSize];
+  int num_voices = poly->num_voices();
+  
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  for (size_t t = start; t < start + num_samples; t += kMaxBlockSize) {
+    for (int i = 0; i < num_voices; ++i) {
+      size_t phase = t + i * kTriggerPeriod / num_voices;
+      poly->mutable_modulations(i)->trigger = \
+          phase % kTriggerPeriod < kTriggerDuration ? 1.0f : 0.0f;
+    }
+    poly->Render(out, aux, kMaxBlockSize);
+    const uint8_t* bytes[2] = {
+      reinterpret_cast<const uint8_t*>(out),
+      reinterpret_cast<const uint8_t*>(aux)
+    };
+    for (int b = 0; b < 2; ++b) {
+      for (size_t j = 0; j < sizeof(out); ++j) {
+        *hash = (*hash ^ bytes[b][j]) * 16777619u;
+      }
+    }
+  }
+  chrono::steady_clock::time_point end = chrono::steady_clock::now();
+  return chrono::duration<float>(end - begin).count();
+}
+
+int main(int argc, char** argv) {
+  _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+
+  int num_voices = 32;
+  int num_cores = max(static_cast<int>(thread::hardware_concurrency()), 1);
+  int num_threads = num_cores;
+  int only_engine = -1;
+  for (int i = 1; i < argc - 1; i += 2) {
+    if (!strcmp(argv[i], "-v")) {
+      num_voices = atoi(argv[i + 1]);
+    } else if (!strcmp(argv[i], "-j")) {
+      num_threads = atoi(argv[i + 1]);
+    } else if (!strcmp(argv[i], "-e")) {
+      only_engine = atoi(argv[i + 1]);
+    }
+  }
+  num_voices = min(max(num_voices, 1), kMaxPolyphony);
+  num_threads = min(max(num_threads, 1), kMaxRenderThreads);
+  
+  int thread_counts[] = { 1, num_threads };
+  int num_thread_counts = num_threads == 1 ? 1 : 2;
+  bool first = true;
+  bool all_identical = true;
+  
+  static PolyphonicVoice poly;
+  printf(
+      "{\n  \"sample_rate\": %.0f,\n  \"hardware_threads\": %d,\n"
+      "  \"results\": [\n",
+      kSampleRate, num_cores);
+  for (int e = 0; e < kNumEngines; ++e) {
+    if (only_engine != -1 && e != only_engine) {
+      continue;
+    }
+    uint32_t hashes[2];
+    for (int c = 0; c < num_thread_counts; ++c) {
+      int threads = thread_counts[c];
+      poly.Init(num_voices, threads);
+      for (int i = 0; i < num_voices; ++i) {
+        InitVoice(
+            e, i, num_voices, poly.mutable_patch(i),
+            poly.mutable_modulations(i));
+      }
+      hashes[c] = 2166136261u;
+      Run(&poly, 0, kWarmUpSamples, &hashes[c]);
+      float elapsed = Run(
+          &poly, kWarmUpSamples, kMeasuredSamples, &hashes[c]);
+      bool identical = hashes[c] == hashes[0];
+      all_identical = all_identical && identical;
+      
+      float realtime_factor = static_cast<float>(kMeasuredSamples) / \
+          kSampleRate / elapsed;
+      // More threads than cores do not add any computing power.
+      int cores = min(threads, num_cores);
+      float voices_per_core = realtime_factor * num_voices / cores;
+      printf(
+          "%s    { \"engine\": \"%s\", \"voices\": %d, \"threads\": %d, "
+          "\"realtime_factor\": %.2f, \"voices_per_core\": %.1f, "
+          "\"identical\": %s }",
+          first ? "" : ",\n",
+          kEngineNames[e], num_voices, threads,
+          realtime_factor, voices_per_core, identical ? "true" : "false");
+      first = false;
+    }
+  }
+  printf("\n  ]\n}\n");
+  poly.Stop();
+  return all_identical ? 0 : 1;
+}
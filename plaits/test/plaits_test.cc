@@ -18,6 +18,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <xmmintrin.h>
 
 #include "plaits/dsp/dsp.h"
@@ -41,6 +42,8 @@
 
 #include "plaits/dsp/fx/sample_rate_reducer.h"
 
+#include "plaits/dsp/noise/block_random_generator.h"
+
 #include "plaits/dsp/oscillator/formant_oscillator.h"
 #include "plaits/dsp/oscillator/grainlet_oscillator.h"
 #include "plaits/dsp/oscillator/harmonic_oscillator.h"
@@ -51,9 +54,17 @@
 #include "plaits/dsp/oscillator/vosim_oscillator.h"
 #include "plaits/dsp/oscillator/z_oscillator.h"
 
+#include "plaits/dsp/physical_modelling/delay_line.h"
+#include "plaits/dsp/physical_modelling/resonator.h"
+
+#include "plaits/dsp/speech/lpc_speech_synth_controller.h"
+#include "plaits/dsp/speech/lpc_speech_synth_words.h"
+
 #include "plaits/dsp/voice.h"
+#include "plaits/dsp/voice_random.h"
 
 #include "stmlib/test/wav_writer.h"
+#include "stmlib/utils/random.h"
 
 using namespace std;
 using namespace stmlib;
@@ -61,7 +72,32 @@ using namespace plaits;
 
 const size_t kAudioBlockSize = 24;
 
-char ram_block[16 * 1024];
+char ram_block[kVoiceRamSize];
+
+// Checks a rendering against its reference code, sample by sample, and
+// reports whether the largest difference stays within the tolerance.
+bool CompareWithReference(
+    const char* name,
+    const float* out,
+    const float* reference,
+    size_t size,
+    float tolerance) {
+  float max_error = 0.0f;
+  float peak = 0.0f;
+  for (size_t i = 0; i < size; ++i) {
+    max_error = max(max_error, fabsf(out[i] - reference[i]));
+    peak = max(peak, fabsf(reference[i]));
+  }
+  const bool pass = max_error <= tolerance;
+  printf(
+      "%s: %s, max error %g (tolerance %g, peak %g)\n",
+      name,
+      pass ? "PASS" : "FAIL",
+      max_error,
+      tolerance,
+      peak);
+  return pass;
+}
 
 void TestOscillator() {
   WavWriter wav_writer(1, kSampleRate, 20);
@@ -239,8 +275,9 @@ void TestAdditiveEngine() {
   WavWriter wav_writer(2, kSampleRate, 60);
   wav_writer.Open("plaits_additive_engine.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   AdditiveEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -259,11 +296,68 @@ void TestAdditiveEngine() {
   }
 }
 
+// Compares the additive engine with and without the skipping of the
+// harmonics below -80 dB, over sweeps of all its parameters. The skipped
+// harmonics are silent, but their amplitude jumps instead of ramping, so
+// the difference must stay below -60 dB.
+bool TestHarmonicSilenceThreshold() {
+  const size_t size = kSampleRate * 60;
+  
+  float* out = new float[size];
+  float* aux = new float[size];
+  float* out_reference = new float[size];
+  float* aux_reference = new float[size];
+  
+  clock_t time[2] = { 0, 0 };
+  for (int skip = 0; skip < 2; ++skip) {
+    BufferAllocator allocator(ram_block, kVoiceRamSize);
+    AdditiveEngine e;
+    e.Init(&allocator);
+    e.Reset();
+    if (!skip) {
+      e.set_harmonic_silence_threshold(0.0f);
+    }
+    
+    EngineParameters p;
+    p.trigger = TRIGGER_LOW;
+    p.accent = 0.0f;
+    for (size_t i = 0; i < size; i += kAudioBlockSize) {
+      const float t = static_cast<float>(i) / kSampleRate;
+      p.note = 24.0f + 72.0f * (0.5f + 0.5f * sinf(t * 0.31f));
+      p.timbre = 0.5f + 0.5f * sinf(t * 1.3f);
+      p.morph = 0.5f + 0.5f * sinf(t * 0.7f);
+      p.harmonics = 0.5f + 0.5f * sinf(t * 0.23f);
+      bool already_enveloped;
+      float* o = skip ? &out[i] : &out_reference[i];
+      float* a = skip ? &aux[i] : &aux_reference[i];
+      clock_t start = clock();
+      e.Render(p, o, a, kAudioBlockSize, &already_enveloped);
+      time[skip] += clock() - start;
+    }
+  }
+  
+  bool pass = CompareWithReference(
+      "Additive engine, out", out, out_reference, size, 1e-3f);
+  pass = CompareWithReference(
+      "Additive engine, aux", aux, aux_reference, size, 1e-3f) && pass;
+  printf(
+      "Additive engine: %.1f ns/sample (all harmonics %.1f), speedup %.2fx\n",
+      1e9f * float(time[1]) / CLOCKS_PER_SEC / size,
+      1e9f * float(time[0]) / CLOCKS_PER_SEC / size,
+      float(time[0]) / float(max(time[1], clock_t(1))));
+  
+  delete[] out;
+  delete[] aux;
+  delete[] out_reference;
+  delete[] aux_reference;
+  return pass;
+}
+
 void TestChordEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_chord_engine.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   ChordEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -288,8 +382,9 @@ void TestFMEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_fm_engine.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   FMEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -312,8 +407,9 @@ void TestGrainEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_grain_engine.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   GrainEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -337,8 +433,9 @@ void TestModalEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_modal_engine.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   ModalEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -365,11 +462,335 @@ void TestModalEngine() {
   }
 }
 
+// Compares a bank of modes rendered in one call (vectorized on the host)
+// with the module's scalar batches of 4.
+template<int num_modes>
+bool TestResonatorSvfBank() {
+  const int num_batches = num_modes / 4;
+  const size_t size = kSampleRate * 10;
+  
+  float* in = new float[size];
+  float* out_scalar = new float[size];
+  float* out = new float[size];
+  for (size_t i = 0; i < size; ++i) {
+    in[i] = i % 4800 == 0 ? 1.0f : 0.0f;
+  }
+  fill(&out_scalar[0], &out_scalar[size], 0.0f);
+  fill(&out[0], &out[size], 0.0f);
+  
+  float f[num_modes];
+  float q[num_modes];
+  float gain[num_modes];
+  for (int i = 0; i < num_modes; ++i) {
+    f[i] = min(0.003f * (i + 1) * (1.0f + 0.01f * i), 0.499f);
+    q[i] = 1.0f + f[i] * 2000.0f;
+    gain[i] = 0.25f * (1.0f - f[i] * 2.0f);
+  }
+  
+  ResonatorSvf<4> scalar[num_batches];
+  for (int b = 0; b < num_batches; ++b) {
+    scalar[b].Init();
+  }
+  ResonatorSvf<num_modes> bank;
+  bank.Init();
+  
+  clock_t start = clock();
+  for (size_t i = 0; i < size; i += kAudioBlockSize) {
+    for (int b = 0; b < num_batches; ++b) {
+      scalar[b].template ProcessScalar<FILTER_MODE_BAND_PASS, true>(
+          &f[b * 4],
+          &q[b * 4],
+          &gain[b * 4],
+          &in[i],
+          &out_scalar[i],
+          kAudioBlockSize);
+    }
+  }
+  clock_t scalar_time = clock() - start;
+  
+  start = clock();
+  for (size_t i = 0; i < size; i += kAudioBlockSize) {
+    bank.template Process<FILTER_MODE_BAND_PASS, true>(
+        f, q, gain, &in[i], &out[i], kAudioBlockSize);
+  }
+  clock_t bank_time = clock() - start;
+  
+  // The states match bit for bit; the output only differs by the order in
+  // which the modes are summed.
+  char name[64];
+  sprintf(name, "ResonatorSvf, %d modes", num_modes);
+  const bool pass = CompareWithReference(name, out, out_scalar, size, 1e-6f);
+  printf(
+      "ResonatorSvf, %d modes: speedup %.2fx\n",
+      num_modes,
+      float(scalar_time) / float(max(bank_time, clock_t(1))));
+  
+  delete[] in;
+  delete[] out_scalar;
+  delete[] out;
+  return pass;
+}
+
+// Batches that are not whole vectors must render exactly as the module
+// does, state included, from one block to the next.
+template<int num_modes>
+bool TestResonatorSvfTail() {
+  const size_t size = kSampleRate;
+  
+  float* in = new float[size];
+  float* out_reference = new float[size];
+  float* out = new float[size];
+  for (size_t i = 0; i < size; ++i) {
+    in[i] = i % 4800 == 0 ? 1.0f : 0.0f;
+  }
+  
+  float f[num_modes];
+  float q[num_modes];
+  float gain[num_modes];
+  for (int i = 0; i < num_modes; ++i) {
+    f[i] = 0.01f * (i + 1);
+    q[i] = 5.0f + 20.0f * i;
+    gain[i] = 1.0f / num_modes;
+  }
+  
+  ResonatorSvf<num_modes> filter;
+  ResonatorSvf<num_modes> reference;
+  filter.Init();
+  reference.Init();
+  for (size_t i = 0; i < size; i += kAudioBlockSize) {
+    filter.template Process<FILTER_MODE_LOW_PASS, false>(
+        f, q, gain, &in[i], &out[i], kAudioBlockSize);
+    reference.template ProcessScalar<FILTER_MODE_LOW_PASS, false>(
+        f, q, gain, &in[i], &out_reference[i], kAudioBlockSize);
+  }
+  
+  char name[64];
+  sprintf(name, "ResonatorSvf, %d modes, scalar", num_modes);
+  const bool pass = CompareWithReference(
+      name, out, out_reference, size, 0.0f);
+  
+  delete[] in;
+  delete[] out_reference;
+  delete[] out;
+  return pass;
+}
+
+bool TestResonatorSvf() {
+  bool pass = TestResonatorSvfBank<24>();
+  pass = TestResonatorSvfBank<64>() && pass;
+  
+  // Batches that are not whole vectors take the scalar code, on the host too.
+  pass = TestResonatorSvfTail<1>() && pass;
+  return TestResonatorSvfTail<6>() && pass;
+}
+
+// Compares the swarm oscillators rendered in a single pass (vectorized on
+// the host) with the reference code rendering one voice at a time.
+template<int num_voices>
+bool TestSwarmOscillatorBankSize(float tolerance) {
+  const size_t size = kSampleRate * 10;
+  
+  float* saw_scalar = new float[size];
+  float* sine_scalar = new float[size];
+  float* saw = new float[size];
+  float* sine = new float[size];
+  
+  SwarmOscillatorBank<num_voices> scalar;
+  SwarmOscillatorBank<num_voices> bank;
+  scalar.Init();
+  bank.Init();
+  
+  float frequency[num_voices];
+  float amplitude[num_voices];
+  clock_t scalar_time = 0;
+  clock_t bank_time = 0;
+  for (size_t i = 0; i < size; i += kAudioBlockSize) {
+    for (int j = 0; j < num_voices; ++j) {
+      float x = static_cast<float>(i) / kSampleRate + 0.37f * j;
+      frequency[j] = 0.002f * SemitonesToRatio(
+          48.0f * (0.5f + 0.5f * sinf(x)));
+      amplitude[j] = (0.5f + 0.5f * cosf(3.0f * x)) / num_voices;
+    }
+    clock_t start = clock();
+    scalar.RenderScalar(
+        frequency, amplitude, &saw_scalar[i], &sine_scalar[i],
+        kAudioBlockSize);
+    scalar_time += clock() - start;
+    
+    start = clock();
+    bank.Render(frequency, amplitude, &saw[i], &sine[i], kAudioBlockSize);
+    bank_time += clock() - start;
+  }
+  
+  char name[64];
+  sprintf(name, "SwarmOscillatorBank, %d voices, saw", num_voices);
+  bool pass = CompareWithReference(name, saw, saw_scalar, size, tolerance);
+  sprintf(name, "SwarmOscillatorBank, %d voices, sine", num_voices);
+  pass = CompareWithReference(name, sine, sine_scalar, size, tolerance) &&
+      pass;
+  printf(
+      "SwarmOscillatorBank, %d voices: "
+      "%.1f ns/sample (scalar %.1f), speedup %.2fx\n",
+      num_voices,
+      1e9f * float(bank_time) / CLOCKS_PER_SEC / size,
+      1e9f * float(scalar_time) / CLOCKS_PER_SEC / size,
+      float(scalar_time) / float(max(bank_time, clock_t(1))));
+  
+  delete[] saw_scalar;
+  delete[] sine_scalar;
+  delete[] saw;
+  delete[] sine;
+  return pass;
+}
+
+bool TestSwarmOscillatorBank() {
+  bool pass = TestSwarmOscillatorBankSize<8>(1e-6f);
+  pass = TestSwarmOscillatorBankSize<16>(1e-6f) && pass;
+  pass = TestSwarmOscillatorBankSize<32>(1e-6f) && pass;
+  
+  // Banks that are not whole vectors take the scalar code, on the host too.
+  return TestSwarmOscillatorBankSize<6>(0.0f) && pass;
+}
+
+bool TestBlockRandomGenerator() {
+  const size_t size = 1 << 22;
+  const int num_bins = 64;
+  
+  float* uniform = new float[size];
+  float* bipolar = new float[size];
+  float* reference = new float[size];
+  
+  // Odd block sizes, to also exercise the partially used lanes.
+  BlockRandomGenerator random;
+  random.Init(0x12345678);
+  for (size_t i = 0, n = 1; i < size; i += n, n = n % 23 + 1) {
+    random.FillUniform(&uniform[i], min(n, size - i));
+  }
+  random.Init(0x12345678);
+  for (size_t i = 0; i < size; i += kAudioBlockSize) {
+    random.FillBipolar(&bipolar[i], kAudioBlockSize);
+  }
+  
+  // Reference: the same xorshift32 lanes, one value at a time.
+  uint32_t state[kBlockRandomGeneratorNumLanes];
+  uint32_t seed = 0x12345678;
+  for (int i = 0; i < kBlockRandomGeneratorNumLanes; ++i) {
+    seed += 0x9e3779b9;
+    uint32_t z = seed;
+    z = (z ^ (z >> 16)) * 0x85ebca6b;
+    z = (z ^ (z >> 13)) * 0xc2b2ae35;
+    state[i] = z ^ (z >> 16);
+  }
+  for (size_t i = 0; i < size; ++i) {
+    uint32_t& x = state[i % kBlockRandomGeneratorNumLanes];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    reference[i] = static_cast<float>(
+        static_cast<int32_t>(x) >> 8) * (1.0f / 8388608.0f);
+  }
+  bool pass = CompareWithReference(
+      "BlockRandomGenerator", bipolar, reference, size, 0.0f);
+  
+  double sum = 0.0;
+  double sum_squares = 0.0;
+  double lag_1 = 0.0;
+  double lag_4 = 0.0;
+  float lowest = 1.0f;
+  float highest = 0.0f;
+  size_t histogram[num_bins] = { 0 };
+  for (size_t i = 0; i < size; ++i) {
+    const double u = uniform[i] - 0.5;
+    sum += u;
+    sum_squares += u * u;
+    if (i >= 1) lag_1 += u * (uniform[i - 1] - 0.5);
+    if (i >= 4) lag_4 += u * (uniform[i - 4] - 0.5);
+    lowest = min(lowest, uniform[i]);
+    highest = max(highest, uniform[i]);
+    ++histogram[static_cast<int>(uniform[i] * num_bins)];
+  }
+  const double variance = sum_squares / size;
+  double chi_square = 0.0;
+  for (int i = 0; i < num_bins; ++i) {
+    const double expected = double(size) / num_bins;
+    chi_square += (histogram[i] - expected) * (histogram[i] - expected) /
+        expected;
+  }
+  
+  double bipolar_sum = 0.0;
+  double bipolar_sum_squares = 0.0;
+  for (size_t i = 0; i < size; ++i) {
+    bipolar_sum += bipolar[i];
+    bipolar_sum_squares += bipolar[i] * bipolar[i];
+  }
+  
+  printf(
+      "Uniform: range [%.9g, %.9g], mean %.5f (0.5), variance %.5f (%.5f)\n",
+      lowest,
+      highest,
+      0.5 + sum / size,
+      variance,
+      1.0 / 12.0);
+  printf("Bipolar: mean %.5f (0), variance %.5f (%.5f)\n",
+      bipolar_sum / size,
+      bipolar_sum_squares / size,
+      1.0 / 3.0);
+  printf("Autocorrelation: lag 1 %.5f, lag 4 %.5f (|r| < %.5f)\n",
+      lag_1 / size / variance,
+      lag_4 / size / variance,
+      3.0 / sqrt(double(size)));
+  printf("Chi-square, %d bins: %.1f (%d degrees of freedom)\n",
+      num_bins,
+      chi_square,
+      num_bins - 1);
+  
+  // Bounds at about 5 standard deviations of each estimate, so that a sound
+  // generator fails them once in millions of seeds. The uniform values must
+  // also stay in [0, 1), since the engines use them as table indices.
+  const double n = double(size);
+  const double tolerance = 5.0 / sqrt(n);
+  const double degrees_of_freedom = num_bins - 1;
+  const bool statistics_pass =
+      lowest >= 0.0f && highest < 1.0f &&
+      fabs(sum / n) < tolerance * sqrt(1.0 / 12.0) &&
+      fabs(variance - 1.0 / 12.0) < tolerance / sqrt(180.0) &&
+      fabs(bipolar_sum / n) < tolerance * sqrt(1.0 / 3.0) &&
+      fabs(bipolar_sum_squares / n - 1.0 / 3.0) <
+          tolerance * sqrt(4.0 / 45.0) &&
+      fabs(lag_1 / n / variance) < tolerance &&
+      fabs(lag_4 / n / variance) < tolerance &&
+      chi_square < degrees_of_freedom + 5.0 * sqrt(2.0 * degrees_of_freedom);
+  printf("Statistics: %s\n", statistics_pass ? "PASS" : "FAIL");
+  pass = statistics_pass && pass;
+  
+  // Throughput, against one stmlib::Random call per sample.
+  clock_t start = clock();
+  for (size_t i = 0; i < size; i += kAudioBlockSize) {
+    random.FillUniform(&uniform[i], kAudioBlockSize);
+  }
+  const clock_t block_time = clock() - start;
+  start = clock();
+  for (size_t i = 0; i < size; ++i) {
+    uniform[i] = Random::GetFloat();
+  }
+  const clock_t scalar_time = clock() - start;
+  printf(
+      "%.2f ns/sample (stmlib::Random %.2f), speedup %.2fx\n",
+      1e9f * float(block_time) / CLOCKS_PER_SEC / size,
+      1e9f * float(scalar_time) / CLOCKS_PER_SEC / size,
+      float(scalar_time) / float(max(block_time, clock_t(1))));
+  
+  delete[] uniform;
+  delete[] bipolar;
+  delete[] reference;
+  return pass;
+}
+
 void TestNoiseEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_noise_engine.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   NoiseEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -394,7 +815,7 @@ void TestParticleEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_particle_engine.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   ParticleEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -415,11 +836,120 @@ void TestParticleEngine() {
   }
 }
 
+// For each word bank: cost of decoding it in one go (as done before on a bank
+// change), and with the per-block budget of the controller: number of blocks
+// before the bank is ready, and cost of the worst block.
+void TestLPCSpeechSynthWordBank() {
+  const int num_repetitions = 1000;
+  
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
+  LPCSpeechSynthWordBank word_bank;
+  word_bank.Init(word_banks_, LPC_SPEECH_SYNTH_NUM_WORD_BANKS, &allocator);
+  
+  for (int bank = 0; bank < LPC_SPEECH_SYNTH_NUM_WORD_BANKS; ++bank) {
+    clock_t start = clock();
+    for (int i = 0; i < num_repetitions; ++i) {
+      word_bank.Reset();
+      word_bank.Load(bank, kLPCSpeechSynthMaxFrames * 2);
+    }
+    clock_t full_time = clock() - start;
+    int num_frames = word_bank.num_frames();
+    
+    clock_t block_time[kLPCSpeechSynthMaxFrames];
+    fill(&block_time[0], &block_time[kLPCSpeechSynthMaxFrames], 0);
+    int num_blocks = 0;
+    for (int i = 0; i < num_repetitions; ++i) {
+      word_bank.Reset();
+      num_blocks = 0;
+      do {
+        start = clock();
+        word_bank.Load(bank, kLPCSpeechSynthFramesPerBlock);
+        block_time[num_blocks++] += clock() - start;
+      } while (!word_bank.ready());
+    }
+    clock_t worst_block_time = *max_element(
+        &block_time[0], &block_time[num_blocks]);
+    
+    const float us = 1e6f / CLOCKS_PER_SEC / num_repetitions;
+    printf(
+        "Word bank %d, %d frames: %.1f us in one go, "
+        "%d blocks (%.1f ms) of at most %.1f us\n",
+        bank,
+        num_frames,
+        float(full_time) * us,
+        num_blocks,
+        1000.0f * num_blocks * kBlockSize / kSampleRate,
+        float(worst_block_time) * us);
+  }
+}
+
+// Times every block of the speech engine while the word bank changes, with
+// the bank decoded in one go and with the per-block budget. The worst block
+// is what the module has to fit in its audio interrupt.
+void TestSpeechEngineBankChange() {
+  const int num_repetitions = 200;
+  const size_t blocks_per_bank = 100;
+  const size_t num_blocks =
+      blocks_per_bank * (LPC_SPEECH_SYNTH_NUM_WORD_BANKS + 1);
+  
+  clock_t* block_time = new clock_t[num_blocks];
+  const int frames_per_block[2] = {
+    kLPCSpeechSynthMaxFrames * 2, kLPCSpeechSynthFramesPerBlock
+  };
+  for (int budget = 0; budget < 2; ++budget) {
+    fill(&block_time[0], &block_time[num_blocks], 0);
+    for (int i = 0; i < num_repetitions; ++i) {
+      BufferAllocator allocator(ram_block, kVoiceRamSize);
+      SpeechEngine e;
+      e.Init(&allocator);
+      e.Reset();
+      e.set_lpc_frames_per_block(frames_per_block[budget]);
+      e.set_prosody_amount(0.0f);
+      e.set_speed(0.0f);
+      
+      EngineParameters p;
+      p.trigger = TRIGGER_UNPATCHED;
+      p.note = 48.0f;
+      p.timbre = 0.5f;
+      p.morph = 0.5f;
+      p.accent = 0.0f;
+      for (size_t block = 0; block < num_blocks; ++block) {
+        // Goes through the phonemes, then each word bank in turn: the
+        // quantizer rounds (harmonics * 6 - 2) * 0.275 * 5 to a level.
+        const int level = block / blocks_per_bank;
+        p.harmonics = (2.0f + level / 5.0f / 0.275f) / 6.0f;
+        float out[kAudioBlockSize];
+        float aux[kAudioBlockSize];
+        bool already_enveloped;
+        clock_t start = clock();
+        e.Render(p, out, aux, kAudioBlockSize, &already_enveloped);
+        block_time[block] += clock() - start;
+      }
+    }
+    
+    const clock_t* worst = max_element(&block_time[0], &block_time[num_blocks]);
+    clock_t total_time = 0;
+    for (size_t block = 0; block < num_blocks; ++block) {
+      total_time += block_time[block];
+    }
+    const float us = 1e6f / CLOCKS_PER_SEC / num_repetitions;
+    printf(
+        "Speech engine, %d frames per block: worst block %.1f us "
+        "(block %d, bank %d), mean %.1f us\n",
+        frames_per_block[budget],
+        float(*worst) * us,
+        int(worst - block_time),
+        int(worst - block_time) / int(blocks_per_bank) - 1,
+        float(total_time) * us / num_blocks);
+  }
+  delete[] block_time;
+}
+
 void TestSpeechEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_speech_engine.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   SpeechEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -452,7 +982,7 @@ void GenerateStringTuningData() {
     sprintf(file_name, "string_%02d.wav", pass);
     wav_writer.Open(file_name);
     
-    BufferAllocator allocator(ram_block, 16384);
+    BufferAllocator allocator(ram_block, kVoiceRamSize);
     StringEngine e;
     e.Init(&allocator);
     e.Reset();
@@ -476,7 +1006,7 @@ void GenerateStringTuningData() {
   WavWriter wav_writer(1, kSampleRate, 40);
   wav_writer.Open("string_sweep.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   StringEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -505,7 +1035,7 @@ void GenerateModalTuningData() {
     sprintf(file_name, "modal_%02d.wav", pass);
     wav_writer.Open(file_name);
     
-    BufferAllocator allocator(ram_block, 16384);
+    BufferAllocator allocator(ram_block, kVoiceRamSize);
     ModalEngine e;
     e.Init(&allocator);
     e.Reset();
@@ -532,7 +1062,7 @@ void TestStringEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_string_engine.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   StringEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -562,11 +1092,180 @@ void TestStringEngine() {
   }
 }
 
+// The delay line as it was before its indices were wrapped with a mask:
+// every tap wraps with a modulo, and the buffer holds max_delay samples.
+template<typename T, size_t max_delay>
+class ModuloDelayLine {
+ public:
+  void Init(T* buffer) {
+    line_ = buffer;
+    fill(&line_[0], &line_[max_delay], T(0));
+    write_ptr_ = 0;
+  }
+  
+  inline void Write(const T sample) {
+    line_[write_ptr_] = sample;
+    write_ptr_ = (write_ptr_ - 1 + max_delay) % max_delay;
+  }
+  
+  inline const T Allpass(const T sample, size_t delay, const T coefficient) {
+    T read = line_[(write_ptr_ + delay) % max_delay];
+    T write = sample + coefficient * read;
+    Write(write);
+    return -write * coefficient + read;
+  }
+  
+  inline const T Read(float delay) const {
+    MAKE_INTEGRAL_FRACTIONAL(delay)
+    const T a = line_[(write_ptr_ + delay_integral) % max_delay];
+    const T b = line_[(write_ptr_ + delay_integral + 1) % max_delay];
+    return a + (b - a) * T(delay_fractional);
+  }
+  
+  inline const T ReadHermite(float delay) const {
+    MAKE_INTEGRAL_FRACTIONAL(delay)
+    int32_t t = (write_ptr_ + delay_integral + max_delay);
+    const T xm1 = line_[(t - 1) % max_delay];
+    const T x0 = line_[(t) % max_delay];
+    const T x1 = line_[(t + 1) % max_delay];
+    const T x2 = line_[(t + 2) % max_delay];
+    const T c = (x1 - xm1) * 0.5f;
+    const T v = x0 - x1;
+    const T w = c + v;
+    const T a = w + v + (x2 - x0) * 0.5f;
+    const T b_neg = w + a;
+    const T f = delay_fractional;
+    return (((a * f) - b_neg) * f + c) * f + x0;
+  }
+  
+ private:
+  size_t write_ptr_;
+  T* line_;
+};
+
+// Compares DelayLine with the modulo version, reading at random delays
+// across the whole line, so that every wrapping case is covered.
+bool TestDelayLine() {
+  const size_t kLength = 1024;
+  const size_t size = kSampleRate * 10;
+  
+  float* line = new float[DelayLine<float, kLength>::kBufferSize];
+  float* modulo_line = new float[kLength];
+  DelayLine<float, kLength> delay_line;
+  ModuloDelayLine<float, kLength> modulo_delay_line;
+  delay_line.Init(line);
+  modulo_delay_line.Init(modulo_line);
+  
+  float* out = new float[size * 3];
+  float* reference = new float[size * 3];
+  float* delay = new float[size];
+  float* in = new float[size];
+  for (size_t i = 0; i < size; ++i) {
+    delay[i] = Random::GetFloat() * (kLength - 4);
+    in[i] = Random::GetFloat() * 2.0f - 1.0f;
+  }
+  
+  clock_t start = clock();
+  for (size_t i = 0; i < size; ++i) {
+    delay_line.Write(in[i]);
+    out[i] = delay_line.ReadHermite(delay[i]);
+  }
+  const clock_t time = clock() - start;
+  start = clock();
+  for (size_t i = 0; i < size; ++i) {
+    modulo_delay_line.Write(in[i]);
+    reference[i] = modulo_delay_line.ReadHermite(delay[i]);
+  }
+  const clock_t modulo_time = clock() - start;
+  
+  for (size_t i = 0; i < size; ++i) {
+    const size_t integral = static_cast<size_t>(delay[i]);
+    out[size + i] = delay_line.Read(delay[i]);
+    out[2 * size + i] = delay_line.Allpass(in[i], integral, 0.7f);
+    reference[size + i] = modulo_delay_line.Read(delay[i]);
+    reference[2 * size + i] = modulo_delay_line.Allpass(
+        in[i], integral, 0.7f);
+  }
+  
+  const bool pass = CompareWithReference(
+      "DelayLine", out, reference, size * 3, 0.0f);
+  printf(
+      "DelayLine, Write and ReadHermite: %.2f ns/sample (modulo %.2f)\n",
+      1e9f * float(time) / CLOCKS_PER_SEC / size,
+      1e9f * float(modulo_time) / CLOCKS_PER_SEC / size);
+  
+  delete[] line;
+  delete[] modulo_line;
+  delete[] out;
+  delete[] reference;
+  delete[] delay;
+  delete[] in;
+  return pass;
+}
+
+// Renders the string engine through the voice, and compares the output
+// with the rendering made before the delay line indices were masked.
+bool TestStringEngineGolden() {
+  // FNV-1a of the frames, at 24-sample blocks on an SSE2 host.
+  const uint32_t kGoldenHash = 0xf27741de;
+  
+  // The state updated once per block follows kBlockSize, and so does the
+  // rendering.
+  if (kBlockSize != kHardwareBlockSize) {
+    printf(
+        "String engine golden: skipped, built for %zu-sample blocks\n",
+        kBlockSize);
+    return true;
+  }
+  
+  // The random state the voice starts from on the module.
+  VoiceRandom::Seed(0x21);
+  
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
+  Voice* voice = new Voice;
+  voice->Init(&allocator);
+  
+  Patch patch;
+  Modulations modulations;
+  memset(&patch, 0, sizeof(patch));
+  memset(&modulations, 0, sizeof(modulations));
+  patch.engine = 11;
+  patch.decay = 0.5f;
+  patch.lpg_colour = 0.5f;
+  modulations.level = 1.0f;
+  modulations.trigger_patched = true;
+  
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < kSampleRate * 30; i += kAudioBlockSize) {
+    const float t = static_cast<float>(i) / kSampleRate;
+    patch.note = 24.0f + 60.0f * (0.5f + 0.5f * sinf(t * 0.37f));
+    patch.timbre = 0.5f + 0.5f * sinf(t * 0.91f);
+    patch.morph = 0.5f + 0.5f * sinf(t * 1.23f);
+    patch.harmonics = 0.5f + 0.5f * sinf(t * 2.11f);
+    modulations.trigger = (i % 9600) < 480 ? 1.0f : 0.0f;
+    Voice::Frame frames[kAudioBlockSize];
+    voice->Render(patch, modulations, frames, kAudioBlockSize);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(frames);
+    for (size_t j = 0; j < sizeof(frames); ++j) {
+      hash = (hash ^ bytes[j]) * 16777619u;
+    }
+  }
+  delete voice;
+  
+  const bool pass = hash == kGoldenHash;
+  printf(
+      "String engine golden: %s, hash %08x (expected %08x)\n",
+      pass ? "PASS" : "FAIL",
+      hash,
+      kGoldenHash);
+  return pass;
+}
+
 void TestSwarmEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_swarm_engine.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   SwarmEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -602,7 +1301,7 @@ void TestVirtualAnalogEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_virtual_analog_engine.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   VirtualAnalogEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -630,8 +1329,9 @@ void TestWaveshapingEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_waveshaping_engine.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   WaveshapingEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -654,8 +1354,9 @@ void TestWavetableEngine() {
   WavWriter wav_writer(2, kSampleRate, 5);
   wav_writer.Open("plaits_wavetable_engine.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   WavetableEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -680,8 +1381,9 @@ void EnumerateWavetables() {
   WavWriter wav_writer(1, kSampleRate, 64);
   wav_writer.Open("plaits_wavetable_enumeration.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   WavetableEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -737,8 +1439,9 @@ void TestBassDrumEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_bass_drum_engine.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   BassDrumEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -766,8 +1469,9 @@ void TestSnareDrumEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_snare_drum_engine.wav");
   
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   SnareDrumEngine e;
-  e.Init(NULL);
+  e.Init(&allocator);
   e.Reset();
   
   EngineParameters p;
@@ -798,7 +1502,7 @@ void TestHiHatEngine() {
   WavWriter wav_writer(2, kSampleRate, 80);
   wav_writer.Open("plaits_hi_hat_engine.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   HiHatEngine e;
   e.Init(&allocator);
   e.Reset();
@@ -828,7 +1532,7 @@ void TestVoice() {
   WavWriter wav_writer(2, kSampleRate, 200);
   wav_writer.Open("plaits_voice.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   Voice v;
   
   v.Init(&allocator);
@@ -870,11 +1574,110 @@ void TestVoice() {
   }
 }
 
+bool TestEngineCrossfade() {
+  WavWriter wav_writer(2, kSampleRate, 20);
+  wav_writer.Open("plaits_engine_crossfade.wav");
+  
+  // Sequence the model every 50ms, cycling through all the engines.
+  const size_t duration = kSampleRate * 10;
+  const size_t switch_period = 2400;
+  const size_t num_switches = duration / switch_period;
+  
+  float mean_switch_jump[2];
+  for (int crossfade = 0; crossfade < 2; ++crossfade) {
+    BufferAllocator allocator(ram_block, kVoiceRamSize);
+    Voice v;
+    v.Init(&allocator);
+    v.set_engine_crossfade(crossfade);
+    
+    Patch patch;
+    Modulations modulations;
+    patch.engine = 0;
+    patch.note = 48.0f;
+    patch.harmonics = 0.5f;
+    patch.timbre = 0.5f;
+    patch.morph = 0.5f;
+    patch.frequency_modulation_amount = 0.0f;
+    patch.timbre_modulation_amount = 0.0f;
+    patch.morph_modulation_amount = 0.0f;
+    patch.decay = 0.5f;
+    patch.lpg_colour = 0.5f;
+    
+    modulations.engine = 0.0f;
+    modulations.note = 0.0f;
+    modulations.frequency = 0.0f;
+    modulations.harmonics = 0.0f;
+    modulations.timbre = 0.0f;
+    modulations.morph = 0.0f;
+    modulations.level = 1.0f;
+    modulations.trigger = 0.0f;
+    modulations.frequency_patched = false;
+    modulations.timbre_patched = false;
+    modulations.morph_patched = false;
+    modulations.trigger_patched = false;
+    modulations.level_patched = false;
+    
+    // The jump between the last sample of an engine and the first of the
+    // next one, against the jumps everywhere else.
+    float switch_jump = 0.0f;
+    float other_jump = 0.0f;
+    size_t num_other_jumps = 0;
+    clock_t overlap_time = 0;
+    clock_t other_time = 0;
+    size_t overlap_samples = 0;
+    short previous = 0;
+    for (size_t i = 0; i < duration; i += kAudioBlockSize) {
+      patch.engine = (i / switch_period) % 16;
+      Voice::Frame frames[kAudioBlockSize];
+      clock_t start = clock();
+      v.Render(patch, modulations, frames, kAudioBlockSize);
+      clock_t elapsed = clock() - start;
+      if (i % switch_period < kEngineCrossfadeSize) {
+        overlap_time += elapsed;
+        overlap_samples += kAudioBlockSize;
+      } else {
+        other_time += elapsed;
+      }
+      for (size_t j = 0; j < kAudioBlockSize; ++j) {
+        const float jump = fabsf(float(frames[j].out - previous));
+        if (i && (i + j) % switch_period == 0) {
+          switch_jump += jump;
+        } else {
+          other_jump += jump;
+          ++num_other_jumps;
+        }
+        previous = frames[j].out;
+      }
+      if (crossfade) {
+        wav_writer.WriteFrames(&frames[0].out, kAudioBlockSize);
+      }
+    }
+    mean_switch_jump[crossfade] = switch_jump / (num_switches - 1);
+    printf(
+        "Crossfade %s: mean jump at a switch %.0f (elsewhere %.0f), "
+        "%.1f ns/sample during the overlap (elsewhere %.1f)\n",
+        crossfade ? "on" : "off",
+        mean_switch_jump[crossfade],
+        other_jump / num_other_jumps,
+        1e9f * float(overlap_time) / CLOCKS_PER_SEC / overlap_samples,
+        1e9f * float(other_time) / CLOCKS_PER_SEC /
+            (duration - overlap_samples));
+  }
+  printf(
+      "Crossfade buffers: %zu bytes\n",
+      2 * kEngineCrossfadeSize * sizeof(Voice::Frame));
+  
+  // The crossfade must at least halve the discontinuity at the switches.
+  const bool pass = mean_switch_jump[1] < 0.5f * mean_switch_jump[0];
+  printf("Crossfade: %s\n", pass ? "PASS" : "FAIL");
+  return pass;
+}
+
 void TestFMGlitch() {
   WavWriter wav_writer(2, kSampleRate, 200);
   wav_writer.Open("plaits_fm_glitch.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   Voice v;
 
   v.Init(&allocator);
@@ -920,7 +1723,7 @@ void TestLPGAttackDecay() {
   WavWriter wav_writer(2, kSampleRate, 20);
   wav_writer.Open("plaits_lpg_attack_decay.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   Voice v;
 
   v.Init(&allocator);
@@ -974,7 +1777,7 @@ void TestLimiterGlitch() {
   WavWriter wav_writer(2, kSampleRate, 50);
   wav_writer.Open("plaits_limiter_glitch.wav");
   
-  BufferAllocator allocator(ram_block, 16384);
+  BufferAllocator allocator(ram_block, kVoiceRamSize);
   Voice v;
 
   v.Init(&allocator);
@@ -1017,40 +1820,53 @@ void TestLimiterGlitch() {
 
 int main(void) {
   _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
-  // TestFormantOscillator();
-  // TestGrainletOscillator();
-  // TestOscillator();
-  // TestVariableShapeOscillator();
-  // TestStringSynthOscillator();
-  // TestStringSynthOscillator();
-  // TestVosimOscillator();
-  // TestZOscillator();
-  // TestHarmonicOscillator();
-
-  // TestAdditiveEngine();
-  // TestChordEngine();
+  TestFormantOscillator();
+  TestGrainletOscillator();
+  TestOscillator();
+  TestVariableShapeOscillator();
+  TestStringSynthOscillator();
+  TestVosimOscillator();
+  TestZOscillator();
+  TestHarmonicOscillator();
+
+  TestAdditiveEngine();
+  TestChordEngine();
   TestFMEngine();
-  // TestGrainEngine();
-  // TestModalEngine();
-  // TestStringEngine();
-  // TestNoiseEngine();
-  // TestParticleEngine();
-  // TestSpeechEngine();
-  // TestSwarmEngine();
-  // TestVirtualAnalogEngine();
-  // TestWaveshapingEngine();
-  // TestWavetableEngine();
-  // TestBassDrumEngine();
-  // TestSnareDrumEngine();
-  // TestHiHatEngine();
-  
-  // TestVariableSawOscillator();
-  
-  // TestSampleRateReducer();
-  // TestVoice();
-  // TestFMGlitch();
-  // TestLimiterGlitch();
-  // EnumerateWavetables();
-  
-  // TestLPGAttackDecay();
+  TestGrainEngine();
+  TestModalEngine();
+  TestStringEngine();
+  TestNoiseEngine();
+  TestParticleEngine();
+  TestLPCSpeechSynthWordBank();
+  TestSpeechEngineBankChange();
+  TestSpeechEngine();
+  TestSwarmEngine();
+  TestVirtualAnalogEngine();
+  TestWaveshapingEngine();
+  TestWavetableEngine();
+  TestBassDrumEngine();
+  TestSnareDrumEngine();
+  TestHiHatEngine();
+  
+  TestVariableSawOscillator();
+  
+  TestSampleRateReducer();
+  TestVoice();
+  TestFMGlitch();
+  TestLimiterGlitch();
+  EnumerateWavetables();
+  
+  TestLPGAttackDecay();
+  
+  // The checks against reference code and expected statistics.
+  int num_failures = 0;
+  num_failures += !TestHarmonicSilenceThreshold();
+  num_failures += !TestResonatorSvf();
+  num_failures += !TestSwarmOscillatorBank();
+  num_failures += !TestBlockRandomGenerator();
+  num_failures += !TestDelayLine();
+  num_failures += !TestStringEngineGolden();
+  num_failures += !TestEngineCrossfade();
+  printf("%d check(s) failed\n", num_failures);
+  return num_failures ? 1 : 0;
 }
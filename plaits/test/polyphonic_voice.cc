@@ -0,0 +1,177 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Host-side polyphonic wrapper around the Plaits voice.
+
+#include "plaits/test/polyphonic_voice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <xmmintrin.h>
+
+#include "stmlib/utils/buffer_allocator.h"
+
+#include "plaits/dsp/voice_random.h"
+
+namespace plaits {
+
+using namespace std;
+using namespace stmlib;
+
+// Cost estimates follow the engines within a few blocks, without jumping
+// around with the host scheduler.
+const float kCostSmoothing = 0.1f;
+
+void PolyphonicVoice::Init(int num_voices, int num_threads) {
+  Stop();
+  
+  num_voices_ = min(max(num_voices, 1), kMaxPolyphony);
+  num_threads_ = min(max(num_threads, 1), kMaxRenderThreads);
+  
+  slots_ = new Slot[num_voices_];
+  for (int i = 0; i < num_voices_; ++i) {
+    Slot* s = &slots_[i];
+    BufferAllocator allocator(s->ram, kVoiceRamSize);
+    s->voice.Init(&allocator);
+    s->cost = 0.0f;
+    s->random_state = 0x21 + i * 0x9e3779b9;
+    order_[i] = i;
+  }
+  
+  // Denormal handling is per thread; the workers inherit the caller's.
+  control_status_register_ = _mm_getcsr();
+  next_voice_ = 0;
+  num_pending_workers_ = 0;
+  generation_ = 0;
+  running_ = true;
+  for (int i = 1; i < num_threads_; ++i) {
+    threads_[i] = thread(&PolyphonicVoice::WorkerLoop, this);
+  }
+}
+
+void PolyphonicVoice::Stop() {
+  if (!num_voices_) {
+    return;
+  }
+  {
+    lock_guard<mutex> lock(mutex_);
+    running_ = false;
+    ++generation_;
+  }
+  start_.notify_all();
+  for (int i = 1; i < num_threads_; ++i) {
+    threads_[i].join();
+  }
+  delete[] slots_;
+  slots_ = NULL;
+  num_voices_ = 0;
+  num_threads_ = 0;
+}
+
+void PolyphonicVoice::SortByCost() {
+  // Insertion sort: the order barely changes from one block to the next.
+  for (int i = 1; i < num_voices_; ++i) {
+    int voice = order_[i];
+    float cost = slots_[voice].cost;
+    int j = i;
+    while (j > 0 && slots_[order_[j - 1]].cost < cost) {
+      order_[j] = order_[j - 1];
+      --j;
+    }
+    order_[j] = voice;
+  }
+}
+
+void PolyphonicVoice::RenderVoices() {
+  const size_t size = size_;
+  while (true) {
+    int i = next_voice_.fetch_add(1, memory_order_relaxed);
+    if (i >= num_voices_) {
+      break;
+    }
+    Slot* s = &slots_[order_[i]];
+    
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    VoiceRandom::Seed(s->random_state);
+    s->voice.Render(s->patch, s->modulations, s->frames, size);
+    s->random_state = VoiceRandom::state();
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    float ns = chrono::duration<float, nano>(end - start).count();
+    s->cost += kCostSmoothing * (ns - s->cost);
+  }
+}
+
+void PolyphonicVoice::WorkerLoop() {
+  _mm_setcsr(control_status_register_);
+  unsigned int generation = 0;
+  while (true) {
+    {
+      unique_lock<mutex> lock(mutex_);
+      start_.wait(lock, [&] { return generation_ != generation; });
+      generation = generation_;
+      if (!running_) {
+        break;
+      }
+    }
+    RenderVoices();
+    {
+      lock_guard<mutex> lock(mutex_);
+      if (--num_pending_workers_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+}
+
+void PolyphonicVoice::Render(float* out, float* aux, size_t size) {
+  SortByCost();
+  size_ = size;
+  next_voice_.store(0, memory_order_relaxed);
+  {
+    lock_guard<mutex> lock(mutex_);
+    num_pending_workers_ = num_threads_ - 1;
+    ++generation_;
+  }
+  start_.notify_all();
+  
+  RenderVoices();
+  {
+    unique_lock<mutex> lock(mutex_);
+    done_.wait(lock, [this] { return num_pending_workers_ == 0; });
+  }
+  
+  fill(&out[0], &out[size], 0.0f);
+  fill(&aux[0], &aux[size], 0.0f);
+  for (int i = 0; i < num_voices_; ++i) {
+    const Voice::Frame* frames = slots_[i].frames;
+    for (size_t j = 0; j < size; ++j) {
+      out[j] += static_cast<float>(frames[j].out) / 32768.0f;
+      aux[j] += static_cast<float>(frames[j].aux) / 32768.0f;
+    }
+  }
+}
+
+}  // namespace plaits
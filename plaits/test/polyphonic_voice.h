@@ -0,0 +1,130 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Host-side polyphonic wrapper around the Plaits voice.
+//
+// Every voice has its own Voice object and its own arena, so voices
+// share no engine state and can render concurrently. Each block, the voices
+// are sorted by their measured render cost and handed out, most expensive
+// first, to a pool of worker threads (the calling thread is one of them)
+// through a shared atomic index: an idle worker always takes over the next
+// voice, so that a worker stuck on a heavy engine does not hold up the
+// others. Once all workers are done, the calling thread sums the voices in
+// voice order, so that the mix does not depend on which voice finished
+// first or on the number of threads. Idle workers sleep on a condition variable between blocks; the lock is
+// only taken to start a block and to report its end.
+//
+// The engines draw noise from VoiceRandom, whose state is per thread on the
+// host. Each voice keeps its own state and swaps it in around its render,
+// so its noise does not depend on the thread it lands on.
+
+#ifndef PLAITS_TEST_POLYPHONIC_VOICE_H_
+#define PLAITS_TEST_POLYPHONIC_VOICE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "stmlib/stmlib.h"
+
+#include "plaits/dsp/voice.h"
+
+namespace plaits {
+
+const int kMaxPolyphony = 64;
+const int kMaxRenderThreads = 16;
+
+class PolyphonicVoice {
+ public:
+  PolyphonicVoice() : slots_(NULL), num_voices_(0), num_threads_(0) { }
+  ~PolyphonicVoice() { Stop(); }
+  
+  // Starts num_threads - 1 worker threads.
+  void Init(int num_voices, int num_threads);
+  void Stop();
+  
+  // Renders and mixes all voices, scaled to [-1, 1] per voice. size must not
+  // exceed kMaxBlockSize. The patches and modulations must not be modified
+  // while this runs.
+  void Render(float* out, float* aux, size_t size);
+  
+  inline Patch* mutable_patch(int voice) {
+    return &slots_[voice].patch;
+  }
+  
+  inline Modulations* mutable_modulations(int voice) {
+    return &slots_[voice].modulations;
+  }
+  
+  // Smoothed render time of the last blocks of a voice, in ns.
+  inline float cost(int voice) const { return slots_[voice].cost; }
+  
+  inline int num_voices() const { return num_voices_; }
+  inline int num_threads() const { return num_threads_; }
+  
+ private:
+  struct Slot {
+    Voice voice;
+    char ram[kVoiceRamSize];
+    Patch patch;
+    Modulations modulations;
+    Voice::Frame frames[kMaxBlockSize];
+    float cost;
+    uint32_t random_state;
+  };
+  
+  void SortByCost();
+  void RenderVoices();
+  void WorkerLoop();
+  
+  Slot* slots_;
+  std::thread threads_[kMaxRenderThreads];
+  
+  int num_voices_;
+  int num_threads_;
+  unsigned int control_status_register_;
+  
+  // Written by the calling thread before generation_ is incremented.
+  int order_[kMaxPolyphony];
+  size_t size_;
+  
+  std::atomic<int> next_voice_;
+  
+  // Guarded by mutex_.
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  int num_pending_workers_;
+  unsigned int generation_;
+  bool running_;
+  
+  DISALLOW_COPY_AND_ASSIGN(PolyphonicVoice);
+};
+
+}  // namespace plaits
+
+#endif  // PLAITS_TEST_POLYPHONIC_VOICE_H_
@@ -33,6 +33,7 @@
 #include "stmlib/stmlib.h"
 #include "stmlib/utils/random.h"
 
+#include "yarns/instance_state.h"
 #include "yarns/part.h"
 #include "yarns/resources.h"
 
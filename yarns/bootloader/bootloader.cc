@@ -70,7 +70,6 @@ void SysTick_Handler() {
     display.RefreshSlow();
     encoder.Debounce();
   }
-  display.RefreshFast();
   
   // Try to read some MIDI input.
   if (midi_io.readable()) {
@@ -216,6 +215,8 @@ void Init() {
   RCC_APB2PeriphClockCmd(
       RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOB | RCC_APB2Periph_GPIOC |
       RCC_APB2Periph_TIM1 | RCC_APB2Periph_USART1, ENABLE);
+  RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);
+  RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
   
   system_clock.Init();
   encoder.Init();
@@ -258,6 +259,7 @@ int main(void) {
       }
     }
   }
+  display.Stop();
   Uninitialize();
   JumpTo(kStartAddress);
   while (1) { }
@@ -28,6 +28,8 @@
 
 #include "yarns/drivers/dac.h"
 
+#include "yarns/drivers/dma_address.h"
+
 #include <algorithm>
 
 namespace yarns {
@@ -65,8 +67,68 @@ void Dac::Init() {
   SPI_Cmd(SPI2, ENABLE);
   
   fill(&value_[0], &value_[kNumChannels], 0);
-  fill(&update_[0], &update_[kNumChannels], false);
-  active_channel_ = 0;
+  for (uint8_t half = 0; half < 2; ++half) {
+    for (uint8_t frame = 0; frame < kDacBlockSize; ++frame) {
+      for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+        WriteSample(half, frame, channel, 0);
+      }
+    }
+  }
+  ss_high_ = kPinSS;
+  ss_low_ = kPinSS << 16;
+  
+  // Compare events, staggered within each 450 cycles period. The SPI clock is
+  // 18MHz, so the first word is still shifting out when the second one is
+  // loaded, and both are done long before the next period.
+  TIM_OCInitTypeDef oc_init;
+  TIM_OCStructInit(&oc_init);
+  oc_init.TIM_OCMode = TIM_OCMode_Timing;
+  oc_init.TIM_Pulse = 0;
+  TIM_OC1Init(TIM1, &oc_init);
+  oc_init.TIM_Pulse = 16;
+  TIM_OC2Init(TIM1, &oc_init);
+  oc_init.TIM_Pulse = 32;
+  TIM_OC3Init(TIM1, &oc_init);
+  oc_init.TIM_Pulse = 48;
+  TIM_OC4Init(TIM1, &oc_init);
+  
+  DMA_InitTypeDef dma_init;
+  dma_init.DMA_DIR = DMA_DIR_PeripheralDST;
+  dma_init.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  dma_init.DMA_Mode = DMA_Mode_Circular;
+  dma_init.DMA_Priority = DMA_Priority_VeryHigh;
+  dma_init.DMA_M2M = DMA_M2M_Disable;
+  
+  // TIM1_CH1 -> DMA1_Channel2 and TIM1_CH2 -> DMA1_Channel3: SS pulse.
+  dma_init.DMA_BufferSize = 1;
+  dma_init.DMA_MemoryInc = DMA_MemoryInc_Disable;
+  dma_init.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+  dma_init.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+  dma_init.DMA_PeripheralBaseAddr = DmaAddress(&GPIOB->BSRR);
+  dma_init.DMA_MemoryBaseAddr = DmaAddress(&ss_high_);
+  DMA_Init(DMA1_Channel2, &dma_init);
+  dma_init.DMA_MemoryBaseAddr = DmaAddress(&ss_low_);
+  DMA_Init(DMA1_Channel3, &dma_init);
+  
+  // TIM1_CH3 -> DMA1_Channel6 and TIM1_CH4 -> DMA1_Channel4: DAC word.
+  dma_init.DMA_BufferSize = kDacBufferSize;
+  dma_init.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  dma_init.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+  dma_init.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+  dma_init.DMA_PeripheralBaseAddr = DmaAddress(&SPI2->DR);
+  dma_init.DMA_MemoryBaseAddr = DmaAddress(&command_[0]);
+  DMA_Init(DMA1_Channel6, &dma_init);
+  dma_init.DMA_MemoryBaseAddr = DmaAddress(&data_[0]);
+  DMA_Init(DMA1_Channel4, &dma_init);
+  
+  // The data word is the last transfer of each slot, so its channel tells
+  // when a half of the buffers is free.
+  DMA_ITConfig(DMA1_Channel4, DMA_IT_HT | DMA_IT_TC, ENABLE);
+  
+  DMA_Cmd(DMA1_Channel2, ENABLE);
+  DMA_Cmd(DMA1_Channel3, ENABLE);
+  DMA_Cmd(DMA1_Channel4, ENABLE);
+  DMA_Cmd(DMA1_Channel6, ENABLE);
 }
 
 }  // namespace yarns
@@ -37,6 +37,17 @@ namespace yarns {
 
 const uint8_t kNumChannels = 4;
 
+// Frames (one sample for each channel) in each half of the DMA buffers. A
+// half lasts 100us at 40kHz, so a CV value written from SysTick reaches the
+// DAC at most 200us later - still ahead of the gate, which follows 250us after.
+const size_t kDacBlockSize = 4;
+const size_t kDacBufferSize = 2 * kDacBlockSize * kNumChannels;
+
+// TIM1 keeps running at 4x 40kHz, but instead of interrupting it paces four
+// DMA channels, one for each of its compare events: SS high, SS low, then the
+// two halves of the DAC word written to SPI2. The command and data words for
+// each channel are interleaved in frames, and the buffers are refilled one
+// half at a time from the half-transfer/transfer-complete interrupt.
 class Dac {
  public:
   Dac() { }
@@ -45,10 +56,7 @@ class Dac {
   void Init();
   
   inline void set_channel(uint8_t channel, uint16_t value) {
-    if (value_[channel] != value) {
-      value_[channel] = value;
-      update_[channel] = true;
-    }
+    value_[channel] = value;
   }
   
   inline void Write(const uint16_t* values) {
@@ -58,33 +66,37 @@ class Dac {
     set_channel(3, values[3]);
   }
   
-  inline void Cycle() {
-    active_channel_ = (active_channel_ + 1) % kNumChannels;
-  }
+  inline uint16_t value(uint8_t channel) const { return value_[channel]; }
   
-  inline void Write() {
-    if (update_[active_channel_]) {
-      Write(value_[active_channel_]);
-      update_[active_channel_] = false;
+  // Acknowledges the DMA interrupt and returns the half of the buffers that
+  // has just been sent, and can be refilled.
+  inline uint8_t AcknowledgeTransfer() {
+    if (DMA_GetITStatus(DMA1_IT_HT4) != RESET) {
+      DMA_ClearITPendingBit(DMA1_IT_HT4);
+      return 0;
     }
+    DMA_ClearITPendingBit(DMA1_IT_TC4);
+    return 1;
   }
   
-  inline void Write(uint16_t value) {
-    GPIOB->BSRR = GPIO_Pin_12;
-    GPIOB->BRR = GPIO_Pin_12;
-    uint16_t word = value;
-    uint16_t dac_channel = kNumChannels - 1 - active_channel_;
-    SPI_I2S_SendData(SPI2, 0x1000 | (dac_channel << 9) | (word >> 8));
-    SPI_I2S_SendData(SPI2, word << 8);
+  inline void WriteSample(
+      uint8_t half,
+      uint8_t frame,
+      uint8_t channel,
+      uint16_t value) {
+    uint8_t slot = (half * kDacBlockSize + frame) * kNumChannels + channel;
+    uint16_t dac_channel = kNumChannels - 1 - channel;
+    command_[slot] = 0x1000 | (dac_channel << 9) | (value >> 8);
+    data_[slot] = value << 8;
   }
-  
-  inline uint8_t channel() { return active_channel_; }
  
  private:
-  bool update_[kNumChannels];
   uint16_t value_[kNumChannels];
   
-  uint8_t active_channel_;
+  uint16_t command_[kDacBufferSize];
+  uint16_t data_[kDacBufferSize];
+  uint32_t ss_high_;
+  uint32_t ss_low_;
   
   DISALLOW_COPY_AND_ASSIGN(Dac);
 };
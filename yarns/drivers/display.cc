@@ -32,6 +32,7 @@
 #include <stm32f10x_conf.h>
 #include <string.h>
 
+#include "yarns/drivers/dma_address.h"
 #include "yarns/resources.h"
 
 namespace yarns {
@@ -44,9 +45,8 @@ const uint16_t kScrollingDelay = 180;
 const uint16_t kScrollingPreDelay = 600;
 const uint16_t kBlinkMask = 128;
 
-// PWM >6 bits causes visible flickering due to over-long PWM cycle at 8kHz
-const uint8_t kDisplayBrightnessPWMBits = 6;
-const uint8_t kDisplayBrightnessPWMMax = 1 << kDisplayBrightnessPWMBits;
+// A PWM step lasts 1/64000s, so each position is refreshed at 500Hz.
+const uint32_t kDisplayStepRate = 64000;
 
 const uint16_t kCharacterEnablePins[] = {
   GPIO_Pin_6,
@@ -66,8 +66,6 @@ void Display::Init() {
   GPIO_Init(GPIOB, &gpio_init);
 
   GPIOB->BSRR = kPinEnable;
-  active_position_ = 0;
-  brightness_pwm_cycle_ = 0;
   memset(short_buffer_, ' ', kDisplayWidth);
   memset(long_buffer_, ' ', kScrollBufferSize);
   use_mask_ = false;
@@ -76,6 +74,47 @@ void Display::Init() {
   
   blinking_ = false;
   brightness_ = UINT16_MAX;
+  
+  std::fill(&segments_[0], &segments_[kDisplayWidth], 0);
+  lit_width_ = 0;
+  BuildFrame();
+  
+  TIM_TimeBaseInitTypeDef timer_init;
+  timer_init.TIM_Period = F_CPU / kDisplayStepRate - 1;
+  timer_init.TIM_Prescaler = 0;
+  timer_init.TIM_ClockDivision = TIM_CKD_DIV1;
+  timer_init.TIM_CounterMode = TIM_CounterMode_Up;
+  timer_init.TIM_RepetitionCounter = 0;
+  TIM_InternalClockConfig(TIM4);
+  TIM_TimeBaseInit(TIM4, &timer_init);
+  
+  // TIM4_UP -> DMA1_Channel7. The channel may still be streaming, from the
+  // bootloader for instance, and its addresses and count cannot be changed
+  // while it is enabled.
+  DMA_DeInit(DMA1_Channel7);
+  DMA_InitTypeDef dma_init;
+  dma_init.DMA_PeripheralBaseAddr = DmaAddress(&GPIOB->BSRR);
+  dma_init.DMA_MemoryBaseAddr = DmaAddress(&frame_[0]);
+  dma_init.DMA_DIR = DMA_DIR_PeripheralDST;
+  dma_init.DMA_BufferSize = kDisplayFrameSize;
+  dma_init.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  dma_init.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  dma_init.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+  dma_init.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+  dma_init.DMA_Mode = DMA_Mode_Circular;
+  dma_init.DMA_Priority = DMA_Priority_Low;
+  dma_init.DMA_M2M = DMA_M2M_Disable;
+  DMA_Init(DMA1_Channel7, &dma_init);
+  DMA_Cmd(DMA1_Channel7, ENABLE);
+  
+  TIM_DMACmd(TIM4, TIM_DMA_Update, ENABLE);
+  TIM_Cmd(TIM4, ENABLE);
+}
+
+void Display::Stop() {
+  TIM_Cmd(TIM4, DISABLE);
+  TIM_DMACmd(TIM4, TIM_DMA_Update, DISABLE);
+  DMA_Cmd(DMA1_Channel7, DISABLE);
 }
 
 void Display::Scroll() {
@@ -125,7 +164,6 @@ void Display::RefreshSlow() {
     actual_brightness_ = brightness_;
   }
   blink_counter_ = (blink_counter_ + 1) % (kBlinkMask << 1);
-  std::fill(&redraw_[0], &redraw_[kDisplayWidth], true); // Force redraw
 
 #else
 
@@ -135,37 +173,108 @@ void Display::RefreshSlow() {
 #endif  // APPLICATION
   // Pre-scale for PWM comparator
   actual_brightness_ = actual_brightness_ >> (16 - kDisplayBrightnessPWMBits);
+  
+  uint16_t segments[kDisplayWidth];
+  for (uint8_t i = 0; i < kDisplayWidth; ++i) {
+    segments[i] = use_mask_
+        ? mask_[i]
+        : chr_characters[static_cast<uint8_t>(displayed_buffer_[i])];
+  }
+  uint16_t lit_width = (!blinking_ || blink_counter_ < kBlinkMask)
+      ? actual_brightness_ + 1
+      : 0;
+  
+  // Only the words that differ are rewritten: a brightness change moves the
+  // steps that enable and disable each position, and new segments change
+  // the steps that shift them out, in the window before their position's.
+  if (lit_width != lit_width_) {
+    uint16_t previous_lit_width = lit_width_;
+    lit_width_ = lit_width;
+    for (uint8_t position = 0; position < kDisplayWidth; ++position) {
+      UpdateFrameWord(position, 0);
+      UpdateFrameWord(position, previous_lit_width);
+      UpdateFrameWord(position, lit_width_);
+    }
+  }
+  for (uint8_t i = 0; i < kDisplayWidth; ++i) {
+    if (segments[i] == segments_[i]) {
+      continue;
+    }
+    segments_[i] = segments[i];
+    uint8_t position = (i + kDisplayWidth - 1) % kDisplayWidth;
+    for (uint16_t step = 1; step <= 32; ++step) {
+      UpdateFrameWord(position, step);
+    }
+  }
 }
 
-void Display::RefreshFast() {
-  if (brightness_pwm_cycle_ == 0) {
-    // On rising edge, switch to next display position and draw it
-    GPIOB->BRR = kCharacterEnablePins[active_position_];
-    active_position_ = (active_position_ + 1) % kDisplayWidth;
-    redraw_[active_position_] = true;
-  } else if (brightness_pwm_cycle_ - 1 == actual_brightness_) {
-    // On falling edge, undraw current display position
-    redraw_[active_position_] = true;
+uint32_t Display::FrameWord(uint16_t slot) const {
+  uint8_t position = slot >> kDisplayBrightnessPWMBits;
+  uint16_t step = slot & (kDisplayBrightnessPWMMax - 1);
+  uint16_t set = 0;
+  uint16_t reset = 0;
+  
+  // PWM: enable this position for the first lit_width_ steps of its window.
+  if (step == 0) {
+    // The data in the shift register is transferred to the storage register
+    // on a LOW-to-HIGH transition of the STCP input.
+    set |= kPinEnable;
+    reset |= kCharacterEnablePins[(position + kDisplayWidth - 1) % kDisplayWidth];
+    if (lit_width_) {
+      set |= kCharacterEnablePins[position];
+    }
+  } else if (step == lit_width_) {
+    reset |= kCharacterEnablePins[position];
+  }
+  
+  // Meanwhile, shift out the next position, LSB first. Data is shifted on
+  // the LOW-to-HIGH transitions of the SHCP input.
+  if (step == 1) {
+    reset |= kPinEnable;
   }
-  if (redraw_[active_position_]) {
-    redraw_[active_position_] = false;
-    if (brightness_pwm_cycle_ <= actual_brightness_
-        && (!blinking_ || blink_counter_ < kBlinkMask)) {
-      if (use_mask_) {
-        Shift14SegmentsWord(mask_[active_position_]);
+  if (step >= 1 && step <= 32) {
+    uint8_t bit = (step - 1) >> 1;
+    if (step & 1) {
+      uint16_t data = segments_[(position + 1) % kDisplayWidth];
+      reset |= kPinClk;
+      if ((data >> bit) & 1) {
+        set |= kPinData;
       } else {
-        Shift14SegmentsWord(chr_characters[
-          static_cast<uint8_t>(displayed_buffer_[active_position_])]);
+        reset |= kPinData;
       }
-      GPIOB->BSRR = kCharacterEnablePins[active_position_];
     } else {
-      GPIOB->BRR = kCharacterEnablePins[active_position_];
+      set |= kPinClk;
     }
   }
-  brightness_pwm_cycle_ = (brightness_pwm_cycle_ + 1) % kDisplayBrightnessPWMMax;
+  return static_cast<uint32_t>(reset) << 16 | set;
+}
+
+void Display::UpdateFrameWord(uint8_t position, uint16_t step) {
+  if (step < kDisplayBrightnessPWMMax) {
+    uint16_t slot = (position << kDisplayBrightnessPWMBits) | step;
+    frame_[slot] = FrameWord(slot);
+  }
+}
+
+void Display::BuildFrame() {
+  // Each word is written in one go, so the DMA never reads a half-built word.
+  // At worst, one position shows a mix of the old and new segments for a
+  // single 1ms window.
+  for (uint16_t slot = 0; slot < kDisplayFrameSize; ++slot) {
+    frame_[slot] = FrameWord(slot);
+  }
 }
 
 void Display::Print(const char* short_buffer, const char* long_buffer) {
+  if (!use_mask_ &&
+      !strncmp(short_buffer_, short_buffer, kDisplayWidth)
+#ifdef APPLICATION
+      && !strncmp(long_buffer_, long_buffer, kScrollBufferSize)
+#endif  // APPLICATION
+  ) {
+    // Nothing to redraw, and a scroll in progress carries on
+    return;
+  }
   strncpy(short_buffer_, short_buffer, kDisplayWidth);
 
 #ifdef APPLICATION
@@ -177,37 +286,4 @@ void Display::Print(const char* short_buffer, const char* long_buffer) {
   use_mask_ = false;
 }
 
-# define SHIFT_BIT \
-  GPIOB->BRR = kPinClk; \
-  if (data & 1) { \
-    GPIOB->BSRR = kPinData; \
-  } else { \
-    GPIOB->BRR = kPinData; \
-  } \
-  data >>= 1; \
-  /* Data is shifted on the LOW-to-HIGH transitions of the SHCP input. */ \
-  GPIOB->BSRR = kPinClk;
-
-void Display::Shift14SegmentsWord(uint16_t data) {
-  GPIOB->BRR = kPinEnable;
-  for (int i = 0; i < 2; ++i) {
-#ifdef APPLICATION
-    SHIFT_BIT
-    SHIFT_BIT
-    SHIFT_BIT
-    SHIFT_BIT
-    SHIFT_BIT
-    SHIFT_BIT
-    SHIFT_BIT
-    SHIFT_BIT
-#else
-    for (int j = 0; j < 8; ++j) {
-      SHIFT_BIT
-    }
-#endif  // APPLICATION
-  }
-  // The data in the shift register is transferred to the storage register on a LOW-to-HIGH transition of the STCP input.
-  GPIOB->BSRR = kPinEnable;
-}
-
 }  // namespace yarns
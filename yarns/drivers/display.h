@@ -37,14 +37,27 @@ namespace yarns {
 
 const uint8_t kDisplayWidth = 2;
 const uint8_t kScrollBufferSize = 32;
+
+// PWM >6 bits causes visible flickering due to over-long PWM cycle
+const uint8_t kDisplayBrightnessPWMBits = 6;
+const uint8_t kDisplayBrightnessPWMMax = 1 << kDisplayBrightnessPWMBits;
+
+// One GPIOB->BSRR word per PWM step, for each position.
+const uint16_t kDisplayFrameSize = kDisplayWidth * kDisplayBrightnessPWMMax;
+
+// The display is refreshed by DMA, paced by TIM4, from a frame of GPIO
+// writes. Each position's PWM window also shifts out the segments of the
+// next position, which get latched when that position is enabled.
 class Display {
  public:
   Display() { }
   ~Display() { }
   
   void Init();
+  // Stops the DMA stream, which would otherwise keep writing to GPIOB from a
+  // frame that is no longer there once another program has started.
+  void Stop();
   void RefreshSlow();
-  void RefreshFast();
   
   inline void Print(const char* string) {
     Print(string, string);
@@ -67,7 +80,9 @@ class Display {
   }
  
  private:
-  void Shift14SegmentsWord(uint16_t data);
+  void BuildFrame();
+  void UpdateFrameWord(uint8_t position, uint16_t step);
+  uint32_t FrameWord(uint16_t slot) const;
 
   char short_buffer_[kDisplayWidth];
   char long_buffer_[kScrollBufferSize];
@@ -86,12 +101,15 @@ class Display {
   uint16_t fading_increment_;
   uint8_t scrolling_step_;
   
-  uint16_t active_position_;
-  uint16_t brightness_pwm_cycle_;
   uint16_t brightness_;
-  bool redraw_[kDisplayWidth];
   uint16_t blink_counter_;
   
+  // What the frame currently shows.
+  uint16_t segments_[kDisplayWidth];
+  uint16_t lit_width_;
+  
+  uint32_t frame_[kDisplayFrameSize];
+  
   DISALLOW_COPY_AND_ASSIGN(Display);
 };
 
@@ -0,0 +1,50 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Addresses of registers and buffers, as the DMA controller takes them.
+
+#ifndef YARNS_DRIVERS_DMA_ADDRESS_H_
+#define YARNS_DRIVERS_DMA_ADDRESS_H_
+
+#include "stmlib/stmlib.h"
+
+#include <stm32f10x_conf.h>
+
+namespace yarns {
+
+// Pointers are 32 bits wide on the target. The host build gets a bus address
+// from the peripheral mock instead, since a host pointer need not fit.
+inline uint32_t DmaAddress(const volatile void* pointer) {
+#ifdef TEST
+  return MockDmaAddress(pointer);
+#else
+  return reinterpret_cast<uintptr_t>(pointer);
+#endif  // TEST
+}
+
+}  // namespace yarns
+
+#endif  // YARNS_DRIVERS_DMA_ADDRESS_H_
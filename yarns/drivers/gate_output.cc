@@ -32,19 +32,103 @@
 
 namespace yarns {
 
+const uint16_t kPins[kNumGateOutputs] = {
+  GPIO_Pin_10, GPIO_Pin_11, GPIO_Pin_0, GPIO_Pin_1
+};
+
+const uint16_t kCompareInterrupts[kNumGateOutputs] = {
+  TIM_IT_CC1, TIM_IT_CC2, TIM_IT_CC3, TIM_IT_CC4
+};
+
 void GateOutput::Init() {
   GPIO_InitTypeDef gpio_init;
   gpio_init.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_10 | GPIO_Pin_11;
   gpio_init.GPIO_Speed = GPIO_Speed_50MHz;
   gpio_init.GPIO_Mode = GPIO_Mode_Out_PP;
   GPIO_Init(GPIOB, &gpio_init);
+
+  // TIM2 counts microseconds and wraps around; one compare channel per gate
+  TIM_TimeBaseInitTypeDef timer_init;
+  timer_init.TIM_Period = 0xffff;
+  timer_init.TIM_Prescaler = F_CPU / 1000000 - 1;
+  timer_init.TIM_ClockDivision = TIM_CKD_DIV1;
+  timer_init.TIM_CounterMode = TIM_CounterMode_Up;
+  timer_init.TIM_RepetitionCounter = 0;
+  TIM_TimeBaseInit(TIM2, &timer_init);
+
+  TIM_OCInitTypeDef oc_init;
+  TIM_OCStructInit(&oc_init);
+  oc_init.TIM_OCMode = TIM_OCMode_Timing;
+  oc_init.TIM_Pulse = 0;
+  TIM_OC1Init(TIM2, &oc_init);
+  TIM_OC2Init(TIM2, &oc_init);
+  TIM_OC3Init(TIM2, &oc_init);
+  TIM_OC4Init(TIM2, &oc_init);
+
+  for (uint8_t i = 0; i < kNumGateOutputs; ++i) {
+    armed_[i] = false;
+    armed_level_[i] = false;
+  }
+  TIM_Cmd(TIM2, ENABLE);
+}
+
+volatile uint16_t* GateOutput::mutable_counter() {
+  return &TIM2->CNT;
 }
 
 void GateOutput::Write(const bool* gate) {
-  GPIO_WriteBit(GPIOB, GPIO_Pin_10, static_cast<BitAction>(gate[0]));
-  GPIO_WriteBit(GPIOB, GPIO_Pin_11, static_cast<BitAction>(gate[1]));
-  GPIO_WriteBit(GPIOB, GPIO_Pin_0, static_cast<BitAction>(gate[2]));
-  GPIO_WriteBit(GPIOB, GPIO_Pin_1, static_cast<BitAction>(gate[3]));
+  for (uint8_t i = 0; i < kNumGateOutputs; ++i) {
+    WriteChannel(i, gate[i]);
+  }
+}
+
+void GateOutput::WriteChannel(uint8_t channel, bool level) {
+  GPIO_WriteBit(GPIOB, kPins[channel], static_cast<BitAction>(level));
+}
+
+void GateOutput::Arm(uint8_t channel, const GateEdge& edge) {
+  if (static_cast<int16_t>(edge.time - TIM2->CNT) <= 0) {
+    WriteChannel(channel, edge.level);
+    return;
+  }
+  armed_level_[channel] = edge.level;
+  armed_[channel] = true;
+  TIM_ClearITPendingBit(TIM2, kCompareInterrupts[channel]);
+  switch (channel) {
+    case 0: TIM_SetCompare1(TIM2, edge.time); break;
+    case 1: TIM_SetCompare2(TIM2, edge.time); break;
+    case 2: TIM_SetCompare3(TIM2, edge.time); break;
+    case 3: TIM_SetCompare4(TIM2, edge.time); break;
+  }
+  TIM_ITConfig(TIM2, kCompareInterrupts[channel], ENABLE);
+  
+  // If a higher priority interrupt held us until the counter went past the
+  // compare value, the match will not happen before the counter wraps.
+  if (armed_[channel] && static_cast<int16_t>(edge.time - TIM2->CNT) < 0) {
+    TIM_ITConfig(TIM2, kCompareInterrupts[channel], DISABLE);
+    WriteChannel(channel, edge.level);
+    armed_[channel] = false;
+  }
+}
+
+void GateOutput::Schedule(GateScheduler* scheduler) {
+  for (uint8_t i = 0; i < kNumGateOutputs; ++i) {
+    GateEdge edge;
+    while (!armed_[i] && scheduler->Pop(i, &edge)) {
+      Arm(i, edge);
+    }
+  }
+}
+
+void GateOutput::OnCompare() {
+  for (uint8_t i = 0; i < kNumGateOutputs; ++i) {
+    if (armed_[i] && TIM_GetITStatus(TIM2, kCompareInterrupts[i]) != RESET) {
+      TIM_ITConfig(TIM2, kCompareInterrupts[i], DISABLE);
+      TIM_ClearITPendingBit(TIM2, kCompareInterrupts[i]);
+      WriteChannel(i, armed_level_[i]);
+      armed_[i] = false;
+    }
+  }
 }
 
 }  // namespace yarns
@@ -31,6 +31,8 @@
 
 #include "stmlib/stmlib.h"
 
+#include "yarns/gate_scheduler.h"
+
 namespace yarns {
 
 class GateOutput {
@@ -40,8 +42,27 @@ class GateOutput {
   
   void Init();
   void Write(const bool* channel);
+
+  // Free-running 1 MHz counter used to timestamp gate edges
+  volatile uint16_t* mutable_counter();
+
+  // Sets the channel to the edge's level when the counter reaches its time,
+  // or right away if that time has passed
+  void Arm(uint8_t channel, const GateEdge& edge);
+  inline bool armed(uint8_t channel) const { return armed_[channel]; }
+
+  // Outputs every pending edge that is already due, and arms the next one
+  void Schedule(GateScheduler* scheduler);
+
+  // From the timer interrupt
+  void OnCompare();
   
  private:
+  void WriteChannel(uint8_t channel, bool level);
+
+  volatile bool armed_[kNumGateOutputs];
+  bool armed_level_[kNumGateOutputs];
+
   DISALLOW_COPY_AND_ASSIGN(GateOutput);
 };
 
@@ -40,7 +40,9 @@ void System::Init() {
   RCC_APB2PeriphClockCmd(
       RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOB | RCC_APB2Periph_GPIOC |
       RCC_APB2Periph_TIM1 | RCC_APB2Periph_USART1, ENABLE);
-  RCC_APB1PeriphClockCmd(RCC_APB1Periph_SPI2, ENABLE);
+  RCC_APB1PeriphClockCmd(
+      RCC_APB1Periph_SPI2 | RCC_APB1Periph_TIM2 | RCC_APB1Periph_TIM4, ENABLE);
+  RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
 
   TIM_TimeBaseInitTypeDef timer_init;
   timer_init.TIM_Period = F_CPU / (40000 * 4) - 1;
@@ -54,17 +56,26 @@ void System::Init() {
     
   NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);  // 2.2 priority split.
     
-  // DAC interrupt is given highest priority
-  NVIC_InitTypeDef timer_interrupt;
-  timer_interrupt.NVIC_IRQChannel = TIM1_UP_IRQn;
-  timer_interrupt.NVIC_IRQChannelPreemptionPriority = 0;
-  timer_interrupt.NVIC_IRQChannelSubPriority = 0;
-  timer_interrupt.NVIC_IRQChannelCmd = ENABLE;
-  NVIC_Init(&timer_interrupt);
+  // DAC buffer refill interrupt is given highest priority
+  NVIC_InitTypeDef dma_interrupt;
+  dma_interrupt.NVIC_IRQChannel = DMA1_Channel4_IRQn;
+  dma_interrupt.NVIC_IRQChannelPreemptionPriority = 0;
+  dma_interrupt.NVIC_IRQChannelSubPriority = 0;
+  dma_interrupt.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&dma_interrupt);
+
+  // Gate edge compares preempt the SysTick that schedules them
+  NVIC_InitTypeDef gate_interrupt;
+  gate_interrupt.NVIC_IRQChannel = TIM2_IRQn;
+  gate_interrupt.NVIC_IRQChannelPreemptionPriority = 1;
+  gate_interrupt.NVIC_IRQChannelSubPriority = 0;
+  gate_interrupt.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&gate_interrupt);
 }
 
 void System::StartTimers() {
-  TIM_ITConfig(TIM1, TIM_IT_Update, ENABLE);  
+  TIM_DMACmd(
+      TIM1, TIM_DMA_CC1 | TIM_DMA_CC2 | TIM_DMA_CC3 | TIM_DMA_CC4, ENABLE);
   SysTick_Config(F_CPU / 8000);
 }
 
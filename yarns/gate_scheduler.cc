@@ -0,0 +1,50 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Gate edge scheduler.
+
+#include "yarns/gate_scheduler.h"
+
+#include <algorithm>
+
+namespace yarns {
+
+// Stands in for the timer until the firmware hands one over
+static volatile uint16_t null_counter = 0;
+
+void GateScheduler::Init(volatile uint16_t* counter) {
+  counter_ = counter ? counter : &null_counter;
+  std::fill(&level_[0], &level_[kNumGateOutputs], false);
+  for (uint8_t i = 0; i < kNumGateOutputs; ++i) {
+    queue_[i].read_ptr = 0;
+    queue_[i].size = 0;
+  }
+}
+
+/* extern */
+INSTANCE_STATE GateScheduler gate_scheduler;
+
+}  // namespace yarns
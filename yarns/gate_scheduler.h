@@ -0,0 +1,111 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Gate edge scheduler.
+
+#ifndef YARNS_GATE_SCHEDULER_H_
+#define YARNS_GATE_SCHEDULER_H_
+
+#include "stmlib/stmlib.h"
+
+#include "yarns/instance_state.h"
+
+namespace yarns {
+
+const uint8_t kNumGateOutputs = 4;
+const uint8_t kGateQueueSize = 4;
+
+// Delay from the source of an edge to the gate output, in microseconds. It
+// covers the wait for the next 4 kHz refresh (250 us) and the DAC's DMA double
+// buffer (200 us), so a gate never opens before its CV has been output.
+const uint16_t kGateLatency = 500;
+
+struct GateEdge {
+  uint16_t time;
+  bool level;
+};
+
+// Gate changes are timestamped where they happen (note on/off), against a
+// free-running 1 MHz counter. The 4 kHz refresh submits the gate levels with
+// these timestamps, and the edges come out a constant kGateLatency later, from
+// a timer compare -- instead of on the next refresh after the event.
+class GateScheduler {
+ public:
+  GateScheduler() { }
+  ~GateScheduler() { }
+
+  void Init(volatile uint16_t* counter);
+
+  inline uint16_t now() const { return *counter_; }
+
+  // Refresh side: queues an edge if the level differs from the last one
+  void Submit(uint8_t channel, bool level, uint16_t source_time) {
+    if (level == level_[channel]) {
+      return;
+    }
+    level_[channel] = level;
+    Queue& q = queue_[channel];
+    // A full queue means edges come faster than they can be output; the
+    // newest level replaces the most recent pending one
+    uint8_t w = q.size < kGateQueueSize ? q.size++ : q.size - 1;
+    uint8_t slot = (q.read_ptr + w) & (kGateQueueSize - 1);
+    q.edge[slot].time = source_time + kGateLatency;
+    q.edge[slot].level = level;
+  }
+
+  // Refresh side: oldest pending edge of a channel
+  bool Pop(uint8_t channel, GateEdge* edge) {
+    Queue& q = queue_[channel];
+    if (!q.size) {
+      return false;
+    }
+    *edge = q.edge[q.read_ptr];
+    q.read_ptr = (q.read_ptr + 1) & (kGateQueueSize - 1);
+    --q.size;
+    return true;
+  }
+
+ private:
+  STATIC_ASSERT((kGateQueueSize & (kGateQueueSize - 1)) == 0, power_of_two);
+
+  struct Queue {
+    GateEdge edge[kGateQueueSize];
+    uint8_t read_ptr;
+    uint8_t size;
+  };
+
+  volatile uint16_t* counter_;
+  bool level_[kNumGateOutputs];
+  Queue queue_[kNumGateOutputs];
+
+  DISALLOW_COPY_AND_ASSIGN(GateScheduler);
+};
+
+extern INSTANCE_STATE GateScheduler gate_scheduler;
+
+}  // namespace yarns
+
+#endif // YARNS_GATE_SCHEDULER_H_
@@ -0,0 +1,143 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Throughput of the host engine, in instances per core. Each thread runs its
+// engines, in turn, through the same minute of MIDI; the outputs of all the
+// instances have to match, as they would not if engines shared any state.
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "yarns/host/engine.h"
+
+const uint32_t kDuration = 60;  // Seconds
+const uint32_t kNumTicks = kDuration * LOOM_TICK_RATE;
+const uint32_t kBlockSize = 64;  // Ticks per call
+
+const uint32_t kEnginesPerThread = 2;
+
+inline double Seconds(clockid_t clock) {
+  timespec t;
+  clock_gettime(clock, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Enveloped oscillator, a note every 125 ms and a pitch bend every 10 ms
+void PushMidi(LoomEngine* engine, uint32_t tick) {
+  if (tick == 0) {
+    const uint8_t oscillator_mode[] = { 0xb0, 70, 127 };
+    loom_engine_push_midi(engine, tick, oscillator_mode, 3);
+  }
+  uint8_t note = 48 + (tick / 500 * 7) % 24;
+  if (tick % 500 == 0) {
+    const uint8_t note_on[] = { 0x90, note, 100 };
+    loom_engine_push_midi(engine, tick, note_on, 3);
+  } else if (tick % 500 == 400) {
+    const uint8_t note_off[] = { 0x80, note, 0 };
+    loom_engine_push_midi(engine, tick, note_off, 3);
+  }
+  if (tick % 40 == 0) {
+    uint16_t bend = (tick / 40 * 97) % 16384;
+    const uint8_t pitch_bend[] = {
+      0xe0, static_cast<uint8_t>(bend & 0x7f), static_cast<uint8_t>(bend >> 7)
+    };
+    loom_engine_push_midi(engine, tick, pitch_bend, 3);
+  }
+}
+
+void RunInstances(uint64_t* hashes) {
+  LoomEngine* engines[kEnginesPerThread];
+  for (uint32_t i = 0; i < kEnginesPerThread; ++i) {
+    engines[i] = loom_engine_create();
+    hashes[i] = 14695981039346656037ULL;  // FNV-1a
+  }
+  LoomTickOutput output[kBlockSize];
+  for (uint32_t tick = 0; tick < kNumTicks; tick += kBlockSize) {
+    for (uint32_t e = 0; e < kEnginesPerThread; ++e) {
+      for (uint32_t i = 0; i < kBlockSize; ++i) {
+        PushMidi(engines[e], tick + i);
+      }
+      loom_engine_advance(engines[e], kBlockSize, output);
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(output);
+      for (size_t i = 0; i < sizeof(output); ++i) {
+        hashes[e] = (hashes[e] ^ bytes[i]) * 1099511628211ULL;
+      }
+    }
+  }
+  for (uint32_t i = 0; i < kEnginesPerThread; ++i) {
+    loom_engine_destroy(engines[i]);
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t max_threads = argc > 1 ?
+      atoi(argv[1]) : std::thread::hardware_concurrency();
+  if (max_threads < 1) {
+    max_threads = 1;
+  }
+
+  bool ok = true;
+  uint64_t reference = 0;
+  for (uint32_t num_threads = 1; num_threads <= max_threads;
+      num_threads = num_threads == max_threads ?
+          max_threads + 1 : std::min(2 * num_threads, max_threads)) {
+    uint32_t num_instances = num_threads * kEnginesPerThread;
+    std::vector<uint64_t> hashes(num_instances);
+    std::vector<std::thread> threads;
+    // The engines run on threads of their own
+    double cpu_start = Seconds(CLOCK_PROCESS_CPUTIME_ID);
+    double start = Seconds(CLOCK_MONOTONIC);
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      threads.push_back(
+          std::thread(RunInstances, &hashes[i * kEnginesPerThread]));
+    }
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      threads[i].join();
+    }
+    double wall_time = Seconds(CLOCK_MONOTONIC) - start;
+    double cpu_time = Seconds(CLOCK_PROCESS_CPUTIME_ID) - cpu_start;
+
+    bool identical = true;
+    if (num_threads == 1) {
+      reference = hashes[0];
+    }
+    for (uint32_t i = 0; i < num_instances; ++i) {
+      identical = identical && hashes[i] == reference;
+    }
+    ok = ok && identical;
+    printf(
+        "%2u instance(s) on %u thread(s): %.1f instances per core, "
+        "%.0fx real time in total, outputs %s\n",
+        num_instances, num_threads,
+        kDuration * num_instances / cpu_time,
+        kDuration * num_instances / wall_time,
+        identical ? "identical" : "DIFFERENT");
+  }
+  return ok ? 0 : 1;
+}
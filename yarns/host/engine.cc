@@ -0,0 +1,265 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// C interface for running the Loom engine on a desktop host.
+
+#include "yarns/host/engine.h"
+
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "yarns/gate_scheduler.h"
+#include "yarns/midi_handler.h"
+#include "yarns/multi.h"
+#include "yarns/settings.h"
+
+using namespace yarns;
+
+namespace {
+
+const uint16_t kMidiQueueSize = 256;
+// Gate scheduler ticks (us) per half tick, i.e. per firmware SysTick
+const uint16_t kMicrosecondsPerSysTick = 125;
+
+struct MidiMessage {
+  uint32_t tick;
+  uint8_t size;
+  uint8_t data[3];
+};
+
+}  // namespace
+
+// Part, Voice and the looper reach the engine state through the global multi
+// (and midi_handler, the gate scheduler...). A host engine build keeps these
+// once per thread (see yarns/instance_state.h), so each engine gets a thread
+// of its own, and every call for the engine runs there.
+struct LoomEngine {
+  volatile uint16_t gate_counter;
+  uint32_t tick;
+  MidiMessage midi[kMidiQueueSize];
+  uint16_t midi_read_ptr;
+  uint16_t midi_write_ptr;
+
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable call_changed;
+  std::function<void()> call;
+  bool quit;
+};
+
+/* static */
+INSTANCE_STATE uint32_t yarns::Random::state_ = 0x21;
+
+namespace {
+
+thread_local LoomEngine* thread_engine = NULL;
+
+void RunEngineThread(LoomEngine* engine) {
+  thread_engine = engine;
+  std::unique_lock<std::mutex> lock(engine->mutex);
+  while (true) {
+    engine->call_changed.wait(lock, [engine] {
+      return engine->call || engine->quit;
+    });
+    if (!engine->call) {
+      break;
+    }
+    engine->call();
+    engine->call = nullptr;
+    engine->call_changed.notify_all();
+  }
+  thread_engine = NULL;
+}
+
+// Runs f on the engine's thread, and waits for it to return.
+void Call(const LoomEngine* engine, const std::function<void()>& f) {
+  LoomEngine* e = const_cast<LoomEngine*>(engine);
+  std::unique_lock<std::mutex> lock(e->mutex);
+  e->call = f;
+  e->call_changed.notify_all();
+  e->call_changed.wait(lock, [e] { return !e->call; });
+}
+
+void InitSettings() {
+  setting_defs.Init();
+}
+
+void DrainMidiOutput() {
+  while (midi_handler.mutable_output_buffer()->readable()) {
+    midi_handler.mutable_output_buffer()->ImmediateRead();
+  }
+  while (midi_handler.mutable_high_priority_output_buffer()->readable()) {
+    midi_handler.mutable_high_priority_output_buffer()->ImmediateRead();
+  }
+}
+
+void DeliverMidi(LoomEngine* engine) {
+  while (engine->midi_read_ptr != engine->midi_write_ptr) {
+    const MidiMessage& m = engine->midi[engine->midi_read_ptr];
+    if (static_cast<int32_t>(m.tick - engine->tick) > 0) {
+      break;
+    }
+    // One message at a time, so that the input buffer never overflows
+    for (uint8_t i = 0; i < m.size; ++i) {
+      midi_handler.PushByte(m.data[i]);
+    }
+    midi_handler.ProcessInput();
+    engine->midi_read_ptr = (engine->midi_read_ptr + 1) % kMidiQueueSize;
+  }
+}
+
+void Advance(
+    LoomEngine* engine,
+    uint32_t num_ticks,
+    LoomTickOutput* output) {
+  uint16_t cv[kNumCVOutputs];
+  bool gate[kNumCVOutputs];
+  uint16_t gate_time[kNumCVOutputs];
+  while (num_ticks--) {
+    DeliverMidi(engine);
+    // What the main loop gets done between two refreshes
+    multi.LowPriority();
+
+    // Two SysTicks, the second one with the CV/gate refresh
+    engine->gate_counter = engine->tick * (kMicrosecondsPerSysTick * 2);
+    multi.ClockFast();
+    engine->gate_counter += kMicrosecondsPerSysTick;
+    multi.ClockFast();
+    multi.Refresh();
+    multi.GetCvGate(cv, gate, gate_time);
+
+    for (uint8_t frame = 0; frame < LOOM_AUDIO_FRAMES_PER_TICK; ++frame) {
+      for (uint8_t channel = 0; channel < kNumCVOutputs; ++channel) {
+        CVOutput* cv_output = multi.mutable_cv_output(channel);
+        uint16_t value = cv[channel];
+        if (cv_output->is_audio()) {
+          value = cv_output->GetAudioSample();
+        } else if (cv_output->is_envelope()) {
+          value = cv_output->GetEnvelopeSample();
+        }
+        if (output) {
+          output->audio[frame][channel] = value;
+        }
+      }
+      multi.RefreshInternalClock();
+    }
+    if (output) {
+      for (uint8_t channel = 0; channel < kNumCVOutputs; ++channel) {
+        output->cv[channel] = cv[channel];
+        output->gate[channel] = gate[channel];
+      }
+      ++output;
+    }
+    DrainMidiOutput();
+    ++engine->tick;
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+LoomEngine* loom_engine_create(void) {
+  // The setting definitions are constant once built, and shared
+  static std::once_flag settings_initialized;
+  std::call_once(settings_initialized, &InitSettings);
+  LoomEngine* engine = new LoomEngine;
+  engine->gate_counter = 0;
+  engine->tick = 0;
+  engine->midi_read_ptr = engine->midi_write_ptr = 0;
+  engine->quit = false;
+  engine->thread = std::thread(RunEngineThread, engine);
+
+  Call(engine, [engine] {
+    assert(thread_engine == engine);
+    midi_handler.Init();
+    gate_scheduler.Init(&engine->gate_counter);
+    multi.Init(true);
+  });
+  return engine;
+}
+
+void loom_engine_destroy(LoomEngine* engine) {
+  Call(engine, [engine] { assert(thread_engine == engine); });
+  {
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->quit = true;
+  }
+  engine->call_changed.notify_all();
+  engine->thread.join();
+  delete engine;
+}
+
+int loom_engine_push_midi(
+    LoomEngine* engine,
+    uint32_t tick,
+    const uint8_t* message,
+    size_t size) {
+  // SysEx would need the storage manager, and dumps block on MIDI out
+  if (size == 0 || size > 3 || !(message[0] & 0x80) || message[0] == 0xf0) {
+    return 0;
+  }
+  int queued = 0;
+  Call(engine, [&] {
+    assert(thread_engine == engine);
+    uint16_t next = (engine->midi_write_ptr + 1) % kMidiQueueSize;
+    if (next == engine->midi_read_ptr) {
+      return;
+    }
+    MidiMessage& m = engine->midi[engine->midi_write_ptr];
+    m.tick = tick;
+    m.size = size;
+    memcpy(m.data, message, size);
+    engine->midi_write_ptr = next;
+    queued = 1;
+  });
+  return queued;
+}
+
+void loom_engine_advance(
+    LoomEngine* engine,
+    uint32_t num_ticks,
+    LoomTickOutput* output) {
+  Call(engine, [=] {
+    assert(thread_engine == engine);
+    Advance(engine, num_ticks, output);
+  });
+}
+
+uint32_t loom_engine_tick(const LoomEngine* engine) {
+  uint32_t tick = 0;
+  Call(engine, [&] {
+    assert(thread_engine == engine);
+    tick = engine->tick;
+  });
+  return tick;
+}
+
+}  // extern "C"
@@ -0,0 +1,83 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// C interface for running the Loom engine on a desktop host.
+
+#ifndef YARNS_HOST_ENGINE_H_
+#define YARNS_HOST_ENGINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// One tick is one CV refresh of the module: 250 us, 10 audio frames.
+#define LOOM_NUM_OUTPUTS 4
+#define LOOM_TICK_RATE 4000
+#define LOOM_AUDIO_FRAMES_PER_TICK 10
+
+// An engine keeps the state of one module, and runs on a thread of its own:
+// a thread can hold any number of engines, and engines run concurrently when
+// called from different threads. Calls for one engine must not overlap.
+typedef struct LoomEngine LoomEngine;
+
+typedef struct {
+  uint16_t cv[LOOM_NUM_OUTPUTS];
+  uint8_t gate[LOOM_NUM_OUTPUTS];
+  // Interleaved, one row per 40 kHz frame. Outputs that carry no audio or
+  // envelope hold their CV value.
+  uint16_t audio[LOOM_AUDIO_FRAMES_PER_TICK][LOOM_NUM_OUTPUTS];
+} LoomTickOutput;
+
+LoomEngine* loom_engine_create(void);
+void loom_engine_destroy(LoomEngine* engine);
+
+// Queues one complete MIDI message (status byte included) for delivery at
+// the given tick, counted since the engine was created. Messages are
+// delivered in the order they were pushed. Returns 0 if the queue is full or
+// the message is not supported (SysEx).
+int loom_engine_push_midi(
+    LoomEngine* engine,
+    uint32_t tick,
+    const uint8_t* message,
+    size_t size);
+
+// Runs the engine for num_ticks ticks. If output is not NULL, it receives
+// num_ticks entries.
+void loom_engine_advance(
+    LoomEngine* engine,
+    uint32_t num_ticks,
+    LoomTickOutput* output);
+
+uint32_t loom_engine_tick(const LoomEngine* engine);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif // YARNS_HOST_ENGINE_H_
@@ -0,0 +1,63 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Engine state that the module keeps once.
+
+#ifndef YARNS_INSTANCE_STATE_H_
+#define YARNS_INSTANCE_STATE_H_
+
+#include "stmlib/stmlib.h"
+
+// The host engine (yarns/host/engine.h) runs each engine on a thread of its
+// own, which holds its copy of the globals marked with this.
+#ifdef HOST_ENGINE
+#define INSTANCE_STATE thread_local
+
+namespace yarns {
+
+// Hides stmlib::Random, whose state all the engines would share. Same
+// generator, defined in yarns/host/engine.cc.
+class Random {
+ public:
+  static inline uint32_t GetWord() {
+    state_ = state_ * 1664525L + 1013904223L;
+    return state_;
+  }
+  static inline int16_t GetSample() {
+    return static_cast<int16_t>(GetWord() >> 16);
+  }
+
+ private:
+  static INSTANCE_STATE uint32_t state_;
+};
+
+}  // namespace yarns
+
+#else
+#define INSTANCE_STATE
+#endif  // HOST_ENGINE
+
+#endif // YARNS_INSTANCE_STATE_H_
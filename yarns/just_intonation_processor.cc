@@ -71,6 +71,6 @@ int JustIntonationProcessor::Tune(int note, int min, int max, int step) {
 }
 
 /* extern */
-JustIntonationProcessor just_intonation_processor;
+INSTANCE_STATE JustIntonationProcessor just_intonation_processor;
 
 }  // namespace yarns
\ No newline at end of file
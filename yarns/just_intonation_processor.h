@@ -47,6 +47,8 @@
 
 #include "stmlib/stmlib.h"
 
+#include "yarns/instance_state.h"
+
 namespace yarns {
 
 struct HistoryEntry {
@@ -111,7 +113,7 @@ class JustIntonationProcessor {
   DISALLOW_COPY_AND_ASSIGN(JustIntonationProcessor);
 };
 
-extern JustIntonationProcessor just_intonation_processor;
+extern INSTANCE_STATE JustIntonationProcessor just_intonation_processor;
 
 }  // namespace yarns
 
@@ -32,6 +32,8 @@
 
 #include "stmlib/stmlib.h"
 
+#include "yarns/instance_state.h"
+
 namespace yarns {
 
 const uint8_t kMaxNumNotes = 8;
@@ -100,7 +102,7 @@ class LayoutConfigurator {
   DISALLOW_COPY_AND_ASSIGN(LayoutConfigurator);
 };
 
-extern Multi multi;
+extern INSTANCE_STATE Multi multi;
 
 }  // namespace yarns
 
@@ -62,6 +62,15 @@ void Deck::RemoveAll() {
     &next_link_[kMaxNotes],
     Link()
   );
+
+  for (uint8_t i = 0; i < kNumLanes; ++i) {
+    Lane& lane = lanes_[i];
+    lane.controller = kNullController;
+    lane.size = 0;
+    lane.next = 0;
+    lane.touched = false;
+    lane.played = false;
+  }
 }
 
 void Deck::Rewind() {
@@ -195,10 +204,131 @@ void Deck::Advance(uint16_t new_pos, bool play) {
     }
   }
 
+  for (uint8_t i = 0; i < kNumLanes; ++i) {
+    AdvanceLane(lanes_[i], new_pos, play);
+  }
+
   pos_ = new_pos;
   needs_advance_ = false;
 }
 
+void Deck::AdvanceLane(Lane& lane, uint16_t new_pos, bool play) {
+  if (lane.touched &&
+      static_cast<uint16_t>(new_pos - lane.touch_pos) > kLaneTouchWindow) {
+    lane.touched = false;
+  }
+  // Only the last of several passed events needs to be sent
+  int16_t value = -1;
+  uint8_t remaining = lane.size;
+  while (remaining-- && lane.size) {
+    const ControlEvent& event = lane.events[lane.next];
+    if (!Passed(event.pos, pos_, new_pos)) {
+      break;
+    }
+    if (lane.touched) {
+      RemoveLaneEvent(lane, lane.next);
+    } else {
+      value = event.value;
+      lane.next = (lane.next + 1) % lane.size;
+    }
+  }
+  if (play && value >= 0) {
+    lane.played = true;
+    lane.played_value = value;
+  }
+}
+
+bool Deck::PopControl(uint8_t* controller, uint16_t* value) {
+  for (uint8_t i = 0; i < kNumLanes; ++i) {
+    Lane& lane = lanes_[i];
+    if (lane.played) {
+      lane.played = false;
+      *controller = lane.controller;
+      *value = lane.played_value;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Deck::RemoveLaneEvent(Lane& lane, uint8_t index) {
+  --lane.size;
+  for (uint8_t i = index; i < lane.size; ++i) {
+    lane.events[i] = lane.events[i + 1];
+  }
+  if (lane.next > index) {
+    --lane.next;
+  }
+  if (lane.next >= lane.size) {
+    lane.next = 0;
+  }
+}
+
+void Deck::RecordControl(uint8_t controller, uint16_t value) {
+  Lane* lane = NULL;
+  for (uint8_t i = 0; i < kNumLanes && !lane; ++i) {
+    if (lanes_[i].controller == controller) {
+      lane = &lanes_[i];
+    }
+  }
+  for (uint8_t i = 0; i < kNumLanes && !lane; ++i) {
+    if (!lanes_[i].size) {
+      lane = &lanes_[i];
+      lane->controller = controller;
+    }
+  }
+  if (!lane) { return; }
+  lane->touched = true;
+  lane->touch_pos = pos_;
+
+  // Events are kept sorted by position
+  uint8_t insert = 0;
+  while (insert < lane->size && lane->events[insert].pos <= pos_) {
+    ++insert;
+  }
+  if (lane->size) {
+    // The event currently in effect, wrapping around the loop
+    uint8_t previous = (insert + lane->size - 1) % lane->size;
+    ControlEvent& event = lane->events[previous];
+    if (event.value == value) {
+      return; // Redundant
+    }
+    if (static_cast<uint16_t>(pos_ - event.pos) < kLaneMinSpacing) {
+      // Too close: move the previous event here, if that keeps the order
+      if (previous + 1 == insert) {
+        event.pos = pos_;
+      }
+      event.value = value;
+      return;
+    }
+    if (lane->size == kMaxLaneEvents) {
+      // Full: drop the event that changes the value the least
+      uint8_t victim = 0;
+      int16_t smallest_change = INT16_MAX;
+      for (uint8_t i = 0; i < lane->size; ++i) {
+        uint8_t before = (i + lane->size - 1) % lane->size;
+        int16_t change = abs(
+            lane->events[i].value - lane->events[before].value);
+        if (change < smallest_change) {
+          smallest_change = change;
+          victim = i;
+        }
+      }
+      RemoveLaneEvent(*lane, victim);
+      if (victim < insert) {
+        --insert;
+      }
+    }
+  }
+  for (uint8_t i = lane->size; i > insert; --i) {
+    lane->events[i] = lane->events[i - 1];
+  }
+  lane->events[insert].pos = pos_;
+  lane->events[insert].value = value;
+  ++lane->size;
+  lane->next = (insert + 1) % lane->size;
+}
+
 uint8_t Deck::RecordNoteOn(uint8_t pitch, uint8_t velocity) {
   if (size_ == kMaxNotes) {
     RemoveOldestNote();
@@ -77,6 +77,41 @@ struct PackedNote {
     velocity  : kBitsMIDI;
 }__attribute__((packed));
 
+// Automation lanes record controller moves alongside the notes. They are
+// bounded (kNumLanes x kMaxLaneEvents, 148 bytes per part) and live in RAM
+// only. A multi is saved in a single flash page, and PackedMulti leaves 2 of
+// its 1022 bytes free. Even with positions cut to the 13 bits of the notes,
+// an event takes 27 bits, so the lanes of the 4 parts would need about
+// 8 x (2 + 16 x 27 / 8) = 448 bytes. Saving them would take a second page per
+// program, and a second packet in the SysEx dump format, which stores one
+// page per multi.
+const uint8_t kNumLanes = 2;
+const uint8_t kMaxLaneEvents = 16;
+const uint8_t kNullController = UINT8_MAX;
+const uint8_t kControllerPitchBend = 0x80; // Full 14-bit bend
+// A move closer than this to the previous event replaces it
+const uint16_t kLaneMinSpacing = 1 << 9;
+// While a lane was written less than this ago, the events it passes over
+// are erased rather than played, so a new move replaces the old one
+const uint16_t kLaneTouchWindow = 1 << 10;
+
+struct ControlEvent {
+  uint16_t pos;
+  uint16_t value;
+};
+
+struct Lane {
+  uint8_t controller;
+  uint8_t size;
+  uint8_t next; // Index of the next event to be played
+  bool touched;
+  uint16_t touch_pos;
+  // Last value passed over by playback, until the part takes it
+  bool played;
+  uint16_t played_value;
+  ControlEvent events[kMaxLaneEvents];
+};
+
 class Deck {
  public:
 
@@ -118,6 +153,9 @@ class Deck {
     uint16_t new_pos = lfo_.GetPhase() >> 16;
     Advance(new_pos, play);
   }
+  void RecordControl(uint8_t controller, uint16_t value);
+  // Takes the last value a lane played since the previous call, if any
+  bool PopControl(uint8_t* controller, uint16_t* value);
   uint8_t RecordNoteOn(uint8_t pitch, uint8_t velocity);
   bool RecordNoteOff(uint8_t index);
   uint8_t PeekNextOn() const;
@@ -130,6 +168,9 @@ class Deck {
   inline const Note& note_at(uint8_t index) const {
     return notes_[index];
   }
+  inline const Lane& lane(uint8_t index) const {
+    return lanes_[index];
+  }
 
   uint16_t pos_offset;
 
@@ -139,6 +180,8 @@ class Deck {
     return stmlib::modulo(i, kMaxNotes);
   }
   void Advance(uint16_t new_pos, bool play);
+  void AdvanceLane(Lane& lane, uint16_t new_pos, bool play);
+  void RemoveLaneEvent(Lane& lane, uint8_t index);
   bool Passed(uint16_t target, uint16_t before, uint16_t after) const;
   void LinkOn(uint8_t index);
   void LinkOff(uint8_t index);
@@ -154,6 +197,8 @@ class Deck {
   Link head_; // Points to the latest on/off
   Link next_link_[kMaxNotes];
 
+  Lane lanes_[kNumLanes];
+
   // Phase tracking
   SyncedLFO<23, 12> lfo_; // Gentle sync
   uint16_t pos_;
@@ -119,6 +119,7 @@ static const SettingIndex menu_live[] = {
 static const SettingIndex menu_oscillator[] = {
   SETTING_VOICING_OSCILLATOR_MODE,
   SETTING_VOICING_OSCILLATOR_SHAPE,
+  SETTING_VOICING_OSCILLATOR_QUALITY,
   SETTING_VOICING_TIMBRE_INIT,
   SETTING_VOICING_TIMBRE_MOD_LFO,
   SETTING_VOICING_TIMBRE_LFO_SHAPE,
@@ -40,16 +40,16 @@ namespace yarns {
 using namespace std;
 
 /* static */
-MidiHandler::MidiBuffer MidiHandler::input_buffer_; 
+INSTANCE_STATE MidiHandler::MidiBuffer MidiHandler::input_buffer_; 
 
 /* static */
-MidiHandler::MidiBuffer MidiHandler::output_buffer_;
+INSTANCE_STATE MidiHandler::MidiBuffer MidiHandler::output_buffer_;
 
 /* static */
-MidiHandler::SmallMidiBuffer MidiHandler::high_priority_output_buffer_;
+INSTANCE_STATE MidiHandler::SmallMidiBuffer MidiHandler::high_priority_output_buffer_;
 
 /* static */
-stmlib_midi::MidiStreamParser<MidiHandler> MidiHandler::parser_;
+INSTANCE_STATE stmlib_midi::MidiStreamParser<MidiHandler> MidiHandler::parser_;
 
 /* static */
 const MidiHandler::SysExDescription MidiHandler::accepted_sysex_[] = {
@@ -66,22 +66,22 @@ const MidiHandler::SysExDescription MidiHandler::accepted_sysex_[] = {
 };
 
 /* static */
-uint8_t MidiHandler::sysex_rx_write_ptr_;
+INSTANCE_STATE uint8_t MidiHandler::sysex_rx_write_ptr_;
 
 /* static */
-uint8_t MidiHandler::previous_packet_index_;
+INSTANCE_STATE uint8_t MidiHandler::previous_packet_index_;
 
 /* static */
-uint8_t MidiHandler::sysex_rx_buffer_[kSysexRxBufferSize];
+INSTANCE_STATE uint8_t MidiHandler::sysex_rx_buffer_[kSysexRxBufferSize];
 
 /* static */
-uint8_t MidiHandler::calibration_voice_;
+INSTANCE_STATE uint8_t MidiHandler::calibration_voice_;
 
 /* static */
-uint8_t MidiHandler::calibration_note_;
+INSTANCE_STATE uint8_t MidiHandler::calibration_note_;
 
 /* static */
-bool MidiHandler::factory_testing_requested_;
+INSTANCE_STATE bool MidiHandler::factory_testing_requested_;
 
 /* static */
 void MidiHandler::Init() {
@@ -99,7 +99,7 @@ void MidiHandler::Init() {
 void MidiHandler::DecodeSysExMessage() {
   uint8_t length = sysex_rx_write_ptr_;
 
-  if (sysex_rx_buffer_[length - 1] != 0xf7) {
+  if (!length || sysex_rx_buffer_[length - 1] != 0xf7) {
     // Discard long messages that have been truncated.
     return;
   }
@@ -148,19 +148,30 @@ void MidiHandler::HandleScaleOctaveTuning2ByteForm() {
 }
 
 
-enum SysExCommand {
-  SYSEX_COMMAND_DUMP_PACKET = 1,
-  SYSEX_COMMAND_REQUEST_PACKETS = 17,
-  SYSEX_COMMAND_FACTORY_TESTING_MODE = 32,
-  SYSEX_COMMAND_CALIBRATE = 33,
-};
-
 /* static */
 void MidiHandler::HandleYarnsSpecificMessage() {
-#ifndef TEST
+  // Everything past the f7 is left over from earlier messages, so the
+  // payload is bounded by the received length, never by scanning for f7.
+  uint8_t length = sysex_rx_write_ptr_;
+  if (length < 9) {
+    return;
+  }
   uint8_t command = sysex_rx_buffer_[6];
-  if (command == SYSEX_COMMAND_DUMP_PACKET) {
+  bool no_arguments = length == 11 &&
+      sysex_rx_buffer_[7] == 0 &&
+      sysex_rx_buffer_[8] == 0 &&
+      sysex_rx_buffer_[9] == 0;
+  if (command == SYSEX_COMMAND_DUMP_PACKET ||
+      command == SYSEX_COMMAND_CALIBRATION_PACKET ||
+      command == SYSEX_COMMAND_SONG_PACKET) {
     uint8_t packet_index = sysex_rx_buffer_[7];
+    // Header, then one nibble pair per byte including the checksum, then f7
+    uint8_t num_nibbles = length - 9;
+    if (num_nibbles < 2 || num_nibbles & 1 ||
+        num_nibbles > (kSysexMaxChunkSize + 1) * 2) {
+      previous_packet_index_ = 0xff;
+      return;
+    }
     
     // Handle packet reception.
     if (packet_index != 0 && packet_index != previous_packet_index_ + 1) {
@@ -172,12 +183,16 @@ void MidiHandler::HandleYarnsSpecificMessage() {
     // Denibblize.
     uint8_t* data = &sysex_rx_buffer_[8];
     uint8_t* byte_ptr = data;
-    uint8_t* nibble_ptr = data;
+    const uint8_t* nibble_ptr = data;
+    const uint8_t* nibble_end = data + num_nibbles;
     uint8_t checksum = 0;
-    while (*nibble_ptr != 0xf7 &&
-           static_cast<size_t>(byte_ptr - data) <= kSysexMaxChunkSize + 1) {
-      *byte_ptr = (*nibble_ptr++) << 4;
-      *byte_ptr |= (*nibble_ptr++);
+    while (nibble_ptr != nibble_end) {
+      if ((nibble_ptr[0] | nibble_ptr[1]) & 0xf0) {
+        previous_packet_index_ = 0xff;
+        return;
+      }
+      *byte_ptr = nibble_ptr[0] << 4 | nibble_ptr[1];
+      nibble_ptr += 2;
       // Warning! The last byte of the block, which is the checksum
       // is summed here!
       checksum += *byte_ptr++;
@@ -191,23 +206,31 @@ void MidiHandler::HandleYarnsSpecificMessage() {
     if (size != 0) {
       storage_manager.AppendData(data, size, packet_index == 0);
     } else if (packet_index) {
-      storage_manager.DeserializeMulti();
+      if (command == SYSEX_COMMAND_DUMP_PACKET) {
+        storage_manager.DeserializeMulti(false);
+      } else if (command == SYSEX_COMMAND_SONG_PACKET) {
+        storage_manager.SaveSong();
+      } else if (storage_manager.DeserializeCalibration()) {
+        storage_manager.SaveCalibration();
+      }
     }
   } else if (command == SYSEX_COMMAND_REQUEST_PACKETS) {
-    if (sysex_rx_buffer_[7] == 0 &&
-        sysex_rx_buffer_[8] == 0 && 
-        sysex_rx_buffer_[9] == 0 &&
-        sysex_rx_buffer_[10] == 0xf7) {
+    if (no_arguments) {
       storage_manager.SysExSendMulti();
     }
+  } else if (command == SYSEX_COMMAND_REQUEST_CALIBRATION) {
+    if (no_arguments) {
+      storage_manager.SysExSendCalibration();
+    }
   } else if (command == SYSEX_COMMAND_FACTORY_TESTING_MODE) {
-    if (sysex_rx_buffer_[7] == 0 &&
-        sysex_rx_buffer_[8] == 0 && 
-        sysex_rx_buffer_[9] == 0 &&
-        sysex_rx_buffer_[10] == 0xf7) {
+    if (no_arguments) {
       factory_testing_requested_ = true;
     }
   } else if (command == SYSEX_COMMAND_CALIBRATE) {
+    // A truncated message must not start or end a calibration either
+    if (length != 13) {
+      return;
+    }
     calibration_voice_ = sysex_rx_buffer_[7] >> 4;
     calibration_note_ = sysex_rx_buffer_[7] & 0xf;
     if (calibrating()) {
@@ -219,11 +242,11 @@ void MidiHandler::HandleYarnsSpecificMessage() {
       storage_manager.SaveCalibration();
     }
   }
-#endif  // TEST
 }
 
 /* static */
 void MidiHandler::SysExSendPacket(
+    uint8_t command,
     uint8_t packet_index,
     const uint8_t* data,
     size_t size) {
@@ -232,7 +255,7 @@ void MidiHandler::SysExSendPacket(
   for (uint8_t i = 0; i < 6; ++i) {
     SendBlocking(accepted_sysex_[0].prefix[i]);
   }
-  SendBlocking(SYSEX_COMMAND_DUMP_PACKET);
+  SendBlocking(command);
   SendBlocking(packet_index);
   
   // Outputs the data.
@@ -252,17 +275,20 @@ void MidiHandler::SysExSendPacket(
 }
 
 /* static */
-void MidiHandler::SysExSendPackets(const uint8_t* data, size_t size) {
+void MidiHandler::SysExSendPackets(
+    const uint8_t* data,
+    size_t size,
+    uint8_t command) {
   uint8_t block_index = 0;
   while (size) {
     size_t chunk_size = min(size, kSysexMaxChunkSize);
-    SysExSendPacket(block_index, data, chunk_size);
+    SysExSendPacket(command, block_index, data, chunk_size);
     size -= chunk_size;
     data += chunk_size;
     ++block_index;
   }
   // Send a NULL packet to indicate end of transmission.
-  SysExSendPacket(block_index, NULL, 0);
+  SysExSendPacket(command, block_index, NULL, 0);
 }
 
 /* extern */
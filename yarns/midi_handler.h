@@ -41,6 +41,16 @@ namespace yarns {
 const size_t kSysexMaxChunkSize = 64;
 const size_t kSysexRxBufferSize = kSysexMaxChunkSize * 2 + 16;
 
+enum SysExCommand {
+  SYSEX_COMMAND_DUMP_PACKET = 1,
+  SYSEX_COMMAND_REQUEST_PACKETS = 17,
+  SYSEX_COMMAND_FACTORY_TESTING_MODE = 32,
+  SYSEX_COMMAND_CALIBRATE = 33,
+  SYSEX_COMMAND_REQUEST_CALIBRATION = 34,
+  SYSEX_COMMAND_CALIBRATION_PACKET = 35,
+  SYSEX_COMMAND_SONG_PACKET = 36,
+};
+
 class MidiHandler {
  public:
   typedef stmlib::RingBuffer<uint8_t, 128> MidiBuffer;
@@ -212,7 +222,12 @@ class MidiHandler {
   }
   
   static inline void SendBlocking(uint8_t byte) {
+#ifdef TEST
+    // Nothing drains the output during a host call
+    output_buffer_.Overwrite(byte);
+#else
     output_buffer_.Write(byte);
+#endif  // TEST
   }
 
   static inline void SendNow(uint8_t byte) {
@@ -228,10 +243,15 @@ class MidiHandler {
   };
 
   static void Flush() {
+#ifndef TEST
     while (output_buffer_.readable());
+#endif  // TEST
   }
   
-  static void SysExSendPackets(const uint8_t* data, size_t size);
+  static void SysExSendPackets(
+      const uint8_t* data,
+      size_t size,
+      uint8_t command);
   
   static inline bool calibrating() {
     return calibration_voice_ < kNumCVOutputs && calibration_note_ < kNumOctaves;
@@ -247,6 +267,7 @@ class MidiHandler {
   
  private:
   static void SysExSendPacket(
+      uint8_t command,
       uint8_t packet_index,
       const uint8_t* data,
       size_t size);
@@ -264,20 +285,20 @@ class MidiHandler {
   static void HandleScaleOctaveTuning2ByteForm();
   static void HandleYarnsSpecificMessage();
   
-  static MidiBuffer input_buffer_; 
-  static MidiBuffer output_buffer_; 
-  static SmallMidiBuffer high_priority_output_buffer_;
-  static stmlib_midi::MidiStreamParser<MidiHandler> parser_;
+  static INSTANCE_STATE MidiBuffer input_buffer_; 
+  static INSTANCE_STATE MidiBuffer output_buffer_; 
+  static INSTANCE_STATE SmallMidiBuffer high_priority_output_buffer_;
+  static INSTANCE_STATE stmlib_midi::MidiStreamParser<MidiHandler> parser_;
   
-  static uint8_t sysex_rx_buffer_[kSysexRxBufferSize];
-  static uint8_t sysex_rx_write_ptr_;
+  static INSTANCE_STATE uint8_t sysex_rx_buffer_[kSysexRxBufferSize];
+  static INSTANCE_STATE uint8_t sysex_rx_write_ptr_;
   
-  static uint8_t previous_packet_index_;
+  static INSTANCE_STATE uint8_t previous_packet_index_;
   
-  static uint8_t calibration_voice_;
-  static uint8_t calibration_note_;
+  static INSTANCE_STATE uint8_t calibration_voice_;
+  static INSTANCE_STATE uint8_t calibration_note_;
   
-  static bool factory_testing_requested_;
+  static INSTANCE_STATE bool factory_testing_requested_;
   
   static const SysExDescription accepted_sysex_[];
    
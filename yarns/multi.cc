@@ -33,9 +33,11 @@
 
 #include "stmlib/algorithms/voice_allocator.h"
 
+#include "yarns/gate_scheduler.h"
 #include "yarns/just_intonation_processor.h"
 #include "yarns/midi_handler.h"
 #include "yarns/settings.h"
+#include "yarns/storage_manager.h"
 #include "yarns/ui.h"
 
 namespace yarns {
@@ -88,10 +90,18 @@ void Multi::Init(bool reset_calibration) {
   for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
     cv_outputs_[i].Init(reset_calibration);
   }
+  parameter_queue_.Init();
+  voices_touched_ = false;
+  settings_version_ = 0;
   running_ = false;
+  program_change_pending_ = false;
+  deserializing_ = false;
   recording_ = false;
   recording_part_ = 0;
   started_by_keyboard_ = true;
+  song_ = NULL;
+  song_index_ = 0;
+  gate_source_ = 0xff;
   
   // Put the multi in a usable state. Even if these settings will later be
   // overridden with some data retrieved from Flash (presets).
@@ -127,6 +137,23 @@ void Multi::Clock() {
   if (!running_) {
     return;
   }
+
+  if (program_change_pending_ && !clock_input_prescaler_) {
+    // Swap before the tick is counted, so that it opens the new program
+    uint16_t bar_duration = settings_.clock_bar_duration * 24;
+    bool bars = settings_.clock_bar_duration &&
+        settings_.clock_bar_duration <= kMaxBarDuration;
+    bool boundary = bars
+        ? uint16_t(bar_position_ + 1) >= bar_duration ||
+            bar_position_ == 0xffff
+        : (tick_counter_ + 1) % 24 == 0;
+    if (boundary) {
+      ApplyProgramChange();
+      if (!running_) {
+        return;
+      }
+    }
+  }
   
   uint16_t output_division = lut_clock_ratio_ticks[settings_.clock_output_division];
   uint16_t input_division = settings_.clock_input_division;
@@ -175,7 +202,7 @@ void Multi::Clock() {
       swing_counter_ = 0;
     }
     
-    if (song_pointer_) {
+    if (song_) {
       ClockSong();
     } else {
       if (internal_clock()) {
@@ -253,7 +280,7 @@ void Multi::Start(bool started_by_keyboard) {
   for (uint8_t i = 0; i < num_active_parts_; ++i) {
     part_[i].Start();
   }
-  song_pointer_ = NULL;
+  song_ = NULL;
   midi_clock_tick_duration_ = 0;
 }
 
@@ -270,7 +297,8 @@ void Multi::Stop() {
   stop_count_down_ = 0;
   running_ = false;
   started_by_keyboard_ = true;
-  song_pointer_ = NULL;
+  StopSongNotes();
+  song_ = NULL;
 }
 
 void Multi::ClockFast() {
@@ -282,6 +310,9 @@ void Multi::ClockFast() {
   }
 
   ++midi_clock_tick_duration_;
+  if (deserializing_) {
+    return;
+  }
   for (int i = 0; i < 12; ++i) {
     if (swing_predelay_[i] == 0) {
       for (uint8_t j = 0; j < num_active_parts_; ++j) {
@@ -314,6 +345,12 @@ void Multi::SpreadLFOs(int8_t spread, FastSyncedLFO** base_lfo, uint8_t num_lfos
 }
 
 void Multi::Refresh() {
+  // The outputs hold their last values while the main loop rewrites the parts
+  if (deserializing_) {
+    return;
+  }
+  // Queued voice parameters land here, before anything below reads them
+  ApplyPendingSettings();
   master_lfo_.Refresh();
   // Since the master LFO runs at 1/n of clock freq, we compensate by treating
   // each 1/n of its phase as a new tick, to make these output ticks 1:1 with
@@ -448,31 +485,36 @@ void Multi::AssignVoicesToCVOutputs() {
   }
 }
 
-void Multi::GetCvGate(uint16_t* cv, bool* gate) {
+void Multi::GetCvGate(uint16_t* cv, bool* gate, uint16_t* gate_time) {
+  // Voice gates carry the time of the note event that changed them. Clock,
+  // reset and trigger outputs have no CV to wait for, so they are stamped
+  // kGateLatency in the past and come out at this refresh.
+  uint16_t now = gate_scheduler.now();
   for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
     cv[i] = cv_outputs_[i].dc_dac_code();
+    gate_time[i] = now - kGateLatency;
   }
 
   switch (settings_.layout) {
     case LAYOUT_MONO:
     case LAYOUT_DUAL_POLYCHAINED:
-      gate[0] = voice_[0].gate();
+      gate[0] = voice_[0].gate(&gate_time[0]);
       gate[1] = voice_[0].trigger();
       gate[2] = clock();
       gate[3] = reset_or_playing_flag();
       break;
       
     case LAYOUT_DUAL_MONO:
-      gate[0] = voice_[0].gate();
-      gate[1] = voice_[1].gate();
+      gate[0] = voice_[0].gate(&gate_time[0]);
+      gate[1] = voice_[1].gate(&gate_time[1]);
       gate[2] = clock();
       gate[3] = reset_or_playing_flag();
       break;
     
     case LAYOUT_DUAL_POLY:
     case LAYOUT_QUAD_POLYCHAINED:
-      gate[0] = voice_[0].gate();
-      gate[1] = voice_[1].gate();
+      gate[0] = voice_[0].gate(&gate_time[0]);
+      gate[1] = voice_[1].gate(&gate_time[1]);
       gate[2] = clock();
       gate[3] = reset_or_playing_flag();
       break;
@@ -480,46 +522,46 @@ void Multi::GetCvGate(uint16_t* cv, bool* gate) {
     case LAYOUT_QUAD_MONO:
     case LAYOUT_QUAD_POLY:
     case LAYOUT_OCTAL_POLYCHAINED:
-      gate[0] = voice_[0].gate();
-      gate[1] = voice_[1].gate();
+      gate[0] = voice_[0].gate(&gate_time[0]);
+      gate[1] = voice_[1].gate(&gate_time[1]);
       if (settings_.clock_override) {
         gate[2] = clock();
         gate[3] = reset_or_playing_flag();
       } else {
-        gate[2] = voice_[2].gate();
-        gate[3] = voice_[3].gate();
+        gate[2] = voice_[2].gate(&gate_time[2]);
+        gate[3] = voice_[3].gate(&gate_time[3]);
       }
       break;
 
     case LAYOUT_THREE_ONE:
     case LAYOUT_TWO_TWO:
-      gate[0] = voice_[0].gate();
-      gate[1] = voice_[1].gate();
-      gate[2] = voice_[2].gate();
+      gate[0] = voice_[0].gate(&gate_time[0]);
+      gate[1] = voice_[1].gate(&gate_time[1]);
+      gate[2] = voice_[2].gate(&gate_time[2]);
       if (settings_.clock_override) {
         gate[3] = clock();
       } else {
-        gate[3] = voice_[3].gate();
+        gate[3] = voice_[3].gate(&gate_time[3]);
       }
       break;
     
     case LAYOUT_TWO_ONE:
-      gate[0] = voice_[0].gate();
-      gate[1] = voice_[1].gate();
-      gate[2] = voice_[2].gate();
+      gate[0] = voice_[0].gate(&gate_time[0]);
+      gate[1] = voice_[1].gate(&gate_time[1]);
+      gate[2] = voice_[2].gate(&gate_time[2]);
       gate[3] = clock();
       break;
 
     case LAYOUT_PARAPHONIC_PLUS_TWO:
-      gate[0] = cv_outputs_[0].gate();
-      gate[1] = cv_outputs_[1].gate();
+      gate[0] = cv_outputs_[0].gate(&gate_time[0]);
+      gate[1] = cv_outputs_[1].gate(&gate_time[1]);
       gate[2] = settings_.clock_override ? clock() : cv_outputs_[2].trigger();
-      gate[3] = cv_outputs_[3].gate();
+      gate[3] = cv_outputs_[3].gate(&gate_time[3]);
       break;
 
     case LAYOUT_TRI_MONO:
       for (uint8_t i = 0; i < 3; ++i) {
-        gate[i] = voice_[i].gate();
+        gate[i] = voice_[i].gate(&gate_time[i]);
       }
       gate[3] = clock();
       cv[3] = cv_outputs_[3].volts_dac_code(reset_or_playing_flag() ? 5 : 0);
@@ -533,17 +575,26 @@ void Multi::GetCvGate(uint16_t* cv, bool* gate) {
       break;
 
     case LAYOUT_QUAD_VOLTAGES:
-      gate[0] = voice_[0].gate();
-      gate[1] = voice_[1].gate();
+      gate[0] = voice_[0].gate(&gate_time[0]);
+      gate[1] = voice_[1].gate(&gate_time[1]);
       if (settings_.clock_override) {
         gate[2] = clock();
         gate[3] = reset_or_playing_flag();
       } else {
-        gate[2] = voice_[2].gate();
-        gate[3] = voice_[3].gate();
+        gate[2] = voice_[2].gate(&gate_time[2]);
+        gate[3] = voice_[3].gate(&gate_time[3]);
       }
       break;
   }
+
+  // When an output switches to another voice or to the clock, the new
+  // source's timestamp may be long gone -- or, once the counter has wrapped,
+  // seemingly in the future. Its edge is stamped at the switch instead.
+  uint8_t gate_source = (settings_.layout << 1) | settings_.clock_override;
+  if (gate_source != gate_source_) {
+    gate_source_ = gate_source;
+    fill(&gate_time[0], &gate_time[kNumCVOutputs], now);
+  }
 }
 
 void Multi::GetLedsBrightness(uint8_t* brightness) {
@@ -800,49 +851,141 @@ void Multi::AfterDeserialize() {
   }
 }
 
+void Multi::AfterSeamlessDeserialize(const bool* keep_notes) {
+  CONSTRAIN(settings_.control_change_mode, 0, CONTROL_CHANGE_MODE_LAST - 1);
+  if (settings_.layout == LAYOUT_PARAPHONIC_PLUS_TWO) {
+    CONSTRAIN(part_[0].mutable_voicing_settings()->oscillator_mode, OSCILLATOR_MODE_OFF + 1, OSCILLATOR_MODE_LAST - 1);
+  }
+
+  UpdateTempo();
+  for (uint8_t i = 0; i < kNumParts; ++i) {
+    if (keep_notes[i]) {
+      part_[i].AfterSeamlessDeserialize();
+    } else {
+      part_[i].AfterDeserialize();
+    }
+    macro_record_last_value_[i] = 127;
+  }
+  // The held notes play on through the new voice parameters from the next
+  // refresh
+  voices_touched_ = true;
+}
 
-const uint8_t song[] = {
+void Multi::ScheduleProgramChange() {
+  program_change_pending_ = true;
+  if (!running_) {
+    ApplyProgramChange();
+  }
+}
+
+void Multi::ApplyProgramChange() {
+  program_change_pending_ = false;
+  storage_manager.DeserializePendingMulti();
+}
+
+const SongEvent song_events[] = {
   #include "song/song.h"
-  255,
 };
 
+const Song demo_song = {
+  song_events,
+  sizeof(song_events) / sizeof(SongEvent),
+  140,
+  { 0x83, 0x83, 0x84, 0x86 },
+};
+
+/* static */
+bool Multi::IsPlayableSong(const Song& song) {
+  for (uint16_t i = 0; i < song.num_events; ++i) {
+    if (song.events[i].delta) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void Multi::StartSong() {
+  const Song* song = &demo_song;
+  if (song_index_ == 1 && storage_manager.LoadSong(&uploaded_song_)) {
+    song = &uploaded_song_;
+  }
+  song_index_ = song == &demo_song ? 1 : 0;
+
   Set(MULTI_LAYOUT, LAYOUT_QUAD_MONO);
-  part_[0].mutable_voicing_settings()->oscillator_shape = 0x83;
-  part_[1].mutable_voicing_settings()->oscillator_shape = 0x83;
-  part_[2].mutable_voicing_settings()->oscillator_shape = 0x84;
-  part_[3].mutable_voicing_settings()->oscillator_shape = 0x86;
+  for (uint8_t p = 0; p < kNumParts; ++p) {
+    part_[p].mutable_voicing_settings()->oscillator_shape = \
+        song->oscillator_shape[p];
+  }
   AllocateParts();
-  settings_.clock_tempo = 140;
+  settings_.clock_tempo = song->clock_tempo;
   Stop();
   Start(false);
   
-  song_pointer_ = &song[0];
-  song_clock_ = 0;
-  song_delta_ = 0;
+  fill(&song_notes_[0], &song_notes_[kMaxSongNotes], SongNote());
+  song_ = song;
+  song_event_ = 0;
+  song_delay_ = song->events[0].delta;
 }
 
 void Multi::ClockSong() {
-  while (song_clock_ >= song_delta_) {
-    if (*song_pointer_ == 255) {
-      song_pointer_ = &song[0];
+  for (uint8_t i = 0; i < kMaxSongNotes; ++i) {
+    SongNote* n = &song_notes_[i];
+    if (n->remaining && !--n->remaining) {
+      part_[n->part].NoteOff(0, n->note);
     }
-    if (*song_pointer_ == 254) {
-      song_delta_ += 6;
-    } else {
-      uint8_t part = *song_pointer_ >> 6;
-      uint8_t note = *song_pointer_ & 0x3f;
-      if (note == 0) {
-        part_[part].AllNotesOff();
-      } else {
-        part_[part].NoteOn(0, note + 24, 100);
-      }
-      song_clock_ = 0;
-      song_delta_ = 0;
+  }
+  // Every song has a non-zero delta (see IsPlayableSong), so this ends within
+  // one pass over the events due on this tick. The bound keeps it that way.
+  for (uint16_t n = 0; !song_delay_ && n < song_->num_events; ++n) {
+    const SongEvent& event = song_->events[song_event_];
+    if (event.velocity) {
+      PlaySongNote(event);
+    }
+    if (++song_event_ >= song_->num_events) {
+      song_event_ = 0;
+    }
+    song_delay_ = song_->events[song_event_].delta;
+  }
+  if (song_delay_) {
+    --song_delay_;
+  }
+}
+
+void Multi::PlaySongNote(const SongEvent& event) {
+  // Retrigger the same part and note from its own slot: left in another
+  // one, its release would cut the new note short. Otherwise take a free
+  // slot, or steal the one closest to its release.
+  SongNote* slot = &song_notes_[0];
+  for (uint8_t i = 0; i < kMaxSongNotes; ++i) {
+    SongNote* n = &song_notes_[i];
+    if (n->remaining && n->part == event.part && n->note == event.note) {
+      slot = n;
+      break;
+    }
+    if (n->remaining < slot->remaining) {
+      slot = n;
+    }
+  }
+  if (slot->remaining) {
+    part_[slot->part].NoteOff(0, slot->note);
+  }
+  slot->part = event.part;
+  slot->note = event.note;
+  slot->remaining = event.length;
+  part_[event.part].NoteOn(0, event.note, event.velocity);
+}
+
+void Multi::StopSongNotes() {
+  if (!song_) {
+    return;
+  }
+  for (uint8_t i = 0; i < kMaxSongNotes; ++i) {
+    SongNote* n = &song_notes_[i];
+    if (n->remaining) {
+      part_[n->part].NoteOff(0, n->note);
+      n->remaining = 0;
     }
-    ++song_pointer_;
   }
-  ++song_clock_;
 }
 
 void Multi::StartRecording(uint8_t part) {
@@ -900,7 +1043,7 @@ bool Multi::ControlChange(uint8_t channel, uint8_t controller, uint8_t value_7bi
     is_remote_control_channel(channel) &&
     setting_defs.remote_control_cc_map[controller] != 0xff
   ) {
-    SetFromCC(0xff, controller, value_7bits);
+    SetFromCC(0xff, controller, value_7bits, true);
   } else {
     for (uint8_t part_index = 0; part_index < num_active_parts_; ++part_index) {
       if (!part_accepts_channel(part_index, channel)) continue;
@@ -951,8 +1094,10 @@ bool Multi::ControlChange(uint8_t channel, uint8_t controller, uint8_t value_7bi
 
       case kCCMacroPlayMode:
         if (relative_increment) {
-          macro_zone = part_[part_index].midi_settings().play_mode;
-          if (part_[part_index].sequencer_settings().clock_quantization) {
+          macro_zone = GetSetting(
+              setting_defs.get(SETTING_SEQUENCER_PLAY_MODE), part_index);
+          if (GetSetting(setting_defs.get(
+              SETTING_SEQUENCER_CLOCK_QUANTIZATION), part_index)) {
             macro_zone = -macro_zone;
           }
           macro_zone += relative_increment;
@@ -963,10 +1108,11 @@ bool Multi::ControlChange(uint8_t channel, uint8_t controller, uint8_t value_7bi
 
         ApplySetting(SETTING_SEQUENCER_CLOCK_QUANTIZATION, part_index, macro_zone < MACRO_PLAY_MODE_MANUAL);
         ApplySetting(SETTING_SEQUENCER_PLAY_MODE, part_index, abs(macro_zone));
-        char label[2];
+        char label[3];
         if (macro_zone == MACRO_PLAY_MODE_MANUAL) strcpy(label, "--"); else {
           label[0] = macro_zone < MACRO_PLAY_MODE_MANUAL ? 'S' : 'L';
           label[1] = abs(macro_zone) == 1 ? 'A' : 'S';
+          label[2] = '\0';
         }
         ui.SplashPartString(label, part_index);
         break;
@@ -984,7 +1130,11 @@ bool Multi::ControlChange(uint8_t channel, uint8_t controller, uint8_t value_7bi
 
       default:
         thru = part_[part_index].ControlChange(channel, controller, value_7bits) && thru;
-        SetFromCC(part_index, controller, value_7bits);
+        // MPE member channels carry per-note expression, not settings
+        if (!part_[part_index].mpe_member_channel(channel)) {
+          SetFromCC(part_index, controller, value_7bits, true);
+          part_[part_index].LooperRecordControl(controller, value_7bits);
+        }
         break;
 
       }
@@ -1001,7 +1151,8 @@ int16_t Multi::ScaleAbsoluteCC(uint8_t value_7bits, int16_t min, int16_t max) co
   return scaled_value;
 }
 
-void Multi::SetFromCC(uint8_t part_index, uint8_t controller, uint8_t value_7bits) {
+void Multi::SetFromCC(
+    uint8_t part_index, uint8_t controller, uint8_t value_7bits, bool splash) {
   uint8_t* map = part_index == 0xff ?
     setting_defs.remote_control_cc_map : setting_defs.part_cc_map;
   uint8_t setting_index = map[controller];
@@ -1021,7 +1172,11 @@ void Multi::SetFromCC(uint8_t part_index, uint8_t controller, uint8_t value_7bit
       raw_value = TEMPO_EXTERNAL;
     }
   }
-  ApplySettingAndSplash(setting, part, raw_value);
+  if (splash) {
+    ApplySettingAndSplash(setting, part, raw_value);
+  } else {
+    ApplySetting(setting, part, raw_value);
+  }
 }
 
 void Multi::ApplySettingAndSplash(const Setting& setting, uint8_t part, int16_t raw_value) {
@@ -1029,29 +1184,79 @@ void Multi::ApplySettingAndSplash(const Setting& setting, uint8_t part, int16_t
   ui.SplashSetting(setting, part);
 }
 
-void Multi::ApplySetting(const Setting& setting, uint8_t part, int16_t raw_value) {
+int16_t Multi::ConstrainSetting(
+    const Setting& setting, uint8_t part, int16_t raw_value) const {
   // Apply dynamic min/max as needed
   int16_t min_value = setting.min_value;
   int16_t max_value = setting.max_value;
-  if (multi.part(part).num_voices() == 1) { // Part is monophonic
+  if (part_[part].num_voices() == 1) { // Part is monophonic
     if (&setting == &setting_defs.get(SETTING_VOICING_ALLOCATION_MODE))
       min_value = max_value = POLY_MODE_OFF;
     if (&setting == &setting_defs.get(SETTING_VOICING_LFO_SPREAD_VOICES))
       min_value = max_value = 0;
   }
   if (
-    multi.layout() == LAYOUT_PARAPHONIC_PLUS_TWO &&
+    settings_.layout == LAYOUT_PARAPHONIC_PLUS_TWO &&
     part == 0 &&
     &setting == &setting_defs.get(SETTING_VOICING_OSCILLATOR_MODE)
   ) {
     min_value = OSCILLATOR_MODE_DRONE;
   }
   CONSTRAIN(raw_value, min_value, max_value);
-  uint8_t value = static_cast<uint8_t>(raw_value);
+  return raw_value;
+}
+
+void Multi::ApplySetting(const Setting& setting, uint8_t part, int16_t raw_value) {
+  if (setting.domain != SETTING_DOMAIN_PART) { part = 0; }
+  uint8_t value = static_cast<uint8_t>(
+      ConstrainSetting(setting, part, raw_value));
 
   uint8_t prev_value = GetSetting(setting, part);
   if (prev_value == value) { return; }
 
+  // A setting changed again before the refresh got to it only takes its new
+  // value, so the queue holds at most one entry per setting between layout
+  // changes
+  uint8_t index = &setting - &setting_defs.get(0);
+  if (parameter_queue_.Replace(index, part, value, SETTING_LAYOUT)) {
+    return;
+  }
+  // Full means this many settings changed within one refresh period. The
+  // change is dropped rather than waited on: GetSetting keeps returning the
+  // old value, so the display shows that it did not take.
+  if (parameter_queue_.writable()) {
+    parameter_queue_.Write(index, part, value);
+  }
+}
+
+void Multi::ApplyPendingSettings() {
+  uint8_t num_changes = parameter_queue_.readable();
+  if (!num_changes && !voices_touched_) { return; }
+  for (uint8_t i = 0; i < num_changes; ++i) {
+    const ParameterChange& change = parameter_queue_.Peek(i);
+    if (change.setting == kVoidParameter) { continue; }
+    const Setting& setting = setting_defs.get(change.setting);
+    // Constrained again, against the layout this refresh sees
+    uint8_t value = static_cast<uint8_t>(
+        ConstrainSetting(setting, change.part, change.value));
+    if (value != ReadSetting(setting, change.part)) {
+      CommitSetting(setting, change.part, value);
+    }
+  }
+  parameter_queue_.Swallow(num_changes);
+  if (num_changes) {
+    ++settings_version_;
+  }
+
+  // Voice parameters are recomputed once per part, however many settings
+  // touched them
+  voices_touched_ = false;
+  for (uint8_t p = 0; p < num_active_parts_; ++p) {
+    part_[p].TouchVoicesIfNeeded();
+  }
+}
+
+void Multi::CommitSetting(const Setting& setting, uint8_t part, uint8_t value) {
   bool layout = &setting == &setting_defs.get(SETTING_LAYOUT);
   bool sequencer_semantics = \
     &setting == &setting_defs.get(SETTING_SEQUENCER_PLAY_MODE) ||
@@ -1065,7 +1270,7 @@ void Multi::ApplySetting(const Setting& setting, uint8_t part, int16_t raw_value
 
   switch (setting.domain) {
     case SETTING_DOMAIN_MULTI:
-      multi.Set(setting.address[0], value);
+      Set(setting.address[0], value);
       break;
     case SETTING_DOMAIN_PART:
       // When the module is configured in *triggers* mode, each part is mapped
@@ -1074,9 +1279,9 @@ void Multi::ApplySetting(const Setting& setting, uint8_t part, int16_t raw_value
       // This is a bit more user friendly than letting the user set note min
       // and note max to the same value.
       if (setting.address[1]) {
-        multi.mutable_part(part)->Set(setting.address[1], value);
+        part_[part].Set(setting.address[1], value);
       }
-      multi.mutable_part(part)->Set(setting.address[0], value);
+      part_[part].Set(setting.address[0], value);
       break;
 
     default:
@@ -1085,19 +1290,30 @@ void Multi::ApplySetting(const Setting& setting, uint8_t part, int16_t raw_value
 }
 
 uint8_t Multi::GetSetting(const Setting& setting, uint8_t part) const {
+  uint8_t value = 0;
+  if (parameter_queue_.Find(
+      &setting - &setting_defs.get(0),
+      setting.domain == SETTING_DOMAIN_PART ? part : 0,
+      &value)) {
+    return value;
+  }
+  return ReadSetting(setting, part);
+}
+
+uint8_t Multi::ReadSetting(const Setting& setting, uint8_t part) const {
   uint8_t value = 0;
   switch (setting.domain) {
     case SETTING_DOMAIN_MULTI:
-      value = multi.Get(setting.address[0]);
+      value = Get(setting.address[0]);
       break;
     case SETTING_DOMAIN_PART:
-      value = multi.part(part).Get(setting.address[0]);
+      value = part_[part].Get(setting.address[0]);
       break;
   }
   return value;
 }
 
 /* extern */
-Multi multi;
+INSTANCE_STATE Multi multi;
 
 }  // namespace yarns
@@ -32,8 +32,10 @@
 
 #include "stmlib/stmlib.h"
 
+#include "yarns/instance_state.h"
 #include "yarns/internal_clock.h"
 #include "yarns/layout_configurator.h"
+#include "yarns/parameter_queue.h"
 #include "yarns/part.h"
 #include "yarns/voice.h"
 #include "yarns/storage_manager.h"
@@ -46,16 +48,61 @@ const uint8_t kNumCVOutputs = 4;
 // One paraphonic part, one voice per remaining output
 const uint8_t kNumSystemVoices = kNumParaphonicVoices + (kNumCVOutputs - 1);
 const uint8_t kMaxBarDuration = 32;
+const uint8_t kParameterQueueSize = 16;
+const uint8_t kMaxSongNotes = 8;
 
 // Converts BPM to the Refresh phase increment of an LFO that cycles at 24 PPQN
 const uint32_t kTempoToTickPhaseIncrement = (UINT32_MAX / 4000) * 24 / 60;
 
+// Bumped when the packed layout changes in a way that needs migrating. Older
+// presets left this byte uninitialized, so a preset is only taken as current
+// if the checksums of its step streams also match, see IsLegacy.
+const uint8_t kPackedMultiVersion = 2;
+
+// One note of a song, timed in clock ticks (24 PPQN) from the previous event.
+// Events with a velocity of 0 only move time forward; the last event of a
+// song marks where it loops.
+struct SongEvent {
+  uint8_t delta;
+  uint8_t length;
+  uint16_t
+    part : 2,
+    note : 7,
+    velocity : 7;
+};
+
+struct Song {
+  const SongEvent* events;
+  uint16_t num_events;
+  uint8_t clock_tempo;
+  uint8_t oscillator_shape[kNumParts];
+};
+
+// A song received over SysEx, as kept in flash: this header, then its events.
+// The events keep the layout of SongEvent, the 16-bit word little-endian with
+// the part in its lowest bits (see yarns/song/smf_to_song.py).
+struct PackedSongHeader {
+  uint16_t num_events;
+  uint8_t clock_tempo;
+  uint8_t oscillator_shape[kNumParts];
+  uint8_t padding;
+};
+
+const uint16_t kMaxUploadedSongEvents =
+    (kMaxSize - sizeof(PackedSongHeader)) / sizeof(SongEvent);
+
+struct SongNote {
+  uint8_t part;
+  uint8_t note;
+  uint8_t remaining;
+};
+
 struct PackedMulti {
   PackedPart parts[kNumParts];
 
   int8_t custom_pitch_table[12];
 
-  unsigned int // 7 bits to spare (plus 8 in flash_padding)
+  unsigned int // 7 bits to spare
     layout : 4, // values free: 1
     clock_tempo : 8, // values free: 54
     clock_swing : 7, // values free: 28
@@ -69,7 +116,7 @@ struct PackedMulti {
 
   uint8_t control_change_mode; // Breaking: move to bitfield when convenient
 
-  uint8_t flash_padding[1];
+  uint8_t version;
 }__attribute__((packed));
 
 struct MultiSettings {
@@ -204,7 +251,7 @@ class Multi {
 
   inline bool part_accepts_channel(uint8_t part, uint8_t channel) const {
     return is_remote_control_channel(channel) ||
-      midi(part).channel == kMidiChannelOmni ||
+      midi(part).channel >= kMidiChannelOmni || // Omni or MPE
       midi(part).channel == channel;
   }
 
@@ -296,12 +343,16 @@ class Multi {
     value += increment;
     return value;
   }
-  void SetFromCC(uint8_t part_index, uint8_t controller, uint8_t value);
+  void SetFromCC(
+      uint8_t part_index, uint8_t controller, uint8_t value, bool splash);
   uint8_t GetSetting(const Setting& setting, uint8_t part) const;
   void ApplySetting(SettingIndex setting, uint8_t part, int16_t raw_value) {
     ApplySetting(setting_defs.get(setting), part, raw_value);
   };
   void ApplySetting(const Setting& setting, uint8_t part, int16_t raw_value);
+  void ApplyPendingSettings();
+  // Bumped whenever settings are committed
+  inline uint8_t settings_version() const { return settings_version_; }
   void ApplySettingAndSplash(const Setting& setting, uint8_t part, int16_t raw_value);
 
   bool PitchBend(uint8_t channel, uint16_t pitch_bend) {
@@ -395,6 +446,7 @@ class Multi {
   }
   
   void AfterDeserialize();
+  void AfterSeamlessDeserialize(const bool* keep_notes);
   void ClockFast();
   void Refresh();
   void RefreshInternalClock() {
@@ -404,6 +456,10 @@ class Multi {
   }
 
   void LowPriority() {
+    if (program_change_pending_ && !running_) {
+      ApplyProgramChange();
+    }
+
     while (internal_clock_ticks_) {
       Clock();
       --internal_clock_ticks_;
@@ -412,6 +468,10 @@ class Multi {
     for (uint8_t p = 0; p < num_active_parts_; ++p) {
       if (running()) {
         part_[p].mutable_looper().AdvanceToPresent(part_[p].looper_in_use());
+        uint8_t controller, value;
+        while (part_[p].LooperPlayControls(&controller, &value)) {
+          SetFromCC(p, controller, value, false);
+        }
       }
       for (uint8_t v = 0; v < part_[p].num_voices(); ++v) {
         part_[p].voice(v)->RenderSamples();
@@ -434,6 +494,12 @@ class Multi {
     return settings_.clock_tempo * kTempoToTickPhaseIncrement;
   }
   inline bool running() const { return running_; }
+
+  // A program loaded while the clock runs waits in the storage manager until
+  // the next bar (or beat, without bars), then swaps in without a stop
+  void ScheduleProgramChange();
+  void ApplyProgramChange();
+  inline bool program_change_pending() const { return program_change_pending_; }
   inline bool recording() const { return recording_; }
   inline uint8_t recording_part() const { return recording_part_; }
   inline bool clock() const {
@@ -484,7 +550,7 @@ class Multi {
     cv_outputs_[cv_i].assign(&voice_[voice_i], r, num_audio_voices);
   }
   void AssignVoicesToCVOutputs();
-  void GetCvGate(uint16_t* cv, bool* gate);
+  void GetCvGate(uint16_t* cv, bool* gate, uint16_t* gate_time);
   void GetLedsBrightness(uint8_t* brightness);
 
   template<typename T>
@@ -494,6 +560,7 @@ class Multi {
       part_[i].Pack(packed.parts[i]);
     }
     settings_.Pack(packed);
+    packed.version = kPackedMultiVersion;
     const uint16_t size = sizeof(packed);
     // char (*__debug)[size] = 1;
     STATIC_ASSERT(size == 1020, expected);
@@ -502,17 +569,48 @@ class Multi {
     stream_buffer->Write(packed);
   };
   
+  static bool IsLegacy(const PackedMulti& packed) {
+    if (packed.version != kPackedMultiVersion) {
+      return true;
+    }
+    for (uint8_t i = 0; i < kNumParts; i++) {
+      if (!SequencerSettings::ValidSteps(packed.parts[i])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   template<typename T>
-  void Deserialize(T* stream_buffer) {
+  void Deserialize(T* stream_buffer, bool seamless) {
+    deserializing_ = true;
+    // Whatever lands now replaces a program still waiting for its bar
+    program_change_pending_ = false;
+    parameter_queue_.Flush();
     StopRecording(recording_part_);
-    Stop();
+    if (!seamless) {
+      Stop();
+    }
     PackedMulti packed;
     stream_buffer->Read(&packed);
+    uint8_t old_layout = settings_.layout;
+    bool keep_notes[kNumParts];
+    bool legacy = IsLegacy(packed);
     for (uint8_t i = 0; i < kNumParts; i++) {
-      part_[i].Unpack(packed.parts[i]);
+      if (legacy) {
+        SequencerSettings::MigrateLegacySteps(packed.parts[i]);
+        // These bits were unused, and hold whatever was there before
+        packed.parts[i].oscillator_quality = OSCILLATOR_QUALITY_STANDARD;
+      }
+      keep_notes[i] = part_[i].Unpack(packed.parts[i]);
     }
     settings_.Unpack(packed);
-    AfterDeserialize();
+    if (seamless && settings_.layout == old_layout) {
+      AfterSeamlessDeserialize(keep_notes);
+    } else {
+      AfterDeserialize();
+    }
+    deserializing_ = false;
   };
   
   template<typename T>
@@ -523,10 +621,18 @@ class Multi {
         stream_buffer->Write(cv_outputs_[i].calibration_dac_code(j)); // 2 bytes
       }
     }
+    // 4 voices x 10 half-octave trims x 2 bytes = 80 bytes
+    for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
+      for (uint8_t j = 0; j < kNumHalfOctaveTrims; ++j) {
+        stream_buffer->Write(cv_outputs_[i].half_octave_trim(j)); // 2 bytes
+      }
+    }
   };
   
+  // Calibrations saved before the half-octave trims only hold the octave
+  // points; the trims are then left flat
   template<typename T>
-  void DeserializeCalibration(T* stream_buffer) {
+  void DeserializeCalibration(T* stream_buffer, bool has_trims) {
     for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
       for (uint8_t j = 0; j < kNumOctaves; ++j) {
         uint16_t v;
@@ -534,6 +640,15 @@ class Multi {
         cv_outputs_[i].set_calibration_dac_code(j, v);
       }
     }
+    for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
+      for (uint8_t j = 0; j < kNumHalfOctaveTrims; ++j) {
+        int16_t v = 0;
+        if (has_trims) {
+          stream_buffer->Read(&v);
+        }
+        cv_outputs_[i].set_half_octave_trim(j, v);
+      }
+    }
   };
 
   void StartLearning() {
@@ -548,19 +663,41 @@ class Multi {
     return layout_configurator_.learning();
   }
   
+  // Plays the demo song, or the uploaded one, in turn
   void StartSong();
+  inline bool playing_song() const { return song_ != NULL; }
+  // A song must move time forward at least once per loop
+  static bool IsPlayableSong(const Song& song);
 
  private:
   void ChangeLayout(Layout old_layout, Layout new_layout);
   void UpdateTempo();
   void AllocateParts();
   void ClockSong();
+  void PlaySongNote(const SongEvent& event);
+  void StopSongNotes();
   void SpreadLFOs(int8_t spread, FastSyncedLFO** base_lfo, uint8_t num_lfos);
+  int16_t ConstrainSetting(
+      const Setting& setting, uint8_t part, int16_t raw_value) const;
+  // Committed value, without the changes still in the queue
+  uint8_t ReadSetting(const Setting& setting, uint8_t part) const;
+  void CommitSetting(const Setting& setting, uint8_t part, uint8_t value);
+  uint8_t settings_version_;
   
   MultiSettings settings_;
+
+  // Settings written by ApplySetting from the main loop, and drained by
+  // Refresh from the SysTick interrupt, before it reads any of them
+  ParameterQueue<kParameterQueueSize> parameter_queue_;
+  // Parts whose voice parameters were rewritten outside of the queue
+  volatile bool voices_touched_;
   
   bool running_;
   bool started_by_keyboard_;
+  bool program_change_pending_;
+  // Holds the refresh and the swing predelays while Deserialize rewrites the
+  // parts under the ISR
+  volatile bool deserializing_;
   bool recording_;
   uint8_t recording_part_;
   uint8_t macro_record_last_value_[kNumParts];
@@ -599,6 +736,7 @@ class Multi {
   bool dirty_;
   
   uint8_t num_active_parts_;
+  uint8_t gate_source_;
   
   Part part_[kNumParts];
   Voice voice_[kNumSystemVoices];
@@ -606,14 +744,17 @@ class Multi {
 
   LayoutConfigurator layout_configurator_;
   
-  const uint8_t* song_pointer_;
-  uint32_t song_clock_;
-  uint8_t song_delta_;
+  const Song* song_;
+  Song uploaded_song_;
+  uint8_t song_index_;
+  uint16_t song_event_;
+  uint8_t song_delay_;
+  SongNote song_notes_[kMaxSongNotes];
 
   DISALLOW_COPY_AND_ASSIGN(Multi);
 };
 
-extern Multi multi;
+extern INSTANCE_STATE Multi multi;
 
 }  // namespace yarns
 
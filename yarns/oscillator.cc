@@ -32,6 +32,7 @@
 #include "stmlib/utils/dsp.h"
 #include "stmlib/utils/random.h"
 
+#include "yarns/instance_state.h"
 #include "yarns/resources.h"
 
 namespace yarns {
@@ -43,6 +44,9 @@ static const size_t kNumZones = 15;
 static const uint16_t kHighestNote = 128 * 128;
 static const uint16_t kPitchTableStart = 116 * 128;
 static const uint16_t kOctave = 12 * 128;
+// Nyquist frequency of the half rate, above which LITE falls back to the full
+// rate. Up to kHighestNote, a doubled phase increment still fits in 32 bits.
+static const uint16_t kLiteHighestNote = 123 * 128;
 
 /* static */
 Oscillator::RenderFn Oscillator::fn_table_[] = {
@@ -138,9 +142,75 @@ uint32_t Oscillator::ComputePhaseIncrement(int16_t midi_pitch) const {
     num_shifts = std::min(__builtin_clzl(phase_increment), static_cast<int>(-num_shifts));
     phase_increment <<= num_shifts;
   }
+  // Compensate for the internal sample rate
+  if (render_quality_ == OSCILLATOR_QUALITY_OVERSAMPLED) {
+    phase_increment >>= 1;
+  } else if (render_quality_ == OSCILLATOR_QUALITY_LITE) {
+    phase_increment <<= 1;
+  }
   return phase_increment;
 }
 
+OscillatorQuality Oscillator::RenderQuality() const {
+  switch (quality_) {
+    case OSCILLATOR_QUALITY_OVERSAMPLED:
+      // Only the shapes that generate their harmonics with a nonlinearity
+      // gain from it; the BLEP shapes are already band-limited
+      if (
+        shape_ == OSC_SHAPE_FOLD_SINE ||
+        shape_ == OSC_SHAPE_FOLD_TRIANGLE ||
+        shape_ >= OSC_SHAPE_TANH_SINE
+      ) return OSCILLATOR_QUALITY_OVERSAMPLED;
+      break;
+    case OSCILLATOR_QUALITY_LITE:
+      // SVF coefficients are tuned for the full rate
+      if (
+        shape_ < OSC_SHAPE_CZ_PULSE_LP ||
+        shape_ == OSC_SHAPE_LP_PULSE ||
+        shape_ == OSC_SHAPE_LP_SAW
+      ) break;
+      // The sync and phase distortion modulators are clamped below
+      // kHighestNote, but the FM modulator is not
+      if (shape_ >= OSC_SHAPE_FM) {
+        int16_t interval = lut_fm_modulator_intervals[shape_ - OSC_SHAPE_FM];
+        if (pitch_ + std::max(interval, int16_t(0)) >= kLiteHighestNote) break;
+      } else if (pitch_ >= kLiteHighestNote) {
+        break;
+      }
+      return OSCILLATOR_QUALITY_LITE;
+    default:
+      break;
+  }
+  return OSCILLATOR_QUALITY_STANDARD;
+}
+
+void Oscillator::WriteSamples(const int16_t* samples) {
+  size_t size = kAudioBlockSize;
+  switch (render_quality_) {
+    case OSCILLATOR_QUALITY_OVERSAMPLED:
+      while (size--) {
+        audio_buffer_.Overwrite(decimator_.Process(samples[0], samples[1]));
+        samples += 2;
+      }
+      break;
+    case OSCILLATOR_QUALITY_LITE:
+      // Linear interpolation, which keeps the images of the half rate lower
+      // than repeating each sample would
+      size >>= 1;
+      while (size--) {
+        audio_buffer_.Overwrite((previous_sample_ + *samples) >> 1);
+        audio_buffer_.Overwrite(*samples);
+        previous_sample_ = *samples++;
+      }
+      break;
+    default:
+      while (size--) {
+        audio_buffer_.Overwrite(*samples++);
+      }
+      break;
+  }
+}
+
 void Oscillator::Render() {
   if (audio_buffer_.writable() < kAudioBlockSize) return;
   
@@ -149,6 +219,20 @@ void Oscillator::Render() {
   } else if (pitch_ < 0) {
     pitch_ = 0;
   }
+
+  OscillatorQuality render_quality = RenderQuality();
+  if (render_quality != render_quality_) {
+    render_quality_ = render_quality;
+    decimator_.Init();
+    previous_sample_ = 0;
+    switch (render_quality_) {
+      case OSCILLATOR_QUALITY_OVERSAMPLED: num_samples_ = kAudioBlockSize << 1; break;
+      case OSCILLATOR_QUALITY_LITE: num_samples_ = kAudioBlockSize >> 1; break;
+      default: num_samples_ = kAudioBlockSize; break;
+    }
+    timbre_.set_delta(num_samples_);
+    gain_.set_delta(num_samples_);
+  }
   phase_increment_ = ComputePhaseIncrement(pitch_);
   
   uint8_t fn_index = shape_;
@@ -162,14 +246,17 @@ void Oscillator::Render() {
 
 #define RENDER_CORE(body) \
   int32_t next_sample = next_sample_; \
-  size_t size = kAudioBlockSize; \
+  int16_t samples[kAudioBlockSize << 1]; \
+  int16_t* out = samples; \
+  size_t size = num_samples_; \
   while (size--) { \
     int32_t this_sample = next_sample; \
     next_sample = 0; \
     body \
-    audio_buffer_.Overwrite((gain * this_sample) >> 15); \
+    *out++ = (gain * this_sample) >> 15; \
   } \
   next_sample_ = next_sample; \
+  WriteSamples(samples);
 
 #define RENDER_WITH_PHASE_GAIN(body) \
   gain_.ComputeSlope(); \
@@ -34,7 +34,9 @@
 #include "stmlib/utils/ring_buffer.h"
 
 #include "yarns/interpolator.h"
+#include "yarns/resources.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 
@@ -52,6 +54,44 @@ class StateVariableFilter {
   Interpolator cutoff, damp;
 };
 
+// 11-tap half-band lowpass for 2x decimation. Every other tap is zero, and
+// the taps sum to 512.
+class HalfBandDecimator {
+ public:
+  inline void Init() {
+    std::fill(&x_[0], &x_[9], 0);
+  }
+
+  // Consumes two consecutive samples at the oversampled rate
+  inline int16_t Process(int16_t a, int16_t b) {
+    // x_[i] holds the sample (i + 2) before b
+    int32_t y = (256 * x_[3]) +
+      150 * (x_[2] + x_[4]) -
+      25 * (x_[0] + x_[6]) +
+      3 * (b + x_[8]);
+    std::copy_backward(&x_[0], &x_[7], &x_[9]);
+    x_[1] = a;
+    x_[0] = b;
+    y >>= 9;
+    CONSTRAIN(y, INT16_MIN, INT16_MAX);
+    return y;
+  }
+
+ private:
+  int32_t x_[9];
+};
+
+enum OscillatorQuality {
+  // Zero, so the bits of presets saved before this setting existed decode to it
+  OSCILLATOR_QUALITY_STANDARD,
+  // Half-rate rendering, for paraphony and drones
+  OSCILLATOR_QUALITY_LITE,
+  // FM, folding, and waveshaping rendered at 2x and decimated
+  OSCILLATOR_QUALITY_OVERSAMPLED,
+
+  OSCILLATOR_QUALITY_LAST
+};
+
 struct PhaseDistortionSquareModulator {
   int32_t integrator;
   bool polarity;
@@ -84,6 +124,8 @@ enum OscillatorShape {
   OSC_SHAPE_TANH_SINE,
   OSC_SHAPE_EXP_SINE,
   OSC_SHAPE_FM,
+  // One FM shape per ratio
+  OSC_SHAPE_FM_LAST = OSC_SHAPE_FM + LUT_FM_RATIO_NAMES_SIZE - 1,
 };
 
 class Oscillator {
@@ -102,8 +144,14 @@ class Oscillator {
     pitch_ = 60 << 7;
     phase_ = 0;
     phase_increment_ = 1;
+    modulator_phase_ = 0;
     high_ = false;
     next_sample_ = 0;
+    quality_ = OSCILLATOR_QUALITY_STANDARD;
+    render_quality_ = OSCILLATOR_QUALITY_STANDARD;
+    num_samples_ = kAudioBlockSize;
+    decimator_.Init();
+    previous_sample_ = 0;
   }
 
   inline uint16_t ReadSample() {
@@ -115,6 +163,9 @@ class Oscillator {
   inline void set_shape(OscillatorShape shape) {
     shape_ = shape;
   }
+  inline void set_quality(OscillatorQuality quality) {
+    quality_ = quality;
+  }
   
   void Render();
   
@@ -138,6 +189,8 @@ class Oscillator {
   void RenderFM();
   
   uint32_t ComputePhaseIncrement(int16_t midi_pitch) const;
+  OscillatorQuality RenderQuality() const;
+  void WriteSamples(const int16_t* samples);
   
   inline int32_t ThisBlepSample(uint32_t t) const {
     if (t > 65535) {
@@ -155,6 +208,14 @@ class Oscillator {
   }
 
   OscillatorShape shape_;
+  OscillatorQuality quality_;
+  // What the current shape actually renders at, given quality_
+  OscillatorQuality render_quality_;
+  // Samples rendered per block at the internal rate
+  uint8_t num_samples_;
+  HalfBandDecimator decimator_;
+  // Last sample rendered at the half rate
+  int16_t previous_sample_;
   Interpolator timbre_, gain_;
   int16_t pitch_;
 
@@ -0,0 +1,149 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Single-producer/single-consumer queue of pending setting changes.
+
+#ifndef YARNS_PARAMETER_QUEUE_H_
+#define YARNS_PARAMETER_QUEUE_H_
+
+#include "stmlib/stmlib.h"
+
+namespace yarns {
+
+// Marks an entry dropped by Flush
+const uint8_t kVoidParameter = 0xff;
+
+struct ParameterChange {
+  uint8_t setting;
+  uint8_t part;
+  uint8_t value;
+};
+
+// The producer only touches write_ptr_, the consumer only touches read_ptr_,
+// so no locking is needed as long as each side stays in a single context, and
+// the consumer is an interrupt that the producer cannot preempt.
+// The consumer reads entries in place and releases them with Swallow once
+// they are applied, which lets the producer keep seeing its own writes via
+// Find until the settings bytes actually hold them.
+template<uint8_t size>
+class ParameterQueue {
+ public:
+  ParameterQueue() { }
+  ~ParameterQueue() { }
+
+  inline void Init() {
+    read_ptr_ = write_ptr_ = 0;
+  }
+
+  inline uint8_t readable() const {
+    return (write_ptr_ - read_ptr_) & (size - 1);
+  }
+
+  inline uint8_t writable() const {
+    return (read_ptr_ - write_ptr_ - 1) & (size - 1);
+  }
+
+  // Producer side
+  inline void Write(uint8_t setting, uint8_t part, uint8_t value) {
+    uint8_t w = write_ptr_;
+    buffer_[w].setting = setting;
+    buffer_[w].part = part;
+    buffer_[w].value = value;
+    write_ptr_ = (w + 1) & (size - 1);
+  }
+
+  // Producer side: drops everything that has not been consumed yet. Only the
+  // consumer may move read_ptr_, so the entries are voided in place.
+  inline void Flush() {
+    for (uint8_t i = read_ptr_; i != write_ptr_; i = (i + 1) & (size - 1)) {
+      buffer_[i].setting = kVoidParameter;
+    }
+  }
+
+  // Producer side: most recent pending value for this setting, if any
+  bool Find(uint8_t setting, uint8_t part, uint8_t* value) const {
+    uint8_t r = read_ptr_;
+    uint8_t i = write_ptr_;
+    while (i != r) {
+      i = (i - 1) & (size - 1);
+      if (buffer_[i].setting == setting && buffer_[i].part == part) {
+        *value = buffer_[i].value;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Producer side: gives the pending entry for this setting its new value in
+  // place. An entry for the |barrier| setting, whose commit rewrites other
+  // settings, is never moved across, so the changes still land in the order
+  // they were made. Fails when there is no such entry, or when the consumer
+  // took it before the new value was in.
+  bool Replace(uint8_t setting, uint8_t part, uint8_t value, uint8_t barrier) {
+    uint8_t r = read_ptr_;
+    uint8_t w = write_ptr_;
+    uint8_t i = w;
+    while (i != r) {
+      i = (i - 1) & (size - 1);
+      if (buffer_[i].setting == setting && buffer_[i].part == part) {
+        if (setting == barrier && ((i + 1) & (size - 1)) != w) {
+          return false;
+        }
+        buffer_[i].value = value;
+        // The consumer runs to completion once it has started, so if it has
+        // not moved past the entry yet, it will read the new value
+        r = read_ptr_;
+        return ((i - r) & (size - 1)) < ((w - r) & (size - 1));
+      }
+      if (buffer_[i].setting == barrier) {
+        return false;
+      }
+    }
+    return false;
+  }
+
+  // Consumer side: n-th oldest pending entry, n < readable()
+  inline const ParameterChange& Peek(uint8_t n) const {
+    return buffer_[(read_ptr_ + n) & (size - 1)];
+  }
+
+  inline void Swallow(uint8_t n) {
+    read_ptr_ = (read_ptr_ + n) & (size - 1);
+  }
+
+ private:
+  STATIC_ASSERT((size & (size - 1)) == 0, power_of_two);
+
+  ParameterChange buffer_[size];
+  volatile uint8_t read_ptr_;
+  volatile uint8_t write_ptr_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParameterQueue);
+};
+
+}  // namespace yarns
+
+#endif // YARNS_PARAMETER_QUEUE_H_
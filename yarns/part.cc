@@ -34,6 +34,7 @@
 #include "stmlib/midi/midi.h"
 #include "stmlib/utils/random.h"
 
+#include "yarns/instance_state.h"
 #include "yarns/just_intonation_processor.h"
 #include "yarns/midi_handler.h"
 #include "yarns/resources.h"
@@ -59,7 +60,11 @@ void Part::Init() {
       VOICE_ALLOCATION_NOT_FOUND);
   num_voices_ = 0;
   polychained_ = false;
+  voices_touched_ = false;
   seq_recording_ = false;
+  mpe_note_on_channel_ = kNoMPEChannel;
+  MPEClearNotes();
+  ResetMPE();
 
   looper_.Init(this);
 
@@ -108,6 +113,7 @@ void Part::Init() {
   voicing_.env_mod_decay = -32;
   voicing_.env_mod_sustain = 0;
   voicing_.env_mod_release = 32;
+  voicing_.oscillator_quality = OSCILLATOR_QUALITY_STANDARD;
 
   seq_.clock_division = 20;
   seq_.gate_length = 3;
@@ -148,6 +154,17 @@ bool Part::NoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
   // velocity filtering can still have a full velocity range
   velocity = ((velocity - midi_.min_velocity) << 7) / (midi_.max_velocity - midi_.min_velocity + 1);
 
+  if (mpe_channel_voices(channel)) {
+    MPENoteOn(channel, note, velocity);
+    return midi_.out_mode == MIDI_OUT_MODE_THRU && !polychained_;
+  }
+  if (mpe_member_channel(channel)) {
+    // Lets VoiceNoteOn bind whichever voice it picks to this member channel
+    mpe_note_on_channel_ = channel;
+    if (mpe_note_[channel] == kNoMPENote) { ++mpe_num_notes_; }
+    mpe_note_[channel] = note;
+  }
+
   if (seq_recording_) {
     if (!looped() && !sent_from_step_editor) {
       RecordStep(SequencerStep(note, velocity));
@@ -163,6 +180,7 @@ bool Part::NoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
       InternalNoteOn(note, velocity);
     }
   }
+  mpe_note_on_channel_ = kNoMPEChannel;
 
   return midi_.out_mode == MIDI_OUT_MODE_THRU && !polychained_;
 }
@@ -170,6 +188,27 @@ bool Part::NoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
 bool Part::NoteOff(uint8_t channel, uint8_t note, bool respect_sustain) {
   bool sent_from_step_editor = channel & 0x80;
 
+  if (mpe_member_channel(channel)) {
+    if (mpe_note_[channel] != note) {
+      // Not the note this finger holds
+      return midi_.out_mode == MIDI_OUT_MODE_THRU && !polychained_;
+    }
+    if (mpe_voiced_channels_ & (1 << channel)) {
+      if (respect_sustain && manual_keys_.universally_sustainable) {
+        mpe_sustained_channels_ |= 1 << channel;
+      } else {
+        MPENoteOff(channel);
+      }
+      return midi_.out_mode == MIDI_OUT_MODE_THRU && !polychained_;
+    }
+    mpe_note_[channel] = kNoMPENote;
+    --mpe_num_notes_;
+    if (MPENoteHeldElsewhere(channel, note)) {
+      // Another finger still holds the pitch
+      return midi_.out_mode == MIDI_OUT_MODE_THRU && !polychained_;
+    }
+  }
+
   uint8_t pressed_key_index = manual_keys_.stack.Find(note);
   if (seq_recording_ && looped() && looper_is_recording(pressed_key_index)) {
     // Directly mapping pitch to looper notes would be cleaner, but requires a
@@ -249,6 +288,13 @@ void Part::ResetAllKeys() {
 }
 
 bool Part::ControlChange(uint8_t channel, uint8_t controller, uint8_t value) {
+  if (mpe_member_channel(channel)) {
+    if (controller == kCCMPETimbre) {
+      mpe_channel_[channel].timbre = value;
+      MPEUpdateVoices(channel);
+    }
+    return midi_.out_mode != MIDI_OUT_MODE_OFF;
+  }
   switch (controller) {
     case kCCBreathController:
     case kCCFootPedalMsb:
@@ -313,8 +359,14 @@ bool Part::ControlChange(uint8_t channel, uint8_t controller, uint8_t value) {
 }
 
 bool Part::PitchBend(uint8_t channel, uint16_t pitch_bend) {
-  for (uint8_t i = 0; i < num_voices_; ++i) {
-    voice_[i]->PitchBend(pitch_bend);
+  if (mpe_member_channel(channel)) {
+    mpe_channel_[channel].pitch_bend = pitch_bend;
+    MPEUpdateVoices(channel);
+  } else {
+    for (uint8_t i = 0; i < num_voices_; ++i) {
+      voice_[i]->PitchBend(pitch_bend);
+    }
+    LooperRecordControl(looper::kControllerPitchBend, pitch_bend);
   }
   
   if (seq_recording_ &&
@@ -326,6 +378,55 @@ bool Part::PitchBend(uint8_t channel, uint16_t pitch_bend) {
   return midi_.out_mode != MIDI_OUT_MODE_OFF;
 }
 
+bool Part::LooperRecordableControl(uint8_t controller) const {
+  switch (controller) {
+    case looper::kControllerPitchBend:
+    case kCCBreathController:
+    case kCCFootPedalMsb:
+      return true;
+  }
+  // Anything else is replayed on every pass through the loop, so it must be a
+  // continuous parameter of the voices. Play mode, oscillator mode, channel
+  // and the like would reset the part each time round.
+  uint8_t setting_index = setting_defs.part_cc_map[controller];
+  if (setting_index == 0xff) { return false; }
+  const Setting& setting = setting_defs.get(setting_index);
+  return setting.domain == SETTING_DOMAIN_PART &&
+      IsVoiceParameter(setting.address[0]) &&
+      setting.unit != SETTING_UNIT_ENUMERATION &&
+      setting.unit != SETTING_UNIT_OSCILLATOR_SHAPE;
+}
+
+void Part::LooperRecordControl(uint8_t controller, uint16_t value) {
+  if (!seq_recording_ || !looped()) { return; }
+  if (!LooperRecordableControl(controller)) { return; }
+  looper_.RecordControl(controller, value);
+}
+
+bool Part::LooperPlayControls(uint8_t* controller, uint8_t* value) {
+  uint16_t played;
+  while (looper_.PopControl(controller, &played)) {
+    if (!looper_in_use()) { continue; }
+    switch (*controller) {
+      case looper::kControllerPitchBend:
+        for (uint8_t i = 0; i < num_voices_; ++i) {
+          voice_[i]->PitchBend(played);
+        }
+        break;
+
+      case kCCBreathController:
+      case kCCFootPedalMsb:
+        ControlChange(tx_channel(), *controller, played);
+        break;
+
+      default:
+        *value = played;
+        return true;
+    }
+  }
+  return false;
+}
+
 bool Part::Aftertouch(uint8_t channel, uint8_t note, uint8_t velocity) {
   if (voicing_.allocation_mode != POLY_MODE_OFF) {
     uint8_t voice_index = \
@@ -342,12 +443,136 @@ bool Part::Aftertouch(uint8_t channel, uint8_t note, uint8_t velocity) {
 }
 
 bool Part::Aftertouch(uint8_t channel, uint8_t velocity) {
-  for (uint8_t i = 0; i < num_voices_; ++i) {
-    voice_[i]->Aftertouch(velocity);
+  if (mpe_member_channel(channel)) {
+    mpe_channel_[channel].pressure = velocity;
+    MPEUpdateVoices(channel);
+  } else {
+    for (uint8_t i = 0; i < num_voices_; ++i) {
+      voice_[i]->Aftertouch(velocity);
+    }
   }
   return midi_.out_mode != MIDI_OUT_MODE_OFF;
 }
 
+void Part::ResetMPE() {
+  for (uint8_t i = 0; i < kNumMIDIChannels; ++i) {
+    mpe_channel_[i].pitch_bend = 8192;
+    mpe_channel_[i].pressure = 0;
+    mpe_channel_[i].timbre = 64;
+    mpe_voice_for_channel_[i] = VOICE_ALLOCATION_NOT_FOUND;
+  }
+  std::fill(
+      &mpe_channel_for_voice_[0],
+      &mpe_channel_for_voice_[kNumMaxVoicesPerPart],
+      kNoMPEChannel);
+  for (uint8_t i = 0; i < num_voices_; ++i) {
+    voice_[i]->NoteExpression(8192, 0, 64);
+  }
+}
+
+void Part::MPEAssignVoice(uint8_t channel, uint8_t voice_index) {
+  // Unbind whatever the channel and the voice were previously bound to, so
+  // that both tables stay one-to-one
+  uint8_t previous_voice = mpe_voice_for_channel_[channel];
+  if (previous_voice < kNumMaxVoicesPerPart) {
+    mpe_channel_for_voice_[previous_voice] = kNoMPEChannel;
+  }
+  uint8_t previous_channel = mpe_channel_for_voice_[voice_index];
+  if (previous_channel != kNoMPEChannel) {
+    mpe_voice_for_channel_[previous_channel] = VOICE_ALLOCATION_NOT_FOUND;
+  }
+  mpe_channel_for_voice_[voice_index] = channel;
+  mpe_voice_for_channel_[channel] = voice_index;
+  MPEUpdateVoices(channel);
+}
+
+bool Part::MPENoteHeldElsewhere(uint8_t channel, uint8_t note) const {
+  for (uint8_t i = 1; i < kNumMIDIChannels; ++i) {
+    if (i != channel && mpe_note_[i] == note) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Part::MPENoteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+  // A member channel carries one note at a time
+  if (mpe_note_[channel] != kNoMPENote) {
+    MPENoteOff(channel);
+  }
+  mpe_note_[channel] = note;
+  mpe_voiced_channels_ |= 1 << channel;
+  ++mpe_num_notes_;
+  if (midi_.out_mode == MIDI_OUT_MODE_GENERATED_EVENTS && !polychained_) {
+    midi_handler.OnInternalNoteOn(tx_channel(), note, velocity);
+  }
+
+  // Free voices in turn, so that released notes ring out; with none free, the
+  // next one in turn is stolen, and the finger it played goes silent
+  uint8_t voice_index = cyclic_allocation_note_counter_ % num_voices_;
+  for (uint8_t i = 0; i < num_voices_; ++i) {
+    uint8_t candidate = (cyclic_allocation_note_counter_ + i) % num_voices_;
+    if (active_note_[candidate] == VOICE_ALLOCATION_NOT_FOUND) {
+      voice_index = candidate;
+      break;
+    }
+  }
+  cyclic_allocation_note_counter_ = voice_index + 1;
+  bool stealing = active_note_[voice_index] != VOICE_ALLOCATION_NOT_FOUND;
+  mpe_note_on_channel_ = channel;
+  VoiceNoteOn(voice_index, note, velocity, stealing, true);
+  mpe_note_on_channel_ = kNoMPEChannel;
+}
+
+void Part::MPENoteOff(uint8_t channel) {
+  uint8_t note = mpe_note_[channel];
+  mpe_note_[channel] = kNoMPENote;
+  mpe_voiced_channels_ &= ~(1 << channel);
+  mpe_sustained_channels_ &= ~(1 << channel);
+  --mpe_num_notes_;
+  if (midi_.out_mode == MIDI_OUT_MODE_GENERATED_EVENTS && !polychained_) {
+    midi_handler.OnInternalNoteOff(tx_channel(), note);
+  }
+  if (voicing_.tuning_system == TUNING_SYSTEM_JUST_INTONATION) {
+    just_intonation_processor.NoteOff(note);
+  }
+  // The voice stays bound to the channel, whose expression shapes its release
+  uint8_t voice_index = mpe_voice_for_channel_[channel];
+  if (voice_index < num_voices_ && active_note_[voice_index] == note) {
+    VoiceNoteOff(voice_index);
+  }
+}
+
+void Part::MPEReleaseSustainedNotes() {
+  for (uint8_t i = 1; i < kNumMIDIChannels; ++i) {
+    if (mpe_sustained_channels_ & (1 << i)) {
+      MPENoteOff(i);
+    }
+  }
+}
+
+void Part::MPEClearNotes() {
+  std::fill(&mpe_note_[0], &mpe_note_[kNumMIDIChannels], kNoMPENote);
+  mpe_voiced_channels_ = 0;
+  mpe_sustained_channels_ = 0;
+  mpe_num_notes_ = 0;
+}
+
+void Part::MPEUpdateVoices(uint8_t channel) {
+  const MPEChannel& c = mpe_channel_[channel];
+  if (voicing_.allocation_mode == POLY_MODE_OFF) {
+    // All voices share the one note, whichever channel it arrived on
+    for (uint8_t i = 0; i < num_voices_; ++i) {
+      voice_[i]->NoteExpression(c.pitch_bend, c.pressure, c.timbre);
+    }
+    return;
+  }
+  uint8_t voice_index = mpe_voice_for_channel_[channel];
+  if (voice_index < num_voices_) {
+    voice_[voice_index]->NoteExpression(c.pitch_bend, c.pressure, c.timbre);
+  }
+}
+
 void Part::Reset() {
   AllNotesOff();
   ResetAllControllers();
@@ -586,6 +811,7 @@ const SequencerStep Part::BuildSeqStep(uint8_t step_index) const {
 
 void Part::ResetAllControllers() {
   ResetAllKeys();
+  ResetMPE();
   for (uint8_t i = 0; i < num_voices_; ++i) {
     voice_[i]->ResetAllControllers();
   }
@@ -594,6 +820,7 @@ void Part::ResetAllControllers() {
 void Part::AllNotesOff() {
   poly_allocator_.ClearNotes();
   mono_allocator_.Clear();
+  MPEClearNotes();
 
   ResetAllKeys();
 
@@ -688,6 +915,16 @@ void Part::VoiceNoteOn(
   active_note_[voice_index] = pitch;
   Voice* voice = voice_[voice_index];
 
+  if (mpe_note_on_channel_ != kNoMPEChannel) {
+    MPEAssignVoice(mpe_note_on_channel_, voice_index);
+  } else if (mpe() && mpe_channel_for_voice_[voice_index] != kNoMPEChannel) {
+    // Generated note: stop steering this voice from its old member channel
+    mpe_voice_for_channel_[mpe_channel_for_voice_[voice_index]] = \
+        VOICE_ALLOCATION_NOT_FOUND;
+    mpe_channel_for_voice_[voice_index] = kNoMPEChannel;
+    voice->NoteExpression(8192, 0, 64);
+  }
+
   int32_t timbre_14 = (voicing_.timbre_mod_envelope << 7) + vel * voicing_.timbre_mod_velocity;
   CONSTRAIN(timbre_14, -1 << 13, (1 << 13) - 1)
   voice->set_timbre_mod_envelope(timbre_14 << 2);
@@ -835,7 +1072,11 @@ void Part::InternalNoteOff(uint8_t note) {
         uses_poly_allocator() ? \
         poly_allocator_.NoteOff(note) : \
         FindVoiceForNote(note);
-    if (voice_index < num_voices_) {
+    if (voice_index < num_voices_ && mpe() &&
+        mpe_channel_for_voice_[voice_index] != kNoMPEChannel &&
+        active_note_[voice_index] != note) {
+      // The voice has since been taken over by a member channel's note
+    } else if (voice_index < num_voices_) {
       VoiceNoteOff(voice_index);
       if (
         had_extra_notes &&
@@ -857,9 +1098,10 @@ void Part::TouchVoiceAllocation() {
 }
 
 void Part::TouchVoices() {
+  voices_touched_ = false;
   CONSTRAIN(voicing_.aux_cv, 0, MOD_AUX_LAST - 1);
   CONSTRAIN(voicing_.aux_cv_2, 0, MOD_AUX_LAST - 1);
-  voice_[0]->garbage(0);
+  if (num_voices_) voice_[0]->garbage(0);
   for (uint8_t i = 0; i < num_voices_; ++i) {
     voice_[i]->set_pitch_bend_range(voicing_.pitch_bend_range);
     voice_[i]->set_vibrato_range(voicing_.vibrato_range);
@@ -875,9 +1117,11 @@ void Part::TouchVoices() {
     voice_[i]->set_aux_cv_2(voicing_.aux_cv_2);
     voice_[i]->set_oscillator_mode(voicing_.oscillator_mode);
     voice_[i]->set_oscillator_shape(voicing_.oscillator_shape);
+    voice_[i]->set_oscillator_quality(voicing_.oscillator_quality);
     voice_[i]->set_tuning(voicing_.tuning_transpose, voicing_.tuning_fine);
     voice_[i]->set_timbre_init(voicing_.timbre_initial);
     voice_[i]->set_timbre_mod_lfo(voicing_.timbre_mod_lfo);
+    voice_[i]->CompileModRoutes();
   }
 }
 
@@ -889,6 +1133,8 @@ bool Part::Set(uint8_t address, uint8_t value) {
   if (value == previous_value) { return false; }
   switch (address) {
     case PART_MIDI_CHANNEL:
+      ResetMPE();
+      // Fall through
     case PART_MIDI_MIN_NOTE:
     case PART_MIDI_MAX_NOTE:
     case PART_MIDI_MIN_VELOCITY:
@@ -925,11 +1171,12 @@ bool Part::Set(uint8_t address, uint8_t value) {
     case PART_VOICING_AUX_CV:
     case PART_VOICING_AUX_CV_2:
     case PART_VOICING_OSCILLATOR_SHAPE:
+    case PART_VOICING_OSCILLATOR_QUALITY:
     case PART_VOICING_TIMBRE_INIT:
     case PART_VOICING_TIMBRE_MOD_LFO:
     case PART_VOICING_TUNING_TRANSPOSE:
     case PART_VOICING_TUNING_FINE:
-      TouchVoices();
+      voices_touched_ = true;
       break;
       
     case PART_SEQUENCER_ARP_DIRECTION:
@@ -951,7 +1198,7 @@ bool Part::Set(uint8_t address, uint8_t value) {
 
     case PART_VOICING_OSCILLATOR_MODE:
       AllNotesOff();
-      TouchVoices();
+      voices_touched_ = true;
       break;
 
     default:
@@ -1006,4 +1253,236 @@ int16_t Part::Tune(int16_t midi_note) {
   return static_cast<int16_t>(scaled_pitch);
 }
 
+const uint8_t kStepCountBits = 7;
+const uint8_t kStepCodeBits = 7;
+const uint8_t kStepCodeHighNote = 125;
+const uint8_t kStepHighNoteBits = 2;
+const uint8_t kStepCodeRest = 126;
+const uint8_t kStepCodeTie = 127;
+const uint8_t kStepVelocityBits = 7;
+const uint8_t kStepRunBits = 6;
+const uint8_t kStepCheckBits = 8;
+const uint16_t kSequencerDataBits = PackedPart::kSequencerDataSize * 8;
+STATIC_ASSERT(kNumSteps <= (1 << kStepRunBits), run_length);
+// A full sequence fits if its notes are below kStepCodeHighNote, unslid, and
+// share one velocity
+STATIC_ASSERT(
+    kStepCountBits + kNumSteps * kStepCodeBits + 1 +
+        kStepVelocityBits + kStepRunBits + 1 + kStepCheckBits <=
+        kSequencerDataBits,
+    steps_fit);
+
+// What the size of a packed stream of steps depends on
+struct StepStreamStats {
+  StepStreamStats(const SequencerStep* step, uint8_t num_steps) {
+    num_notes = num_high_notes = num_runs = 0;
+    slides = false;
+    uint8_t run_velocity = 0xff;
+    for (uint8_t i = 0; i < num_steps; ++i) {
+      if (!step[i].has_note()) { continue; }
+      ++num_notes;
+      if (step[i].note() >= kStepCodeHighNote) {
+        ++num_high_notes;
+      }
+      if (step[i].velocity() != run_velocity) {
+        run_velocity = step[i].velocity();
+        ++num_runs;
+      }
+      slides = slides || step[i].is_slid();
+    }
+    velocity_runs = num_runs * (kStepVelocityBits + kStepRunBits) <
+        num_notes * kStepVelocityBits;
+    bits = kStepCountBits + num_steps * kStepCodeBits +
+        num_high_notes * kStepHighNoteBits + 1 +
+        (velocity_runs ?
+            num_runs * (kStepVelocityBits + kStepRunBits) :
+            num_notes * kStepVelocityBits) +
+        1 + (slides ? num_notes : 0) + kStepCheckBits;
+  }
+
+  uint8_t num_notes;
+  uint8_t num_high_notes;
+  uint8_t num_runs;
+  bool slides;
+  bool velocity_runs;
+  uint16_t bits;
+};
+
+class BitStream {
+ public:
+  BitStream(uint8_t* data) : data_(data), position_(0) { }
+
+  void Write(uint8_t value, uint8_t num_bits) {
+    for (uint8_t i = 0; i < num_bits; ++i, ++position_) {
+      uint8_t mask = 1 << (position_ & 7);
+      if ((value >> i) & 1) {
+        data_[position_ >> 3] |= mask;
+      } else {
+        data_[position_ >> 3] &= ~mask;
+      }
+    }
+  }
+
+  // Reads past the end of the data return zeros, see overflow()
+  uint8_t Read(uint8_t num_bits) {
+    uint8_t value = 0;
+    for (uint8_t i = 0; i < num_bits; ++i, ++position_) {
+      if (position_ < kSequencerDataBits &&
+          data_[position_ >> 3] & (1 << (position_ & 7))) {
+        value |= 1 << i;
+      }
+    }
+    return value;
+  }
+
+  // Hash of everything before the current position
+  uint8_t Checksum() const {
+    uint16_t end = min(position_, kSequencerDataBits);
+    uint8_t hash = 0xa5;
+    for (uint16_t i = 0; i < end; i += 8) {
+      uint8_t byte = data_[i >> 3];
+      if (end - i < 8) {
+        byte &= (1 << (end - i)) - 1;
+      }
+      hash = ((hash << 1) | (hash >> 7)) ^ byte;
+    }
+    return hash;
+  }
+
+  inline bool overflow() const { return position_ > kSequencerDataBits; }
+
+ private:
+  uint8_t* data_;
+  uint16_t position_;
+};
+
+/* static */
+void SequencerSettings::PackSteps(
+    const SequencerStep* step, uint8_t num_steps, uint8_t* data) {
+  // Step count, then a 7-bit code per step: notes up to 124, rest, tie, or an
+  // escape followed by 2 bits for notes 125 to 127. The velocities of the
+  // notes follow, 7 bits each or as runs of equal velocities, whichever is
+  // shorter; then an optional bitmap of slid notes, and a checksum that tells
+  // the stream from the older fixed-size steps. Every step is stored exactly,
+  // so a sequence that does not fit is cut to the steps that do.
+  while (StepStreamStats(step, num_steps).bits > kSequencerDataBits) {
+    --num_steps;
+  }
+  StepStreamStats stats(step, num_steps);
+
+  BitStream stream(data);
+  stream.Write(num_steps, kStepCountBits);
+  for (uint8_t i = 0; i < num_steps; ++i) {
+    if (step[i].is_rest()) {
+      stream.Write(kStepCodeRest, kStepCodeBits);
+    } else if (step[i].is_tie()) {
+      stream.Write(kStepCodeTie, kStepCodeBits);
+    } else if (step[i].note() >= kStepCodeHighNote) {
+      stream.Write(kStepCodeHighNote, kStepCodeBits);
+      stream.Write(step[i].note() - kStepCodeHighNote, kStepHighNoteBits);
+    } else {
+      stream.Write(step[i].note(), kStepCodeBits);
+    }
+  }
+  stream.Write(stats.velocity_runs, 1);
+  uint8_t run_length = 0;
+  for (uint8_t i = 0; i < num_steps; ++i) {
+    if (!step[i].has_note()) { continue; }
+    if (!stats.velocity_runs) {
+      stream.Write(step[i].velocity(), kStepVelocityBits);
+      continue;
+    }
+    if (!run_length) {
+      // Measure the run starting here
+      stream.Write(step[i].velocity(), kStepVelocityBits);
+      for (uint8_t j = i; j < num_steps; ++j) {
+        if (!step[j].has_note()) { continue; }
+        if (step[j].velocity() != step[i].velocity()) { break; }
+        ++run_length;
+      }
+      stream.Write(run_length - 1, kStepRunBits);
+    }
+    --run_length;
+  }
+  stream.Write(stats.slides, 1);
+  if (stats.slides) {
+    for (uint8_t i = 0; i < num_steps; ++i) {
+      if (!step[i].has_note()) { continue; }
+      stream.Write(step[i].is_slid(), 1);
+    }
+  }
+  stream.Write(stream.Checksum(), kStepCheckBits);
+}
+
+/* static */
+bool SequencerSettings::UnpackSteps(
+    const uint8_t* data, SequencerStep* step, uint8_t* num_steps) {
+  BitStream stream(const_cast<uint8_t*>(data));
+  uint8_t count = stream.Read(kStepCountBits);
+  bool valid = count <= kNumSteps;
+  count = min(count, kNumSteps);
+  for (uint8_t i = 0; i < count; ++i) {
+    uint8_t code = stream.Read(kStepCodeBits);
+    if (code == kStepCodeRest) {
+      step[i] = SequencerStep(SEQUENCER_STEP_REST, 0);
+    } else if (code == kStepCodeTie) {
+      step[i] = SequencerStep(SEQUENCER_STEP_TIE, 0);
+    } else if (code == kStepCodeHighNote) {
+      uint8_t note = code + stream.Read(kStepHighNoteBits);
+      valid = valid && note <= 0x7f;
+      step[i] = SequencerStep(min(note, static_cast<uint8_t>(0x7f)), 0);
+    } else {
+      step[i] = SequencerStep(code, 0);
+    }
+  }
+  bool velocity_runs = stream.Read(1);
+  uint8_t run_length = 0;
+  uint8_t velocity = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    if (!step[i].has_note()) { continue; }
+    if (!velocity_runs || !run_length) {
+      velocity = stream.Read(kStepVelocityBits);
+      run_length = velocity_runs ? stream.Read(kStepRunBits) + 1 : 1;
+    }
+    step[i].data[1] = velocity;
+    --run_length;
+  }
+  // A run may not reach past the last note
+  valid = valid && !run_length;
+  if (stream.Read(1)) {
+    for (uint8_t i = 0; i < count; ++i) {
+      if (!step[i].has_note()) { continue; }
+      step[i].data[1] |= stream.Read(1) << 7;
+    }
+  }
+  uint8_t checksum = stream.Checksum();
+  valid = valid && stream.Read(kStepCheckBits) == checksum &&
+      !stream.overflow();
+  for (uint8_t i = count; i < kNumSteps; ++i) {
+    step[i] = SequencerStep(SEQUENCER_STEP_REST, 0);
+  }
+  *num_steps = count;
+  return valid;
+}
+
+/* static */
+bool SequencerSettings::ValidSteps(const PackedPart& packed) {
+  SequencerStep step[kNumSteps];
+  uint8_t num_steps;
+  return UnpackSteps(packed.sequencer_data, step, &num_steps);
+}
+
+/* static */
+void SequencerSettings::MigrateLegacySteps(PackedPart& packed) {
+  const uint8_t kNumLegacySteps = 30;
+  SequencerStep step[kNumLegacySteps];
+  for (uint8_t i = 0; i < kNumLegacySteps; ++i) {
+    step[i] = SequencerStep(
+        packed.sequencer_data[i * 2], packed.sequencer_data[i * 2 + 1]);
+  }
+  uint8_t num_steps = min(
+      static_cast<uint8_t>(packed.legacy_num_steps), kNumLegacySteps);
+  PackSteps(step, num_steps, packed.sequencer_data);
+}
+
 }  // namespace yarns
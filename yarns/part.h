@@ -38,6 +38,7 @@
 
 #include "yarns/resources.h"
 #include "yarns/looper.h"
+#include "yarns/oscillator.h"
 #include "yarns/sequencer_step.h"
 #include "yarns/arpeggiator.h"
 
@@ -45,13 +46,22 @@ namespace yarns {
 
 class Voice;
 
-const uint8_t kNumSteps = 30;
+// 2 bytes each in RAM, so 64 steps take 68 bytes more per part than the 30
+// of older firmware, 272 bytes in all
+const uint8_t kNumSteps = 64;
 const uint8_t kNumMaxVoicesPerPart = 4;
 const uint8_t kNumParaphonicVoices = 3;
 const uint8_t kNoteStackSize = 12;
 const uint8_t kNoteStackMapping = kNoteStackSize + 1; // 1-based
 
 const uint8_t kMidiChannelOmni = 0x10;
+// MPE lower zone: channel 1 is the master channel, and each of channels 2-16
+// carries a single note with its own bend, pressure, and CC74
+const uint8_t kMidiChannelMPE = 0x11;
+const uint8_t kNumMIDIChannels = 16;
+const uint8_t kNoMPEChannel = 0xff;
+const uint8_t kNoMPENote = 0xff;
+const uint8_t kCCMPETimbre = 74;
 
 const uint8_t kCCRecordOffOn = 110;
 const uint8_t kCCDeleteRecording = 111;
@@ -148,14 +158,12 @@ struct SequencerArpeggiatorResult { // Supports multiple return
 };
 
 struct PackedPart {
-  // Currently has 7 bits to spare
+  // Currently has 5 bits to spare
 
-  struct PackedSequencerStep {
-    unsigned int
-      pitch : 8, // values free: 126 (about 29 bits' worth across 30 steps)
-      velocity: 8; // values free: 0
-  }__attribute__((packed));
-  PackedSequencerStep sequencer_steps[kNumSteps];
+  // Bit stream of steps, see SequencerSettings::PackSteps. Before
+  // kPackedMultiVersion, this held 30 x {pitch byte, velocity byte}.
+  static const uint8_t kSequencerDataSize = 60;
+  uint8_t sequencer_data[kSequencerDataSize];
 
   looper::PackedNote looper_notes[looper::kMaxNotes];
   unsigned int
@@ -183,7 +191,7 @@ struct PackedPart {
 
   // MidiSettings
   unsigned int
-    channel : 5, // values free: 15
+    channel : 5, // values free: 14
     min_note : 7,
     max_note : 7,
     min_velocity : 7,
@@ -214,6 +222,7 @@ struct PackedPart {
     tuning_factor : 4, // values free: 2
     oscillator_mode : 2, // values free: 1
     oscillator_shape : 7, // Breaking: 1 bit unused
+    oscillator_quality : 2, // values free: 1
     tremolo_mod : kTimbreBits,
     vibrato_shape : kLFOShapeBits,
     timbre_lfo_shape : kLFOShapeBits,
@@ -235,7 +244,7 @@ struct PackedPart {
     euclidean_length : 5, // values free: 0
     euclidean_fill : 5, // values free: 0
     euclidean_rotate : 5, // values free: 0
-    num_steps : 5, // values free: 1
+    legacy_num_steps : 5, // Only read when migrating old presets
     clock_quantization : 1,
     loop_length : 3; // values free: 0
 
@@ -325,7 +334,8 @@ struct VoicingSettings {
   int8_t env_mod_decay;
   int8_t env_mod_sustain;
   int8_t env_mod_release;
-  // uint8_t padding[-2];
+  uint8_t oscillator_quality;
+  // uint8_t padding[-3];
 
   void Pack(PackedPart& packed) const {
     packed.allocation_mode = allocation_mode;
@@ -367,6 +377,7 @@ struct VoicingSettings {
     packed.env_mod_decay = env_mod_decay;
     packed.env_mod_sustain = env_mod_sustain;
     packed.env_mod_release = env_mod_release;
+    packed.oscillator_quality = oscillator_quality;
   }
 
   void Unpack(PackedPart& packed) {
@@ -409,6 +420,7 @@ struct VoicingSettings {
     env_mod_decay = packed.env_mod_decay;
     env_mod_sustain = packed.env_mod_sustain;
     env_mod_release = packed.env_mod_release;
+    oscillator_quality = packed.oscillator_quality;
   }
 
 };
@@ -466,6 +478,7 @@ enum PartSetting {
   PART_VOICING_ENV_MOD_DECAY,
   PART_VOICING_ENV_MOD_SUSTAIN,
   PART_VOICING_ENV_MOD_RELEASE,
+  PART_VOICING_OSCILLATOR_QUALITY,
   PART_VOICING_LAST = PART_VOICING_ALLOCATION_MODE + sizeof(VoicingSettings) - 1,
   PART_SEQUENCER_CLOCK_DIVISION,
   PART_SEQUENCER_GATE_LENGTH,
@@ -496,14 +509,17 @@ struct SequencerSettings {
   uint8_t padding_fields[5];
 
   SequencerStep step[kNumSteps];
-  uint8_t padding_steps[2];
+
+  static void PackSteps(
+      const SequencerStep* step, uint8_t num_steps, uint8_t* data);
+  // Returns false if the data is not a stream written by PackSteps
+  static bool UnpackSteps(
+      const uint8_t* data, SequencerStep* step, uint8_t* num_steps);
+  static bool ValidSteps(const PackedPart& packed);
+  static void MigrateLegacySteps(PackedPart& packed);
 
   void Pack(PackedPart& packed) const {
-    for (uint8_t i = 0; i < kNumSteps; i++) {
-      PackedPart::PackedSequencerStep& packed_step = packed.sequencer_steps[i];
-      packed_step.pitch = step[i].data[0];
-      packed_step.velocity = step[i].data[1];
-    }
+    PackSteps(step, num_steps, packed.sequencer_data);
 
     packed.clock_division = clock_division;
     packed.gate_length = gate_length;
@@ -513,17 +529,13 @@ struct SequencerSettings {
     packed.euclidean_length = euclidean_length;
     packed.euclidean_fill = euclidean_fill;
     packed.euclidean_rotate = euclidean_rotate;
-    packed.num_steps = num_steps;
+    packed.legacy_num_steps = 0;
     packed.clock_quantization = clock_quantization;
     packed.loop_length = loop_length;
   }
 
   void Unpack(PackedPart& packed) {
-    for (uint8_t i = 0; i < kNumSteps; i++) {
-      PackedPart::PackedSequencerStep& packed_step = packed.sequencer_steps[i];
-      step[i].data[0] = packed_step.pitch;
-      step[i].data[1] = packed_step.velocity;
-    }
+    UnpackSteps(packed.sequencer_data, step, &num_steps);
 
     clock_division = packed.clock_division;
     gate_length = packed.gate_length;
@@ -533,7 +545,6 @@ struct SequencerSettings {
     euclidean_length = packed.euclidean_length;
     euclidean_fill = packed.euclidean_fill;
     euclidean_rotate = packed.euclidean_rotate;
-    num_steps = packed.num_steps;
     clock_quantization = packed.clock_quantization;
     loop_length = packed.loop_length;
   }
@@ -807,6 +818,12 @@ class Part {
     LooperPlayNoteOn(looper_note_index, e.note, e.velocity & 0x7f);
   }
 
+  bool LooperRecordableControl(uint8_t controller) const;
+  void LooperRecordControl(uint8_t controller, uint16_t value);
+  // Plays what the looper's lanes passed over. The CCs that map to settings
+  // are handed back one per call, for the multi to apply.
+  bool LooperPlayControls(uint8_t* controller, uint8_t* value);
+
   inline void LooperRecordNoteOff(uint8_t pressed_key_index) {
     const stmlib::NoteEntry& e = manual_keys_.stack.note(pressed_key_index);
     uint8_t looper_note_index = looper_note_recording_pressed_key_[pressed_key_index];
@@ -825,6 +842,7 @@ class Part {
   inline void SustainOff() {
     HeldKeysSustainOff(manual_keys_);
     HeldKeysSustainOff(arp_keys_);
+    MPEReleaseSustainedNotes();
   }
   void HeldKeysSustainOn(HeldKeys &keys);
   void HeldKeysSustainOff(HeldKeys &keys);
@@ -884,7 +902,11 @@ class Part {
   }
   
   inline uint8_t tx_channel() const {
-    return midi_.channel == kMidiChannelOmni ? 0 : midi_.channel;
+    return midi_.channel >= kMidiChannelOmni ? 0 : midi_.channel;
+  }
+  inline bool mpe() const { return midi_.channel == kMidiChannelMPE; }
+  inline bool mpe_member_channel(uint8_t channel) const {
+    return mpe() && channel != 0;
   }
   inline bool direct_thru() const {
     return midi_.out_mode == MIDI_OUT_MODE_THRU && !polychained_;
@@ -920,6 +942,47 @@ class Part {
   inline uint8_t num_voices() const { return num_voices_; }
   
   bool Set(uint8_t address, uint8_t value);
+  // Settings that only shape the sound of the voices, with no effect on note
+  // handling
+  static inline bool IsVoiceParameter(uint8_t address) {
+    switch (address) {
+      case PART_VOICING_PORTAMENTO:
+      case PART_VOICING_PITCH_BEND_RANGE:
+      case PART_VOICING_VIBRATO_RANGE:
+      case PART_VOICING_VIBRATO_MOD:
+      case PART_VOICING_TREMOLO_MOD:
+      case PART_VOICING_VIBRATO_SHAPE:
+      case PART_VOICING_TIMBRE_LFO_SHAPE:
+      case PART_VOICING_TREMOLO_SHAPE:
+      case PART_VOICING_LFO_RATE:
+      case PART_VOICING_LFO_SPREAD_TYPES:
+      case PART_VOICING_LFO_SPREAD_VOICES:
+      case PART_VOICING_TUNING_TRANSPOSE:
+      case PART_VOICING_TUNING_FINE:
+      case PART_VOICING_TRIGGER_DURATION:
+      case PART_VOICING_TRIGGER_SCALE:
+      case PART_VOICING_TRIGGER_SHAPE:
+      case PART_VOICING_AUX_CV:
+      case PART_VOICING_AUX_CV_2:
+      case PART_VOICING_OSCILLATOR_SHAPE:
+      case PART_VOICING_TIMBRE_INIT:
+      case PART_VOICING_TIMBRE_MOD_LFO:
+      case PART_VOICING_TIMBRE_MOD_ENVELOPE:
+      case PART_VOICING_TIMBRE_MOD_VELOCITY:
+      case PART_VOICING_ENV_PEAK_MOD_VELOCITY:
+      case PART_VOICING_ENV_INIT_ATTACK:
+      case PART_VOICING_ENV_INIT_DECAY:
+      case PART_VOICING_ENV_INIT_SUSTAIN:
+      case PART_VOICING_ENV_INIT_RELEASE:
+      case PART_VOICING_ENV_MOD_ATTACK:
+      case PART_VOICING_ENV_MOD_DECAY:
+      case PART_VOICING_ENV_MOD_SUSTAIN:
+      case PART_VOICING_ENV_MOD_RELEASE:
+        return true;
+      default:
+        return false;
+    }
+  }
   inline uint8_t Get(uint8_t address) const {
     const uint8_t* bytes;
     bytes = static_cast<const uint8_t*>(static_cast<const void*>(&midi_));
@@ -935,7 +998,8 @@ class Part {
 
   inline bool has_notes() const {
     return arp_keys_.stack.most_recent_note_index() ||
-      manual_keys_.stack.most_recent_note_index();
+      manual_keys_.stack.most_recent_note_index() ||
+      mpe_num_notes_;
   }
   
   inline bool recording() const { return seq_recording_; }
@@ -955,32 +1019,71 @@ class Part {
     seq_.Pack(packed);
   }
 
-  void Unpack(PackedPart& packed) {
+  // Returns whether the notes held under the previous settings can still be
+  // released normally, i.e. they arrive on the same channel and allocator
+  bool Unpack(PackedPart& packed) {
+    uint8_t channel = midi_.channel;
+    uint8_t play_mode = midi_.play_mode;
+    uint8_t allocation_mode = voicing_.allocation_mode;
     looper_.Unpack(packed);
     midi_.Unpack(packed);
     voicing_.Unpack(packed);
     seq_.Unpack(packed);
+    return midi_.channel == channel && midi_.play_mode == play_mode &&
+        voicing_.allocation_mode == allocation_mode;
   }
   
   void AfterDeserialize() {
-    CONSTRAIN(midi_.play_mode, 0, PLAY_MODE_LAST - 1);
-    CONSTRAIN(seq_.clock_quantization, 0, 1);
-    CONSTRAIN(seq_.loop_length, 0, 7);
-    CONSTRAIN(seq_.arp_range, 0, 3);
-    CONSTRAIN(seq_.arp_direction, 0, ARPEGGIATOR_DIRECTION_LAST - 1);
+    ConstrainDeserializedSettings();
     AllNotesOff();
     TouchVoices();
     TouchVoiceAllocation();
     ResetAllKeys();
   }
 
+  // Program change on the fly: held notes and allocator state carry over
+  void AfterSeamlessDeserialize() {
+    ConstrainDeserializedSettings();
+    voices_touched_ = true;
+  }
+
   void set_siblings(bool has_siblings) {
     has_siblings_ = has_siblings;
   }
+
+  // Set defers voice parameter updates; they are pushed to the voices here,
+  // at most once per refresh
+  inline void TouchVoicesIfNeeded() {
+    if (voices_touched_) { TouchVoices(); }
+  }
   
  private:
+  void ConstrainDeserializedSettings() {
+    CONSTRAIN(midi_.play_mode, 0, PLAY_MODE_LAST - 1);
+    CONSTRAIN(seq_.clock_quantization, 0, 1);
+    CONSTRAIN(seq_.loop_length, 0, 7);
+    CONSTRAIN(seq_.arp_range, 0, 3);
+    CONSTRAIN(seq_.arp_direction, 0, ARPEGGIATOR_DIRECTION_LAST - 1);
+    CONSTRAIN(voicing_.oscillator_quality, 0, OSCILLATOR_QUALITY_LAST - 1);
+  }
   int16_t Tune(int16_t note);
   void ResetAllControllers();
+  void ResetMPE();
+  // MPE notes are keyed by member channel, so that two fingers on the same
+  // pitch get a voice each, when the part plays one voice per note
+  inline bool mpe_channel_voices(uint8_t channel) const {
+    return mpe_member_channel(channel) &&
+        midi_.play_mode == PLAY_MODE_MANUAL && !seq_recording_ &&
+        voicing_.allocation_mode != POLY_MODE_OFF && !uses_sorted_dispatch();
+  }
+  // Whether another member channel holds this pitch
+  bool MPENoteHeldElsewhere(uint8_t channel, uint8_t note) const;
+  void MPENoteOn(uint8_t channel, uint8_t note, uint8_t velocity);
+  void MPENoteOff(uint8_t channel);
+  void MPEReleaseSustainedNotes();
+  void MPEClearNotes();
+  void MPEAssignVoice(uint8_t channel, uint8_t voice_index);
+  void MPEUpdateVoices(uint8_t channel);
   void TouchVoiceAllocation();
   void TouchVoices();
   
@@ -1012,6 +1115,25 @@ class Part {
   int8_t* custom_pitch_table_;
   uint8_t num_voices_;
   bool polychained_;
+  bool voices_touched_;
+
+  // Per-note expression last received on each MPE member channel, and the
+  // voice currently sounding that channel's note
+  struct MPEChannel {
+    uint16_t pitch_bend;
+    uint8_t pressure;
+    uint8_t timbre;
+  };
+  MPEChannel mpe_channel_[kNumMIDIChannels];
+  uint8_t mpe_voice_for_channel_[kNumMIDIChannels];
+  uint8_t mpe_channel_for_voice_[kNumMaxVoicesPerPart];
+  uint8_t mpe_note_on_channel_;
+  // Pitch held on each member channel, the channels whose note has a voice of
+  // its own, and those whose note is only held by the pedal
+  uint8_t mpe_note_[kNumMIDIChannels];
+  uint16_t mpe_voiced_channels_;
+  uint16_t mpe_sustained_channels_;
+  uint8_t mpe_num_notes_;
 
   HeldKeys manual_keys_;
   HeldKeys arp_keys_;
@@ -102,6 +102,10 @@ const char* const voicing_oscillator_mode_values[OSCILLATOR_MODE_LAST] = {
   "OFF", "DRONE", "ENVELOPED"
 };
 
+const char* const voicing_oscillator_quality_values[OSCILLATOR_QUALITY_LAST] = {
+  "STANDARD", "LITE", "OVERSAMPLED"
+};
+
 const char* const voicing_oscillator_shape_values[OSC_SHAPE_FM] = {
   "*\xA2 NOISE NOTCH SVF",
   "*\xA0 NOISE LOW-PASS SVF",
@@ -316,7 +320,7 @@ const Setting Settings::settings_[] = {
   {
     "CH", "CHANNEL",
     SETTING_DOMAIN_PART, { PART_MIDI_CHANNEL, 0 },
-    SETTING_UNIT_MIDI_CHANNEL_LAST_OMNI, 0, 16, NULL,
+    SETTING_UNIT_MIDI_CHANNEL_LAST_OMNI, 0, kMidiChannelMPE, NULL,
     0xff, 4,
   },
   {
@@ -516,7 +520,7 @@ const Setting Settings::settings_[] = {
   {
     "OS", "OSC SHAPE",
     SETTING_DOMAIN_PART, { PART_VOICING_OSCILLATOR_SHAPE, 0 },
-    SETTING_UNIT_OSCILLATOR_SHAPE, 0, OSC_SHAPE_FM + LUT_FM_RATIO_NAMES_SIZE - 1, NULL,
+    SETTING_UNIT_OSCILLATOR_SHAPE, 0, OSC_SHAPE_FM_LAST, NULL,
     71, 23,
   },
   {
@@ -700,6 +704,13 @@ const Setting Settings::settings_[] = {
     SETTING_UNIT_ENUMERATION, 0, 13,
     tuning_factor_values,
     0xff, 0xff,
+  },
+  {
+    "OQ", "OSC QUALITY",
+    SETTING_DOMAIN_PART, { PART_VOICING_OSCILLATOR_QUALITY, 0 },
+    SETTING_UNIT_ENUMERATION, 0, OSCILLATOR_QUALITY_LAST - 1,
+    voicing_oscillator_quality_values,
+    0xff, 0xff,
   }
 };
 
@@ -756,6 +767,8 @@ void Settings::Print(const Setting& setting, uint8_t value, char* buffer) const
     case SETTING_UNIT_MIDI_CHANNEL_LAST_OMNI:
       if (value == kMidiChannelOmni) {
         strcpy(buffer, "ALL");
+      } else if (value == kMidiChannelMPE) {
+        strcpy(buffer, "MPE");
       } else {
         PrintInteger(buffer, value + 1);
       }
@@ -137,6 +137,7 @@ enum SettingIndex {
   SETTING_MIDI_SUSTAIN_POLARITY,
   SETTING_REMOTE_CONTROL_CHANNEL,
   SETTING_VOICING_TUNING_FACTOR,
+  SETTING_VOICING_OSCILLATOR_QUALITY,
 
   SETTING_LAST,
 };
@@ -0,0 +1,181 @@
+#!/usr/bin/python2.5
+#
+# Copyright 2020 Chris Rogers.
+#
+# Author: Chris Rogers (teukros@gmail.com)
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+# 
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+# 
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+# 
+# See http://creativecommons.org/licenses/MIT/ for more information.
+#
+# -----------------------------------------------------------------------------
+#
+# Converts a Standard MIDI File into a song table for the song player, or into
+# a SysEx dump that uploads it to the module.
+#
+# MIDI channels 1 to 4 play parts 1 to 4; other channels are ignored. Time is
+# resampled to the module's 24 ticks per quarter note, and the song loops
+# after its last event (or after --length ticks).
+#
+# Usage: python smf_to_song.py song.mid > song.h
+#        python smf_to_song.py --syx --tempo 100 song.mid > song.syx
+
+import optparse
+import sys
+
+sys.path.append('.')
+
+from tools.midi import midifile
+
+
+TICKS_PER_QUARTER_NOTE = 24
+NUM_PARTS = 4
+MAX_DELTA = 255
+MAX_LENGTH = 255
+
+SYSEX_HEADER = [0xf0, 0x00, 0x21, 0x02, 0x00, 0x0b]
+SYSEX_COMMAND_SONG_PACKET = 36
+SYSEX_MAX_CHUNK_SIZE = 64
+# One flash page, less its checksum and the song header
+MAX_UPLOADED_EVENTS = (1024 - 2 - 8) // 4
+
+
+def ReadNotes(reader):
+  """Returns (start, part, note, velocity, end) tuples, in MIDI file ticks."""
+  notes = []
+  for track in reader.tracks:
+    held = {}
+    for t, e in track:
+      if not isinstance(e, (midifile.NoteOnEvent, midifile.NoteOffEvent)):
+        continue
+      part = e.channel - 1
+      if part >= NUM_PARTS:
+        continue
+      key = (part, e.note)
+      if key in held:
+        start, velocity = held.pop(key)
+        notes.append((start, part, e.note, velocity, t))
+      if isinstance(e, midifile.NoteOnEvent) and e.velocity:
+        held[key] = (t, e.velocity)
+  return sorted(notes)
+
+
+def Convert(notes, ppq, song_length=None):
+  """Returns the song as (delta, length, part, note, velocity) events."""
+  scale = float(TICKS_PER_QUARTER_NOTE) / ppq
+  events = []
+  previous = 0
+  end = 0
+  for start, part, note, velocity, stop in notes:
+    start = int(round(start * scale))
+    length = max(1, min(MAX_LENGTH, int(round(stop * scale)) - start))
+    end = max(end, start + length)
+    delta = start - previous
+    while delta > MAX_DELTA:
+      # Spacer: no note, only moves time forward
+      events.append((MAX_DELTA, 0, 0, 0, 0))
+      delta -= MAX_DELTA
+    events.append((delta, length, part, note, velocity))
+    previous = start
+  # End of song marker, placed where the loop restarts
+  if song_length:
+    end = song_length
+  delta = max(1, end - previous)
+  while delta > MAX_DELTA:
+    events.append((MAX_DELTA, 0, 0, 0, 0))
+    delta -= MAX_DELTA
+  events.append((delta, 0, 0, 0, 0))
+  return events
+
+
+def Write(events, f):
+  f.write('// delta, length, part, note, velocity\n')
+  for event in events:
+    f.write('  { %d, %d, %d, %d, %d },\n' % event)
+
+
+def PackSong(events, tempo, shapes):
+  """Returns the song as stored in flash: PackedSongHeader, then SongEvents."""
+  data = [len(events) & 0xff, len(events) >> 8, tempo] + shapes + [0]
+  for delta, length, part, note, velocity in events:
+    word = part | (note << 2) | (velocity << 9)
+    data += [delta, length, word & 0xff, word >> 8]
+  return data
+
+
+def WriteSysEx(data, f):
+  """Writes packets in the format of MidiHandler::SysExSendPackets."""
+  chunks = [data[i:i + SYSEX_MAX_CHUNK_SIZE]
+      for i in range(0, len(data), SYSEX_MAX_CHUNK_SIZE)]
+  for index, chunk in enumerate(chunks + [[]]):
+    packet = SYSEX_HEADER + [SYSEX_COMMAND_SONG_PACKET, index]
+    for byte in chunk + [sum(chunk) & 0xff]:
+      packet += [byte >> 4, byte & 0x0f]
+    packet.append(0xf7)
+    f.write(bytearray(packet))
+
+
+def main(options, args):
+  reader = midifile.Reader()
+  reader.Read(open(args[0], 'rb'))
+  events = Convert(ReadNotes(reader), reader.ppq, options.length)
+  if options.syx:
+    if len(events) > MAX_UPLOADED_EVENTS:
+      sys.exit('%d events, the module keeps %d' % (
+          len(events), MAX_UPLOADED_EVENTS))
+    shapes = [int(s) for s in options.shapes.split(',')]
+    data = PackSong(events, options.tempo, shapes)
+    WriteSysEx(data, getattr(sys.stdout, 'buffer', sys.stdout))
+  else:
+    Write(events, sys.stdout)
+
+
+if __name__ == '__main__':
+  parser = optparse.OptionParser()
+  parser.add_option(
+      '-l',
+      '--length',
+      dest='length',
+      type='int',
+      default=None,
+      help='Loop length in ticks (24 per quarter note)')
+  parser.add_option(
+      '-s',
+      '--syx',
+      dest='syx',
+      action='store_true',
+      default=False,
+      help='Write a SysEx dump that uploads the song')
+  parser.add_option(
+      '-t',
+      '--tempo',
+      dest='tempo',
+      type='int',
+      default=120,
+      help='Tempo of the uploaded song, in BPM')
+  parser.add_option(
+      '-o',
+      '--shapes',
+      dest='shapes',
+      default='13,13,8,3',
+      help='Oscillator shape of each part in the uploaded song')
+  options, args = parser.parse_args()
+  if len(args) != 1:
+    parser.error('Expected one MIDI file')
+  main(options, args)
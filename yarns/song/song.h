@@ -1,2336 +1,850 @@
-  52,
-  111,
-  144,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  52,
-  128,
-  156,
-  210,
-  254, 
-  0,
-  50,
-  192,
-  210,
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  149,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  161,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  148,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  160,
-  210,
-  254, 
-  254, 
-  64,
-  108,
-  128,
-  148,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  160,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  128,
-  151,
-  192,
-  210,
-  254, 
-  254, 
-  128,
-  152,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  154,
-  192,
-  254, 
-  254, 
-  50,
-  105,
-  128,
-  142,
-  210,
-  254, 
-  254, 
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  53,
-  64,
-  109,
-  142,
-  210,
-  254, 
-  254, 
-  0,
-  57,
-  64,
-  112,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  112,
-  142,
-  210,
-  254, 
-  64,
-  112,
-  192,
-  210,
-  254, 
-  0,
-  55,
-  64,
-  111,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  0,
-  53,
-  64,
-  109,
-  128,
-  145,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  107,
-  128,
-  140,
-  192,
-  254, 
-  254, 
-  128,
-  152,
-  210,
-  254, 
-  254, 
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  104,
-  152,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  107,
-  128,
-  140,
-  192,
-  254, 
-  254, 
-  64,
-  109,
-  128,
-  147,
-  210,
-  254, 
-  64,
-  107,
-  254, 
-  0,
-  50,
-  64,
-  105,
-  128,
-  147,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  104,
-  128,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  151,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  163,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  163,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  108,
-  156,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  108,
-  160,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  192,
-  210,
-  254, 
-  254, 
-  192,
-  210,
-  254, 
-  254, 
-  52,
-  111,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  52,
-  128,
-  156,
-  210,
-  254, 
-  0,
-  50,
-  192,
-  210,
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  149,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  161,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  148,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  160,
-  210,
-  254, 
-  254, 
-  64,
-  108,
-  128,
-  148,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  160,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  128,
-  151,
-  192,
-  210,
-  254, 
-  254, 
-  128,
-  152,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  154,
-  192,
-  254, 
-  254, 
-  50,
-  105,
-  128,
-  142,
-  210,
-  254, 
-  254, 
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  53,
-  64,
-  109,
-  142,
-  210,
-  254, 
-  254, 
-  0,
-  57,
-  64,
-  112,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  112,
-  142,
-  210,
-  254, 
-  64,
-  112,
-  192,
-  210,
-  254, 
-  0,
-  55,
-  64,
-  111,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  0,
-  53,
-  64,
-  109,
-  128,
-  145,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  107,
-  128,
-  140,
-  192,
-  254, 
-  254, 
-  128,
-  152,
-  210,
-  254, 
-  254, 
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  104,
-  152,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  107,
-  128,
-  140,
-  192,
-  254, 
-  254, 
-  64,
-  109,
-  128,
-  147,
-  210,
-  254, 
-  64,
-  107,
-  254, 
-  0,
-  50,
-  64,
-  105,
-  128,
-  147,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  104,
-  128,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  151,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  163,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  163,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  108,
-  156,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  108,
-  160,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  192,
-  210,
-  254, 
-  254, 
-  192,
-  210,
-  254, 
-  254, 
-  40,
-  100,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  36,
-  64,
-  97,
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  38,
-  64,
-  99,
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  35,
-  64,
-  96,
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  160,
-  192,
-  210,
-  254, 
-  254, 
-  128,
-  168,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  36,
-  64,
-  97,
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  33,
-  64,
-  92,
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  32,
-  64,
-  92,
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  35,
-  64,
-  96,
-  128,
-  192,
-  254, 
-  254, 
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  192,
-  210,
-  254, 
-  254, 
-  192,
-  210,
-  254, 
-  254, 
-  40,
-  100,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  36,
-  64,
-  97,
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  38,
-  64,
-  99,
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  35,
-  64,
-  96,
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  160,
-  192,
-  210,
-  254, 
-  254, 
-  128,
-  168,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  36,
-  64,
-  97,
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  40,
-  64,
-  100,
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  128,
-  161,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  44,
-  64,
-  102,
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  128,
-  160,
-  192,
-  254, 
-  254, 
-  128,
-  168,
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  192,
-  254, 
-  254, 
-  210,
-  254, 
-  254, 
-  192,
-  210,
-  254, 
-  254, 
-  192,
-  210,
-  254, 
-  254, 
-  52,
-  111,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  52,
-  128,
-  156,
-  210,
-  254, 
-  0,
-  50,
-  192,
-  210,
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  149,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  161,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  148,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  160,
-  210,
-  254, 
-  254, 
-  64,
-  108,
-  128,
-  148,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  160,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  128,
-  151,
-  192,
-  210,
-  254, 
-  254, 
-  128,
-  152,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  154,
-  192,
-  254, 
-  254, 
-  50,
-  105,
-  128,
-  142,
-  210,
-  254, 
-  254, 
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  53,
-  64,
-  109,
-  142,
-  210,
-  254, 
-  254, 
-  0,
-  57,
-  64,
-  112,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  112,
-  142,
-  210,
-  254, 
-  64,
-  112,
-  192,
-  210,
-  254, 
-  0,
-  55,
-  64,
-  111,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  0,
-  53,
-  64,
-  109,
-  128,
-  145,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  107,
-  128,
-  140,
-  192,
-  254, 
-  254, 
-  128,
-  152,
-  210,
-  254, 
-  254, 
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  104,
-  152,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  107,
-  128,
-  140,
-  192,
-  254, 
-  254, 
-  64,
-  109,
-  128,
-  147,
-  210,
-  254, 
-  64,
-  107,
-  254, 
-  0,
-  50,
-  64,
-  105,
-  128,
-  147,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  104,
-  128,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  151,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  163,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  163,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  108,
-  156,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  108,
-  160,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  192,
-  210,
-  254, 
-  254, 
-  192,
-  210,
-  254, 
-  254, 
-  52,
-  111,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  52,
-  128,
-  156,
-  210,
-  254, 
-  0,
-  50,
-  192,
-  210,
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  149,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  161,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  148,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  160,
-  210,
-  254, 
-  254, 
-  64,
-  108,
-  128,
-  148,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  160,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  144,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  161,
-  210,
-  254, 
-  254, 
-  128,
-  151,
-  192,
-  210,
-  254, 
-  254, 
-  128,
-  152,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  154,
-  192,
-  254, 
-  254, 
-  50,
-  105,
-  128,
-  142,
-  210,
-  254, 
-  254, 
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  53,
-  64,
-  109,
-  142,
-  210,
-  254, 
-  254, 
-  0,
-  57,
-  64,
-  112,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  112,
-  142,
-  210,
-  254, 
-  64,
-  112,
-  192,
-  210,
-  254, 
-  0,
-  55,
-  64,
-  111,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  0,
-  53,
-  64,
-  109,
-  128,
-  145,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  107,
-  128,
-  140,
-  192,
-  254, 
-  254, 
-  128,
-  152,
-  210,
-  254, 
-  254, 
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  104,
-  152,
-  210,
-  254, 
-  254, 
-  0,
-  52,
-  64,
-  107,
-  128,
-  140,
-  192,
-  254, 
-  254, 
-  64,
-  109,
-  128,
-  147,
-  210,
-  254, 
-  64,
-  107,
-  254, 
-  0,
-  50,
-  64,
-  105,
-  128,
-  147,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  104,
-  128,
-  192,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  151,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  163,
-  210,
-  254, 
-  254, 
-  0,
-  47,
-  64,
-  108,
-  128,
-  192,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  163,
-  210,
-  254, 
-  254, 
-  0,
-  50,
-  64,
-  111,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  108,
-  156,
-  210,
-  254, 
-  192,
-  210,
-  254, 
-  0,
-  52,
-  64,
-  112,
-  128,
-  192,
-  254, 
-  254, 
-  64,
-  108,
-  160,
-  210,
-  254, 
-  254, 
-  0,
-  48,
-  64,
-  109,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  64,
-  104,
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  128,
-  156,
-  210,
-  254, 
-  254, 
-  0,
-  45,
-  64,
-  104,
-  128,
-  149,
-  192,
-  254, 
-  254, 
-  210,
-  254, 
-  254, 
-  0,
-  64,
-  128,
-  192,
-  210,
-  254, 
-  254, 
-  192,
-  210,
-  254, 
-  254, 
-  192,
+// delta, length, part, note, velocity
+  { 0, 24, 0, 76, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 74, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 6, 0, 76, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 0, 74, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 69, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 24, 1, 72, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 74, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 36, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 44, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 44, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 24, 0, 76, 100 },
+  { 0, 24, 1, 72, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 72, 100 },
+  { 0, 24, 1, 69, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 69, 100 },
+  { 0, 48, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 47, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 50, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 24, 1, 65, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 0, 77, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 81, 100 },
+  { 0, 12, 1, 72, 100 },
+  { 12, 6, 1, 72, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 1, 72, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 12, 0, 79, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 0, 77, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 41, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 36, 0, 76, 100 },
+  { 0, 36, 1, 67, 100 },
+  { 0, 12, 2, 36, 100 },
+  { 12, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 0, 72, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 12, 1, 67, 100 },
+  { 0, 12, 2, 36, 100 },
+  { 12, 6, 1, 69, 100 },
+  { 0, 12, 2, 43, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 6, 6, 1, 67, 100 },
+  { 6, 12, 0, 74, 100 },
+  { 0, 12, 1, 65, 100 },
+  { 0, 12, 2, 43, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 47, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 59, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 59, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 24, 0, 76, 100 },
+  { 0, 12, 1, 72, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 24, 2, 45, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 74, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 6, 0, 76, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 0, 74, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 69, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 24, 1, 72, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 74, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 36, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 44, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 44, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 24, 0, 76, 100 },
+  { 0, 24, 1, 72, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 72, 100 },
+  { 0, 24, 1, 69, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 69, 100 },
+  { 0, 48, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 47, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 50, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 24, 1, 65, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 0, 77, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 81, 100 },
+  { 0, 12, 1, 72, 100 },
+  { 12, 6, 1, 72, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 1, 72, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 12, 0, 79, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 0, 77, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 41, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 36, 0, 76, 100 },
+  { 0, 36, 1, 67, 100 },
+  { 0, 12, 2, 36, 100 },
+  { 12, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 0, 72, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 12, 1, 67, 100 },
+  { 0, 12, 2, 36, 100 },
+  { 12, 6, 1, 69, 100 },
+  { 0, 12, 2, 43, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 6, 6, 1, 67, 100 },
+  { 6, 12, 0, 74, 100 },
+  { 0, 12, 1, 65, 100 },
+  { 0, 12, 2, 43, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 47, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 59, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 59, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 24, 0, 76, 100 },
+  { 0, 12, 1, 72, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 24, 2, 45, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 48, 0, 64, 100 },
+  { 0, 48, 1, 60, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 60, 100 },
+  { 0, 48, 1, 57, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 62, 100 },
+  { 0, 48, 1, 59, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 59, 100 },
+  { 0, 48, 1, 56, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 60, 100 },
+  { 0, 48, 1, 57, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 57, 100 },
+  { 0, 48, 1, 52, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 56, 100 },
+  { 0, 48, 1, 52, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 59, 100 },
+  { 0, 24, 1, 56, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 48, 0, 64, 100 },
+  { 0, 48, 1, 60, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 60, 100 },
+  { 0, 48, 1, 57, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 62, 100 },
+  { 0, 48, 1, 59, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 59, 100 },
+  { 0, 48, 1, 56, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 60, 100 },
+  { 0, 24, 1, 57, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 64, 100 },
+  { 0, 24, 1, 60, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 69, 100 },
+  { 0, 48, 1, 64, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 12, 2, 57, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 68, 100 },
+  { 0, 48, 1, 62, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 56, 100 },
+  { 12, 12, 2, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 74, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 6, 0, 76, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 0, 74, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 69, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 24, 1, 72, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 74, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 36, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 44, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 44, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 24, 0, 76, 100 },
+  { 0, 24, 1, 72, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 72, 100 },
+  { 0, 24, 1, 69, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 69, 100 },
+  { 0, 48, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 47, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 50, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 24, 1, 65, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 0, 77, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 81, 100 },
+  { 0, 12, 1, 72, 100 },
+  { 12, 6, 1, 72, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 1, 72, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 12, 0, 79, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 0, 77, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 41, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 36, 0, 76, 100 },
+  { 0, 36, 1, 67, 100 },
+  { 0, 12, 2, 36, 100 },
+  { 12, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 0, 72, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 12, 1, 67, 100 },
+  { 0, 12, 2, 36, 100 },
+  { 12, 6, 1, 69, 100 },
+  { 0, 12, 2, 43, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 6, 6, 1, 67, 100 },
+  { 6, 12, 0, 74, 100 },
+  { 0, 12, 1, 65, 100 },
+  { 0, 12, 2, 43, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 47, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 59, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 59, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 24, 0, 76, 100 },
+  { 0, 12, 1, 72, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 24, 2, 45, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 74, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 6, 0, 76, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 0, 74, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 69, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 24, 1, 72, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 74, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 36, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 44, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 44, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 24, 1, 71, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 24, 0, 76, 100 },
+  { 0, 24, 1, 72, 100 },
+  { 0, 12, 2, 40, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 72, 100 },
+  { 0, 24, 1, 69, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 48, 0, 69, 100 },
+  { 0, 48, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 57, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 47, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 2, 50, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 24, 1, 65, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 0, 77, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 81, 100 },
+  { 0, 12, 1, 72, 100 },
+  { 12, 6, 1, 72, 100 },
+  { 0, 12, 2, 38, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 1, 72, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 12, 0, 79, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 0, 77, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 41, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 36, 0, 76, 100 },
+  { 0, 36, 1, 67, 100 },
+  { 0, 12, 2, 36, 100 },
+  { 12, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 24, 12, 0, 72, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 2, 48, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 76, 100 },
+  { 0, 12, 1, 67, 100 },
+  { 0, 12, 2, 36, 100 },
+  { 12, 6, 1, 69, 100 },
+  { 0, 12, 2, 43, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 6, 6, 1, 67, 100 },
+  { 6, 12, 0, 74, 100 },
+  { 0, 12, 1, 65, 100 },
+  { 0, 12, 2, 43, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 64, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 0, 12, 2, 47, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 59, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 12, 0, 71, 100 },
+  { 0, 12, 1, 68, 100 },
+  { 12, 12, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 59, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 74, 100 },
+  { 0, 12, 1, 71, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 6, 3, 42, 100 },
+  { 6, 6, 3, 42, 100 },
+  { 6, 24, 0, 76, 100 },
+  { 0, 12, 1, 72, 100 },
+  { 12, 12, 1, 68, 100 },
+  { 0, 12, 2, 56, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 72, 100 },
+  { 0, 12, 1, 69, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 1, 64, 100 },
+  { 0, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 12, 2, 45, 100 },
+  { 12, 12, 2, 52, 100 },
+  { 0, 12, 3, 42, 100 },
+  { 12, 24, 0, 69, 100 },
+  { 0, 24, 1, 64, 100 },
+  { 0, 24, 2, 45, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 12, 3, 42, 100 },
+  { 12, 0, 0, 0, 0 },
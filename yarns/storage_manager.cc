@@ -28,11 +28,18 @@
 
 #include "yarns/storage_manager.h"
 
+#include <cstring>
+
 #include "yarns/midi_handler.h"
 #include "yarns/multi.h"
 
 namespace yarns {
 
+const uint32_t kCalibrationSize = \
+    kNumCVOutputs * (kNumOctaves + kNumHalfOctaveTrims) * sizeof(uint16_t);
+const uint32_t kLegacyCalibrationSize = \
+    kNumCVOutputs * kNumOctaves * sizeof(uint16_t);
+
 void StorageManager::SaveMulti(uint8_t slot) {
   stream_buffer_.Rewind();
   multi.Serialize(&stream_buffer_);
@@ -40,17 +47,15 @@ void StorageManager::SaveMulti(uint8_t slot) {
 }
 
 bool StorageManager::LoadMulti(uint8_t slot) {
-  // Dummy serialization of the multi to know its size.
-  stream_buffer_.Rewind();
-  multi.Serialize(&stream_buffer_);
-  uint32_t expected_size = stream_buffer_.position();
-  
-  if (!storage_.Load(stream_buffer_.mutable_bytes(), expected_size, 1 + slot)) {
+  if (!storage_.Load(
+          stream_buffer_.mutable_bytes(), sizeof(PackedMulti), 1 + slot)) {
     return false;
-  } else {
-    DeserializeMulti();
-    return true;
   }
+  // The program only lands on the next bar, and is read again then, so that
+  // the stream buffer stays free meanwhile. A later load replaces it.
+  pending_slot_ = slot;
+  multi.ScheduleProgramChange();
+  return true;
 }
 
 void StorageManager::SaveCalibration() {
@@ -64,13 +69,36 @@ bool StorageManager::LoadCalibration() {
   multi.SerializeCalibration(&stream_buffer_);
   uint32_t expected_size = stream_buffer_.position();
   
+  bool has_trims = true;
   if (!storage_.Load(stream_buffer_.mutable_bytes(), expected_size, 0)) {
+    // Calibration saved by a firmware without the half-octave trims
+    has_trims = false;
+    if (!storage_.Load(
+            stream_buffer_.mutable_bytes(), kLegacyCalibrationSize, 0)) {
+      return false;
+    }
+  }
+  stream_buffer_.Rewind();
+  multi.DeserializeCalibration(&stream_buffer_, has_trims);
+  return true;
+}
+
+void StorageManager::SysExSendCalibration() {
+  stream_buffer_.Rewind();
+  multi.SerializeCalibration(&stream_buffer_);
+  midi_handler.SysExSendPackets(
+      stream_buffer_.bytes(),
+      stream_buffer_.position(),
+      SYSEX_COMMAND_CALIBRATION_PACKET);
+}
+
+bool StorageManager::DeserializeCalibration() {
+  if (stream_buffer_.position() != kCalibrationSize) {
     return false;
-  } else {
-    stream_buffer_.Rewind();
-    multi.DeserializeCalibration(&stream_buffer_);
-    return true;
   }
+  stream_buffer_.Rewind();
+  multi.DeserializeCalibration(&stream_buffer_, true);
+  return true;
 }
 
 void StorageManager::SysExSendMulti() {
@@ -78,15 +106,76 @@ void StorageManager::SysExSendMulti() {
   multi.Serialize(&stream_buffer_);
   midi_handler.SysExSendPackets(
       stream_buffer_.bytes(),
-      stream_buffer_.position());
+      stream_buffer_.position(),
+      SYSEX_COMMAND_DUMP_PACKET);
 }
 
-void StorageManager::DeserializeMulti() {
+void StorageManager::DeserializeMulti(bool seamless) {
   stream_buffer_.Rewind();
-  multi.Deserialize(&stream_buffer_);
+  multi.Deserialize(&stream_buffer_, seamless);
+}
+
+void StorageManager::DeserializePendingMulti() {
+  if (storage_.Load(
+          stream_buffer_.mutable_bytes(), sizeof(PackedMulti),
+          1 + pending_slot_)) {
+    DeserializeMulti(true);
+  }
+}
+
+bool StorageManager::SaveSong() {
+  PackedSongHeader header;
+  size_t size = stream_buffer_.position();
+  if (size < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, stream_buffer_.bytes(), sizeof(header));
+  Song song;
+  song.events = reinterpret_cast<const SongEvent*>(
+      stream_buffer_.bytes() + sizeof(header));
+  song.num_events = header.num_events;
+  if (header.num_events > kMaxUploadedSongEvents ||
+      size != sizeof(header) + header.num_events * sizeof(SongEvent) ||
+      !Multi::IsPlayableSong(song)) {
+    return false;
+  }
+  // The page is about to be erased
+  if (multi.playing_song()) {
+    multi.Stop();
+  }
+  song_storage_.Save(stream_buffer_.bytes(), size, 0);
+  return true;
+}
+
+bool StorageManager::LoadSong(Song* song) {
+#ifdef TEST
+  const uint8_t* page = song_storage_.bytes(0);
+#else
+  const uint8_t* page = reinterpret_cast<const uint8_t*>(
+      kSongStorageEnd - PAGE_SIZE);
+#endif  // TEST
+  PackedSongHeader header;
+  memcpy(&header, page, sizeof(header));
+  // An erased page reads as 0xffff events
+  if (header.num_events > kMaxUploadedSongEvents) {
+    return false;
+  }
+  // Only checks the checksum: the song is played from flash
+  size_t size = sizeof(header) + header.num_events * sizeof(SongEvent);
+  if (!song_storage_.Load(stream_buffer_.mutable_bytes(), size, 0)) {
+    return false;
+  }
+  song->events = reinterpret_cast<const SongEvent*>(page + sizeof(header));
+  song->num_events = header.num_events;
+  song->clock_tempo = header.clock_tempo;
+  CONSTRAIN(song->clock_tempo, TEMPO_EXTERNAL + 1, 240);
+  for (uint8_t p = 0; p < kNumParts; ++p) {
+    song->oscillator_shape[p] = header.oscillator_shape[p];
+  }
+  return Multi::IsPlayableSong(*song);
 }
 
 /* extern */
-StorageManager storage_manager;
+INSTANCE_STATE StorageManager storage_manager;
 
 }  // namespace yarns
\ No newline at end of file
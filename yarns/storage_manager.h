@@ -34,12 +34,25 @@
 #include "stmlib/stmlib.h"
 
 #include "stmlib/utils/stream_buffer.h"
+
+#include "yarns/instance_state.h"
+#ifdef TEST
+#include "yarns/test/ram_storage.h"
+#else
 #include "stmlib/system/storage.h"
+#endif  // TEST
 
 namespace yarns {
 
 const uint16_t kMaxSize = PAGE_SIZE - 2; // 2 bytes for checksum
 
+// The uploaded song has the flash page right below the calibration and the
+// presets, and is played from there. stmlib::Storage keeps its pages right
+// below its last address, and the application image has to end below them.
+const uint32_t kSongStorageEnd = 0x8020000 - 9 * PAGE_SIZE;
+
+struct Song;
+
 class StorageManager {
  public:
   StorageManager() { }
@@ -50,24 +63,44 @@ class StorageManager {
   void SaveCalibration();
   bool LoadCalibration();
   void SysExSendMulti();
+  void SysExSendCalibration();
   
   void AppendData(const uint8_t* data, size_t size, bool rewind) {
     if (rewind) {
       stream_buffer_.Rewind();
     }
-    stream_buffer_.Write(data, size);
+    // No multi or song fills more than a page, so a longer dump is malformed
+    if (stream_buffer_.position() + size <= kMaxSize) {
+      stream_buffer_.Write(data, size);
+    }
   }
   
-  void DeserializeMulti();
+  // Seamless keeps the clock and held notes running, see LoadMulti
+  void DeserializeMulti(bool seamless);
+  // Reads the program scheduled by LoadMulti again, and lands it
+  void DeserializePendingMulti();
+  // Takes a received calibration dump, if it has the expected size
+  bool DeserializeCalibration();
+  // Keeps a received song dump in flash, if it is a playable song
+  bool SaveSong();
+  // Points song at the uploaded song, if there is one
+  bool LoadSong(Song* song);
 
  private:
   stmlib::StreamBuffer<kMaxSize> stream_buffer_;
+  uint8_t pending_slot_;
+#ifdef TEST
+  RamStorage<9> storage_;
+  RamStorage<1> song_storage_;
+#else
   stmlib::Storage<0x8020000, 9> storage_;
+  stmlib::Storage<kSongStorageEnd, 1> song_storage_;
+#endif  // TEST
   
   DISALLOW_COPY_AND_ASSIGN(StorageManager);
 };
 
-extern StorageManager storage_manager;
+extern INSTANCE_STATE StorageManager storage_manager;
 
 }  // namespace yarns
 
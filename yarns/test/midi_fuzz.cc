@@ -0,0 +1,404 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Host fuzzing and throughput of the MIDI input path: stream parser, handler
+// and SysEx decoder, built against the firmware. The fuzz_asan and fuzz_ubsan
+// targets of the test makefile run it under the sanitizers.
+
+#include <stm32f10x_conf.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+#include "stmlib/utils/random.h"
+#include "stmlib/utils/stream_buffer.h"
+
+#include "yarns/midi_handler.h"
+#include "yarns/multi.h"
+#include "yarns/storage_manager.h"
+
+using namespace stmlib;
+using namespace stmlib_midi;
+using namespace yarns;
+
+// From yarns.cc
+void Init();
+void RunLowPriorityTasks();
+
+extern "C" {
+void SysTick_Handler();
+}
+
+const uint32_t kMidiByteRate = 31250 / 10;
+const uint32_t kNumFuzzCases = 2000;
+// Less than the input buffer holds, so nothing gets overwritten
+const size_t kChunkSize = 64;
+
+const uint8_t kRealtime[] = { 0xf8, 0xfa, 0xfb, 0xfc, 0xfe, 0xff };
+const uint8_t kYarnsHeader[] = { 0xf0, 0x00, 0x21, 0x02, 0x00, 0x0b };
+
+inline uint64_t Nanoseconds() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<uint64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+inline uint32_t Choose(uint32_t n) {
+  return (Random::GetWord() >> 8) % n;
+}
+
+inline uint8_t DataByte() {
+  return Choose(128);
+}
+
+bool Report(const char* test, bool pass) {
+  printf("%s: %s\n", pass ? "PASS" : "FAIL", test);
+  return pass;
+}
+
+typedef std::vector<uint8_t> Bytes;
+
+void DrainOutput() {
+  while (midi_handler.mutable_output_buffer()->readable()) {
+    midi_handler.mutable_output_buffer()->ImmediateRead();
+  }
+  while (midi_handler.mutable_high_priority_output_buffer()->readable()) {
+    midi_handler.mutable_high_priority_output_buffer()->ImmediateRead();
+  }
+}
+
+// Hands the bytes over one main loop pass and one SysTick per chunk, the way
+// the UART interrupt and the main loop would on the module.
+void Feed(const Bytes& bytes) {
+  for (size_t i = 0; i < bytes.size(); i += kChunkSize) {
+    size_t end = std::min(bytes.size(), i + kChunkSize);
+    for (size_t j = i; j < end; ++j) {
+      midi_handler.PushByte(bytes[j]);
+    }
+    RunLowPriorityTasks();
+    SysTick_Handler();
+    DrainOutput();
+  }
+}
+
+// Channel messages, mostly under running status
+void AppendChannelMessages(Bytes* bytes, uint32_t num_messages) {
+  for (uint32_t i = 0; i < num_messages; ++i) {
+    if (i == 0 || Choose(4) == 0) {
+      bytes->push_back((0x8 + Choose(7)) << 4 | Choose(16));
+    }
+    for (uint8_t j = 0; j < 2; ++j) {
+      bytes->push_back(DataByte());
+    }
+  }
+}
+
+void AppendYarnsPacket(
+    Bytes* bytes,
+    uint8_t command,
+    uint8_t packet_index,
+    const uint8_t* data,
+    size_t size) {
+  bytes->insert(bytes->end(), kYarnsHeader, kYarnsHeader + sizeof(kYarnsHeader));
+  bytes->push_back(command);
+  bytes->push_back(packet_index);
+  uint8_t checksum = 0;
+  for (size_t i = 0; i < size; ++i) {
+    checksum += data[i];
+    bytes->push_back(data[i] >> 4);
+    bytes->push_back(data[i] & 0x0f);
+  }
+  bytes->push_back(checksum >> 4);
+  bytes->push_back(checksum & 0x0f);
+  bytes->push_back(0xf7);
+}
+
+// A packet with more nibbles than the receive buffer holds, or than a
+// packet may carry, terminated or not.
+void AppendOversizedPacket(Bytes* bytes) {
+  uint8_t command = Choose(2) ?
+      SYSEX_COMMAND_DUMP_PACKET : SYSEX_COMMAND_CALIBRATION_PACKET;
+  bytes->insert(bytes->end(), kYarnsHeader, kYarnsHeader + sizeof(kYarnsHeader));
+  bytes->push_back(command);
+  bytes->push_back(Choose(4));
+  size_t num_nibbles = (kSysexMaxChunkSize + 1) * 2 + 2 + Choose(kSysexRxBufferSize);
+  for (size_t i = 0; i < num_nibbles; ++i) {
+    bytes->push_back(Choose(16));
+  }
+  if (Choose(4)) {
+    bytes->push_back(0xf7);
+  }
+}
+
+// A SysEx cut short by a status byte, another f0, or nothing at all.
+void AppendTruncatedSysEx(Bytes* bytes) {
+  if (Choose(2)) {
+    size_t size = Choose(sizeof(kYarnsHeader)) + 1;
+    bytes->insert(bytes->end(), kYarnsHeader, kYarnsHeader + size);
+  } else {
+    bytes->push_back(0xf0);
+  }
+  size_t num_bytes = Choose(kSysexRxBufferSize + 32);
+  for (size_t i = 0; i < num_bytes; ++i) {
+    bytes->push_back(Choose(4) ? Choose(16) : DataByte());
+  }
+  switch (Choose(3)) {
+    case 0:
+      bytes->push_back(0x90 | Choose(16));
+      break;
+    case 1:
+      bytes->push_back(0xf0);
+      break;
+    default:
+      break;
+  }
+}
+
+void AppendRandomBytes(Bytes* bytes) {
+  size_t num_bytes = Choose(256);
+  for (size_t i = 0; i < num_bytes; ++i) {
+    bytes->push_back(Choose(256));
+  }
+}
+
+// Realtime bytes may land anywhere, including inside a SysEx.
+Bytes InterleaveRealtime(const Bytes& bytes) {
+  Bytes interleaved;
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    while (Choose(8) == 0) {
+      interleaved.push_back(kRealtime[Choose(sizeof(kRealtime))]);
+    }
+    interleaved.push_back(bytes[i]);
+  }
+  return interleaved;
+}
+
+Bytes GenerateCase() {
+  Bytes bytes;
+  uint8_t num_parts = Choose(4) + 1;
+  for (uint8_t i = 0; i < num_parts; ++i) {
+    switch (Choose(5)) {
+      case 0:
+        AppendChannelMessages(&bytes, Choose(32) + 1);
+        break;
+      case 1:
+        AppendTruncatedSysEx(&bytes);
+        break;
+      case 2:
+        AppendOversizedPacket(&bytes);
+        break;
+      case 3:
+        {
+          uint8_t data[kSysexMaxChunkSize];
+          size_t size = Choose(kSysexMaxChunkSize + 1);
+          for (size_t j = 0; j < size; ++j) {
+            data[j] = Choose(256);
+          }
+          AppendYarnsPacket(&bytes, Choose(36), Choose(4), data, size);
+        }
+        break;
+      default:
+        AppendRandomBytes(&bytes);
+        break;
+    }
+  }
+  return Choose(2) ? InterleaveRealtime(bytes) : bytes;
+}
+
+// Whatever came before, the next complete note has to come through. The
+// hold pedal outlives a reset of the multi, so it is released first.
+bool Resynchronizes() {
+  multi.Init(false);
+  Bytes note_on;
+  note_on.push_back(0xb0);
+  note_on.push_back(kCCHoldPedal);
+  note_on.push_back(0);
+  note_on.push_back(0x90);
+  note_on.push_back(60);
+  note_on.push_back(100);
+  Feed(note_on);
+  bool ok = multi.part(0).has_notes();
+  Bytes note_off;
+  note_off.push_back(0x80);
+  note_off.push_back(60);
+  note_off.push_back(0);
+  Feed(note_off);
+  return ok && !multi.part(0).has_notes();
+}
+
+// A multi dump, sent the way StorageManager::SysExSendMulti does.
+Bytes MultiDump(uint8_t tempo) {
+  uint8_t saved_tempo = multi.tempo();
+  multi.ApplySetting(SETTING_CLOCK_TEMPO, 0, tempo);
+  // Stands in for the refresh, which commits the queued settings
+  multi.ApplyPendingSettings();
+  StreamBuffer<kMaxSize> stream_buffer;
+  multi.Serialize(&stream_buffer);
+  multi.ApplySetting(SETTING_CLOCK_TEMPO, 0, saved_tempo);
+  multi.ApplyPendingSettings();
+
+  Bytes bytes;
+  const uint8_t* data = stream_buffer.bytes();
+  size_t size = stream_buffer.position();
+  uint8_t packet_index = 0;
+  while (size) {
+    size_t chunk_size = std::min(size, kSysexMaxChunkSize);
+    AppendYarnsPacket(
+        &bytes, SYSEX_COMMAND_DUMP_PACKET, packet_index, data, chunk_size);
+    size -= chunk_size;
+    data += chunk_size;
+    ++packet_index;
+  }
+  AppendYarnsPacket(
+      &bytes, SYSEX_COMMAND_DUMP_PACKET, packet_index, NULL, 0);
+  return bytes;
+}
+
+bool TestFuzz() {
+  MockResetPeripherals();
+  ::Init();
+  uint32_t num_failures = 0;
+  size_t num_bytes = 0;
+  for (uint32_t i = 0; i < kNumFuzzCases; ++i) {
+    Bytes bytes = GenerateCase();
+    num_bytes += bytes.size();
+    Feed(bytes);
+    if (!Resynchronizes()) {
+      if (!num_failures) {
+        printf("Case %u lost sync:", static_cast<unsigned>(i));
+        for (size_t j = 0; j < bytes.size(); ++j) {
+          printf(" %02x", bytes[j]);
+        }
+        printf("\n");
+      }
+      ++num_failures;
+    }
+  }
+  printf(
+      "Fuzz: %u cases, %zu bytes, %u lost sync\n",
+      static_cast<unsigned>(kNumFuzzCases), num_bytes,
+      static_cast<unsigned>(num_failures));
+  return Report("MIDI fuzz", num_failures == 0);
+}
+
+bool TestSysExDump() {
+  MockResetPeripherals();
+  ::Init();
+  bool ok = true;
+
+  // Clean, then with realtime bytes in between
+  Feed(MultiDump(133));
+  ok = ok && multi.tempo() == 133;
+  Feed(InterleaveRealtime(MultiDump(97)));
+  ok = ok && multi.tempo() == 97;
+
+  // A dump right after an oversized packet and a truncated SysEx
+  Bytes bytes;
+  AppendOversizedPacket(&bytes);
+  AppendTruncatedSysEx(&bytes);
+  Bytes dump = MultiDump(121);
+  bytes.insert(bytes.end(), dump.begin(), dump.end());
+  Feed(bytes);
+  ok = ok && multi.tempo() == 121;
+
+  // A corrupted packet anywhere in the dump leaves the multi alone
+  dump = MultiDump(88);
+  dump[sizeof(kYarnsHeader) + 2 + Choose(2 * kSysexMaxChunkSize)] ^= 0x01;
+  Feed(dump);
+  ok = ok && multi.tempo() == 121;
+
+  // Packets beyond what the storage page holds are dropped, not written
+  bytes.clear();
+  uint8_t data[kSysexMaxChunkSize];
+  std::fill(&data[0], &data[kSysexMaxChunkSize], 0x55);
+  for (uint8_t i = 0; i < kMaxSize / kSysexMaxChunkSize + 4; ++i) {
+    AppendYarnsPacket(
+        &bytes, SYSEX_COMMAND_DUMP_PACKET, i, data, kSysexMaxChunkSize);
+  }
+  Feed(bytes);
+  ok = ok && Resynchronizes();
+  return Report("SysEx dump", ok);
+}
+
+double Throughput(const Bytes& bytes) {
+  uint64_t start = Nanoseconds();
+  for (size_t i = 0; i < bytes.size(); i += kChunkSize) {
+    size_t end = std::min(bytes.size(), i + kChunkSize);
+    for (size_t j = i; j < end; ++j) {
+      midi_handler.PushByte(bytes[j]);
+    }
+    midi_handler.ProcessInput();
+    multi.LowPriority();
+    DrainOutput();
+  }
+  return 1e9 * bytes.size() / (Nanoseconds() - start);
+}
+
+bool TestThroughput() {
+  MockResetPeripherals();
+  ::Init();
+  multi.ApplySetting(SETTING_LAYOUT, 0, LAYOUT_QUAD_POLY);
+  multi.ApplyPendingSettings();
+
+  // Ten seconds of the wire, all notes under running status
+  Bytes notes;
+  notes.push_back(0x90);
+  while (notes.size() < 10 * kMidiByteRate) {
+    uint8_t note = 36 + Choose(48);
+    notes.push_back(note);
+    notes.push_back(Choose(127) + 1);
+    notes.push_back(note);
+    notes.push_back(0);
+  }
+  double notes_rate = Throughput(notes);
+
+  Bytes mixed;
+  while (mixed.size() < 10 * kMidiByteRate) {
+    Bytes bytes = GenerateCase();
+    mixed.insert(mixed.end(), bytes.begin(), bytes.end());
+  }
+  double mixed_rate = Throughput(mixed);
+
+  printf(
+      "Throughput: running status %.0f bytes/s (%.1fx the wire rate), "
+      "fuzz mix %.0f bytes/s (%.1fx)\n",
+      notes_rate, notes_rate / kMidiByteRate,
+      mixed_rate, mixed_rate / kMidiByteRate);
+  return Report(
+      "MIDI throughput",
+      notes_rate > kMidiByteRate && mixed_rate > kMidiByteRate);
+}
+
+int main(void) {
+  uint8_t num_failures = 0;
+  num_failures += !TestFuzz();
+  num_failures += !TestSysExDump();
+  num_failures += !TestThroughput();
+  printf("%d failure(s)\n", num_failures);
+  return num_failures ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Flash storage stand-in for host builds, with the interface of
+// stmlib::Storage. A block only loads back at the size it was saved with,
+// like a flash page whose checksum does not match.
+
+#ifndef YARNS_TEST_RAM_STORAGE_H_
+#define YARNS_TEST_RAM_STORAGE_H_
+
+#include <cstring>
+
+#include "stmlib/stmlib.h"
+#include "stmlib/system/flash_programming.h"
+
+namespace yarns {
+
+template<uint16_t num_pages>
+class RamStorage {
+ public:
+  RamStorage() {
+    memset(size_, 0, sizeof(size_));
+  }
+  ~RamStorage() { }
+
+  void Save(const void* data, size_t size, uint16_t block) {
+    memcpy(pages_[block], data, size);
+    size_[block] = size;
+  }
+
+  bool Load(void* data, size_t size, uint16_t block) {
+    if (size_[block] != size) {
+      return false;
+    }
+    memcpy(data, pages_[block], size);
+    return true;
+  }
+
+  // Where the block would be mapped in flash
+  const uint8_t* bytes(uint16_t block) const {
+    return pages_[block];
+  }
+
+ private:
+  uint8_t pages_[num_pages][PAGE_SIZE];
+  size_t size_[num_pages];
+
+  DISALLOW_COPY_AND_ASSIGN(RamStorage);
+};
+
+}  // namespace yarns
+
+#endif  // YARNS_TEST_RAM_STORAGE_H_
@@ -0,0 +1,431 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Register-level stand-in for the STM32F10x standard peripheral library, for
+// host builds of the drivers.
+//
+// The peripherals the drivers touch are plain memory mapped at their real
+// addresses, and the library calls write the registers the way the real ones
+// do. Host builds must be linked without PIE: the drivers give the DMA 32-bit
+// addresses of their buffers.
+
+#ifndef YARNS_TEST_STM32_MOCK_STM32F10X_CONF_H_
+#define YARNS_TEST_STM32_MOCK_STM32F10X_CONF_H_
+
+#include <stdint.h>
+
+#define __IO volatile
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus, ITStatus;
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+typedef enum { Bit_RESET = 0, Bit_SET } BitAction;
+
+// Peripherals
+
+typedef struct {
+  __IO uint32_t CRL;
+  __IO uint32_t CRH;
+  __IO uint32_t IDR;
+  __IO uint32_t ODR;
+  __IO uint32_t BSRR;
+  __IO uint32_t BRR;
+  __IO uint32_t LCKR;
+} GPIO_TypeDef;
+
+typedef struct {
+  __IO uint16_t CR1; uint16_t RESERVED0;
+  __IO uint16_t CR2; uint16_t RESERVED1;
+  __IO uint16_t SMCR; uint16_t RESERVED2;
+  __IO uint16_t DIER; uint16_t RESERVED3;
+  __IO uint16_t SR; uint16_t RESERVED4;
+  __IO uint16_t EGR; uint16_t RESERVED5;
+  __IO uint16_t CCMR1; uint16_t RESERVED6;
+  __IO uint16_t CCMR2; uint16_t RESERVED7;
+  __IO uint16_t CCER; uint16_t RESERVED8;
+  __IO uint16_t CNT; uint16_t RESERVED9;
+  __IO uint16_t PSC; uint16_t RESERVED10;
+  __IO uint16_t ARR; uint16_t RESERVED11;
+  __IO uint16_t RCR; uint16_t RESERVED12;
+  __IO uint16_t CCR1; uint16_t RESERVED13;
+  __IO uint16_t CCR2; uint16_t RESERVED14;
+  __IO uint16_t CCR3; uint16_t RESERVED15;
+  __IO uint16_t CCR4; uint16_t RESERVED16;
+  __IO uint16_t BDTR; uint16_t RESERVED17;
+  __IO uint16_t DCR; uint16_t RESERVED18;
+  __IO uint16_t DMAR; uint16_t RESERVED19;
+} TIM_TypeDef;
+
+typedef struct {
+  __IO uint16_t CR1; uint16_t RESERVED0;
+  __IO uint16_t CR2; uint16_t RESERVED1;
+  __IO uint16_t SR; uint16_t RESERVED2;
+  __IO uint16_t DR; uint16_t RESERVED3;
+  __IO uint16_t CRCPR; uint16_t RESERVED4;
+  __IO uint16_t RXCRCR; uint16_t RESERVED5;
+  __IO uint16_t TXCRCR; uint16_t RESERVED6;
+  __IO uint16_t I2SCFGR; uint16_t RESERVED7;
+  __IO uint16_t I2SPR; uint16_t RESERVED8;
+} SPI_TypeDef;
+
+typedef struct {
+  __IO uint16_t SR; uint16_t RESERVED0;
+  __IO uint16_t DR; uint16_t RESERVED1;
+  __IO uint16_t BRR; uint16_t RESERVED2;
+  __IO uint16_t CR1; uint16_t RESERVED3;
+  __IO uint16_t CR2; uint16_t RESERVED4;
+  __IO uint16_t CR3; uint16_t RESERVED5;
+  __IO uint16_t GTPR; uint16_t RESERVED6;
+} USART_TypeDef;
+
+typedef struct {
+  __IO uint32_t CCR;
+  __IO uint32_t CNDTR;
+  __IO uint32_t CPAR;
+  __IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+  __IO uint32_t ISR;
+  __IO uint32_t IFCR;
+} DMA_TypeDef;
+
+#define PERIPH_BASE           ((uint32_t)0x40000000)
+#define APB1PERIPH_BASE       PERIPH_BASE
+#define APB2PERIPH_BASE       (PERIPH_BASE + 0x10000)
+#define AHBPERIPH_BASE        (PERIPH_BASE + 0x20000)
+#define PERIPH_SIZE           ((uint32_t)0x30000)
+
+#define TIM2_BASE             (APB1PERIPH_BASE + 0x0000)
+#define TIM4_BASE             (APB1PERIPH_BASE + 0x0800)
+#define SPI2_BASE             (APB1PERIPH_BASE + 0x3800)
+#define GPIOA_BASE            (APB2PERIPH_BASE + 0x0800)
+#define GPIOB_BASE            (APB2PERIPH_BASE + 0x0C00)
+#define GPIOC_BASE            (APB2PERIPH_BASE + 0x1000)
+#define TIM1_BASE             (APB2PERIPH_BASE + 0x2C00)
+#define USART1_BASE           (APB2PERIPH_BASE + 0x3800)
+#define DMA1_BASE             (AHBPERIPH_BASE + 0x0000)
+#define DMA1_Channel1_BASE    (AHBPERIPH_BASE + 0x0008)
+
+#define TIM1                  ((TIM_TypeDef *) TIM1_BASE)
+#define TIM2                  ((TIM_TypeDef *) TIM2_BASE)
+#define TIM4                  ((TIM_TypeDef *) TIM4_BASE)
+#define SPI2                  ((SPI_TypeDef *) SPI2_BASE)
+#define GPIOA                 ((GPIO_TypeDef *) GPIOA_BASE)
+#define GPIOB                 ((GPIO_TypeDef *) GPIOB_BASE)
+#define GPIOC                 ((GPIO_TypeDef *) GPIOC_BASE)
+#define USART1                ((USART_TypeDef *) USART1_BASE)
+#define DMA1                  ((DMA_TypeDef *) DMA1_BASE)
+#define DMA1_Channel1         ((DMA_Channel_TypeDef *) (DMA1_Channel1_BASE + 0x00))
+#define DMA1_Channel2         ((DMA_Channel_TypeDef *) (DMA1_Channel1_BASE + 0x14))
+#define DMA1_Channel3         ((DMA_Channel_TypeDef *) (DMA1_Channel1_BASE + 0x28))
+#define DMA1_Channel4         ((DMA_Channel_TypeDef *) (DMA1_Channel1_BASE + 0x3C))
+#define DMA1_Channel5         ((DMA_Channel_TypeDef *) (DMA1_Channel1_BASE + 0x50))
+#define DMA1_Channel6         ((DMA_Channel_TypeDef *) (DMA1_Channel1_BASE + 0x64))
+#define DMA1_Channel7         ((DMA_Channel_TypeDef *) (DMA1_Channel1_BASE + 0x78))
+
+// IRQ numbers
+
+typedef enum {
+  DMA1_Channel4_IRQn = 14,
+  TIM2_IRQn = 28,
+} IRQn_Type;
+
+// GPIO
+
+typedef enum {
+  GPIO_Speed_10MHz = 1,
+  GPIO_Speed_2MHz,
+  GPIO_Speed_50MHz
+} GPIOSpeed_TypeDef;
+
+typedef enum {
+  GPIO_Mode_AIN = 0x0,
+  GPIO_Mode_IN_FLOATING = 0x04,
+  GPIO_Mode_IPD = 0x28,
+  GPIO_Mode_IPU = 0x48,
+  GPIO_Mode_Out_OD = 0x14,
+  GPIO_Mode_Out_PP = 0x10,
+  GPIO_Mode_AF_OD = 0x1C,
+  GPIO_Mode_AF_PP = 0x18
+} GPIOMode_TypeDef;
+
+typedef struct {
+  uint16_t GPIO_Pin;
+  GPIOSpeed_TypeDef GPIO_Speed;
+  GPIOMode_TypeDef GPIO_Mode;
+} GPIO_InitTypeDef;
+
+#define GPIO_Pin_0            ((uint16_t)0x0001)
+#define GPIO_Pin_1            ((uint16_t)0x0002)
+#define GPIO_Pin_2            ((uint16_t)0x0004)
+#define GPIO_Pin_3            ((uint16_t)0x0008)
+#define GPIO_Pin_4            ((uint16_t)0x0010)
+#define GPIO_Pin_5            ((uint16_t)0x0020)
+#define GPIO_Pin_6            ((uint16_t)0x0040)
+#define GPIO_Pin_7            ((uint16_t)0x0080)
+#define GPIO_Pin_8            ((uint16_t)0x0100)
+#define GPIO_Pin_9            ((uint16_t)0x0200)
+#define GPIO_Pin_10           ((uint16_t)0x0400)
+#define GPIO_Pin_11           ((uint16_t)0x0800)
+#define GPIO_Pin_12           ((uint16_t)0x1000)
+#define GPIO_Pin_13           ((uint16_t)0x2000)
+#define GPIO_Pin_14           ((uint16_t)0x4000)
+#define GPIO_Pin_15           ((uint16_t)0x8000)
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct);
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+void GPIO_WriteBit(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, BitAction BitVal);
+
+// RCC, NVIC, SysTick
+
+#define RCC_AHBPeriph_DMA1    ((uint32_t)0x00000001)
+#define RCC_APB2Periph_GPIOA  ((uint32_t)0x00000004)
+#define RCC_APB2Periph_GPIOB  ((uint32_t)0x00000008)
+#define RCC_APB2Periph_GPIOC  ((uint32_t)0x00000010)
+#define RCC_APB2Periph_TIM1   ((uint32_t)0x00000800)
+#define RCC_APB2Periph_USART1 ((uint32_t)0x00004000)
+#define RCC_APB1Periph_TIM2   ((uint32_t)0x00000001)
+#define RCC_APB1Periph_TIM4   ((uint32_t)0x00000004)
+#define RCC_APB1Periph_SPI2   ((uint32_t)0x00004000)
+
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState);
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState);
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState);
+
+typedef struct {
+  uint8_t NVIC_IRQChannel;
+  uint8_t NVIC_IRQChannelPreemptionPriority;
+  uint8_t NVIC_IRQChannelSubPriority;
+  FunctionalState NVIC_IRQChannelCmd;
+} NVIC_InitTypeDef;
+
+#define NVIC_VectTab_FLASH    ((uint32_t)0x08000000)
+#define NVIC_PriorityGroup_2  ((uint32_t)0x500)
+
+void NVIC_Init(NVIC_InitTypeDef* NVIC_InitStruct);
+void NVIC_SetVectorTable(uint32_t NVIC_VectTab, uint32_t Offset);
+void NVIC_PriorityGroupConfig(uint32_t NVIC_PriorityGroup);
+uint32_t SysTick_Config(uint32_t ticks);
+void SystemInit(void);
+
+// Timers
+
+typedef struct {
+  uint16_t TIM_Prescaler;
+  uint16_t TIM_CounterMode;
+  uint16_t TIM_Period;
+  uint16_t TIM_ClockDivision;
+  uint8_t TIM_RepetitionCounter;
+} TIM_TimeBaseInitTypeDef;
+
+typedef struct {
+  uint16_t TIM_OCMode;
+  uint16_t TIM_OutputState;
+  uint16_t TIM_OutputNState;
+  uint16_t TIM_Pulse;
+  uint16_t TIM_OCPolarity;
+  uint16_t TIM_OCNPolarity;
+  uint16_t TIM_OCIdleState;
+  uint16_t TIM_OCNIdleState;
+} TIM_OCInitTypeDef;
+
+#define TIM_CounterMode_Up    ((uint16_t)0x0000)
+#define TIM_CKD_DIV1          ((uint16_t)0x0000)
+#define TIM_OCMode_Timing     ((uint16_t)0x0000)
+
+#define TIM_IT_Update         ((uint16_t)0x0001)
+#define TIM_IT_CC1            ((uint16_t)0x0002)
+#define TIM_IT_CC2            ((uint16_t)0x0004)
+#define TIM_IT_CC3            ((uint16_t)0x0008)
+#define TIM_IT_CC4            ((uint16_t)0x0010)
+
+#define TIM_DMA_Update        ((uint16_t)0x0100)
+#define TIM_DMA_CC1           ((uint16_t)0x0200)
+#define TIM_DMA_CC2           ((uint16_t)0x0400)
+#define TIM_DMA_CC3           ((uint16_t)0x0800)
+#define TIM_DMA_CC4           ((uint16_t)0x1000)
+
+void TIM_TimeBaseInit(
+    TIM_TypeDef* TIMx, TIM_TimeBaseInitTypeDef* TIM_TimeBaseInitStruct);
+void TIM_InternalClockConfig(TIM_TypeDef* TIMx);
+void TIM_Cmd(TIM_TypeDef* TIMx, FunctionalState NewState);
+void TIM_OCStructInit(TIM_OCInitTypeDef* TIM_OCInitStruct);
+void TIM_OC1Init(TIM_TypeDef* TIMx, TIM_OCInitTypeDef* TIM_OCInitStruct);
+void TIM_OC2Init(TIM_TypeDef* TIMx, TIM_OCInitTypeDef* TIM_OCInitStruct);
+void TIM_OC3Init(TIM_TypeDef* TIMx, TIM_OCInitTypeDef* TIM_OCInitStruct);
+void TIM_OC4Init(TIM_TypeDef* TIMx, TIM_OCInitTypeDef* TIM_OCInitStruct);
+void TIM_SetCompare1(TIM_TypeDef* TIMx, uint16_t Compare1);
+void TIM_SetCompare2(TIM_TypeDef* TIMx, uint16_t Compare2);
+void TIM_SetCompare3(TIM_TypeDef* TIMx, uint16_t Compare3);
+void TIM_SetCompare4(TIM_TypeDef* TIMx, uint16_t Compare4);
+void TIM_ITConfig(TIM_TypeDef* TIMx, uint16_t TIM_IT, FunctionalState NewState);
+ITStatus TIM_GetITStatus(TIM_TypeDef* TIMx, uint16_t TIM_IT);
+void TIM_ClearITPendingBit(TIM_TypeDef* TIMx, uint16_t TIM_IT);
+void TIM_DMACmd(
+    TIM_TypeDef* TIMx, uint16_t TIM_DMASource, FunctionalState NewState);
+
+// DMA
+
+typedef struct {
+  uint32_t DMA_PeripheralBaseAddr;
+  uint32_t DMA_MemoryBaseAddr;
+  uint32_t DMA_DIR;
+  uint32_t DMA_BufferSize;
+  uint32_t DMA_PeripheralInc;
+  uint32_t DMA_MemoryInc;
+  uint32_t DMA_PeripheralDataSize;
+  uint32_t DMA_MemoryDataSize;
+  uint32_t DMA_Mode;
+  uint32_t DMA_Priority;
+  uint32_t DMA_M2M;
+} DMA_InitTypeDef;
+
+#define DMA_CCR_EN                      ((uint32_t)0x00000001)
+#define DMA_DIR_PeripheralDST           ((uint32_t)0x00000010)
+#define DMA_DIR_PeripheralSRC           ((uint32_t)0x00000000)
+#define DMA_Mode_Circular               ((uint32_t)0x00000020)
+#define DMA_Mode_Normal                 ((uint32_t)0x00000000)
+#define DMA_PeripheralInc_Enable        ((uint32_t)0x00000040)
+#define DMA_PeripheralInc_Disable       ((uint32_t)0x00000000)
+#define DMA_MemoryInc_Enable            ((uint32_t)0x00000080)
+#define DMA_MemoryInc_Disable           ((uint32_t)0x00000000)
+#define DMA_PeripheralDataSize_Byte     ((uint32_t)0x00000000)
+#define DMA_PeripheralDataSize_HalfWord ((uint32_t)0x00000100)
+#define DMA_PeripheralDataSize_Word     ((uint32_t)0x00000200)
+#define DMA_MemoryDataSize_Byte         ((uint32_t)0x00000000)
+#define DMA_MemoryDataSize_HalfWord     ((uint32_t)0x00000400)
+#define DMA_MemoryDataSize_Word         ((uint32_t)0x00000800)
+#define DMA_Priority_VeryHigh           ((uint32_t)0x00003000)
+#define DMA_Priority_High               ((uint32_t)0x00002000)
+#define DMA_Priority_Medium             ((uint32_t)0x00001000)
+#define DMA_Priority_Low                ((uint32_t)0x00000000)
+#define DMA_M2M_Enable                  ((uint32_t)0x00004000)
+#define DMA_M2M_Disable                 ((uint32_t)0x00000000)
+
+#define DMA_IT_TC                       ((uint32_t)0x00000002)
+#define DMA_IT_HT                       ((uint32_t)0x00000004)
+#define DMA_IT_TE                       ((uint32_t)0x00000008)
+
+#define DMA1_IT_GL4                     ((uint32_t)0x00001000)
+#define DMA1_IT_TC4                     ((uint32_t)0x00002000)
+#define DMA1_IT_HT4                     ((uint32_t)0x00004000)
+
+void DMA_DeInit(DMA_Channel_TypeDef* DMAy_Channelx);
+void DMA_Init(
+    DMA_Channel_TypeDef* DMAy_Channelx, DMA_InitTypeDef* DMA_InitStruct);
+void DMA_Cmd(DMA_Channel_TypeDef* DMAy_Channelx, FunctionalState NewState);
+void DMA_ITConfig(
+    DMA_Channel_TypeDef* DMAy_Channelx, uint32_t DMA_IT,
+    FunctionalState NewState);
+ITStatus DMA_GetITStatus(uint32_t DMAy_IT);
+void DMA_ClearITPendingBit(uint32_t DMAy_IT);
+
+// SPI
+
+typedef struct {
+  uint16_t SPI_Direction;
+  uint16_t SPI_Mode;
+  uint16_t SPI_DataSize;
+  uint16_t SPI_CPOL;
+  uint16_t SPI_CPHA;
+  uint16_t SPI_NSS;
+  uint16_t SPI_BaudRatePrescaler;
+  uint16_t SPI_FirstBit;
+  uint16_t SPI_CRCPolynomial;
+} SPI_InitTypeDef;
+
+#define SPI_Direction_2Lines_FullDuplex ((uint16_t)0x0000)
+#define SPI_Mode_Master                 ((uint16_t)0x0104)
+#define SPI_DataSize_16b                ((uint16_t)0x0800)
+#define SPI_CPOL_High                   ((uint16_t)0x0002)
+#define SPI_CPHA_1Edge                  ((uint16_t)0x0000)
+#define SPI_NSS_Soft                    ((uint16_t)0x0200)
+#define SPI_BaudRatePrescaler_2         ((uint16_t)0x0000)
+#define SPI_FirstBit_MSB                ((uint16_t)0x0000)
+
+void SPI_Init(SPI_TypeDef* SPIx, SPI_InitTypeDef* SPI_InitStruct);
+void SPI_Cmd(SPI_TypeDef* SPIx, FunctionalState NewState);
+
+// USART
+
+typedef struct {
+  uint32_t USART_BaudRate;
+  uint16_t USART_WordLength;
+  uint16_t USART_StopBits;
+  uint16_t USART_Parity;
+  uint16_t USART_Mode;
+  uint16_t USART_HardwareFlowControl;
+} USART_InitTypeDef;
+
+#define USART_WordLength_8b             ((uint16_t)0x0000)
+#define USART_StopBits_1                ((uint16_t)0x0000)
+#define USART_Parity_No                 ((uint16_t)0x0000)
+#define USART_Mode_Rx                   ((uint16_t)0x0004)
+#define USART_Mode_Tx                   ((uint16_t)0x0008)
+#define USART_HardwareFlowControl_None  ((uint16_t)0x0000)
+#define USART_FLAG_TXE                  ((uint16_t)0x0080)
+#define USART_FLAG_RXNE                 ((uint16_t)0x0020)
+
+void USART_Init(USART_TypeDef* USARTx, USART_InitTypeDef* USART_InitStruct);
+void USART_Cmd(USART_TypeDef* USARTx, FunctionalState NewState);
+
+// Host side: hardware events
+//
+// Timer events with their DMA request enabled are served by the DMA1 channel
+// they are wired to, as in the request mapping table of the reference manual.
+
+// Puts every peripheral back in its reset state, as after a power cycle.
+void MockResetPeripherals(void);
+
+// Counts the timer up, one tick at a time, setting the update and compare
+// flags it reaches, and calls the handler whenever an enabled one is pending.
+void MockCountTimer(
+    TIM_TypeDef* TIMx, uint32_t num_ticks, void (*handler)(void));
+
+// Runs the timer for whole update periods. Each period raises the compare
+// events in counter order, then the update event.
+void MockRunTimer(TIM_TypeDef* TIMx, uint32_t num_periods);
+
+// Words written by the DMA to peripheral registers, with the GPIOB output
+// register as it stood right after each write. Only logged between start and
+// stop, so that long runs do not accumulate them.
+struct MockBusWrite {
+  uint32_t address;
+  uint32_t value;
+  uint32_t gpiob_odr;
+};
+
+// Bus address of a register or a RAM buffer, to hand to the DMA. Registers
+// keep their own addresses. Each buffer gets a window of the SRAM region,
+// since a host pointer need not fit in 32 bits.
+uint32_t MockDmaAddress(const volatile void* pointer);
+
+void MockStartBusLog(void);
+void MockStopBusLog(void);
+uint32_t MockBusLogSize(void);
+const MockBusWrite& MockBusLog(uint32_t index);
+
+#endif  // YARNS_TEST_STM32_MOCK_STM32F10X_CONF_H_
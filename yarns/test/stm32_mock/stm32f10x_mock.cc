@@ -0,0 +1,520 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Register-level stand-in for the STM32F10x standard peripheral library.
+
+#include "stm32f10x_conf.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Maps the peripherals at their real addresses before anything runs.
+struct PeripheralMemory {
+  PeripheralMemory() {
+    void* base = reinterpret_cast<void*>(PERIPH_BASE);
+    void* memory = mmap(
+        base, PERIPH_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (memory != base) {
+      fprintf(stderr, "Cannot map the peripherals at %p\n", base);
+      exit(1);
+    }
+  }
+};
+
+PeripheralMemory peripheral_memory;
+
+}  // namespace
+
+// GPIO
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct) {
+  uint32_t mode = GPIO_InitStruct->GPIO_Mode & 0x0f;
+  if (GPIO_InitStruct->GPIO_Mode & 0x10) {
+    mode |= GPIO_InitStruct->GPIO_Speed;
+  }
+  for (uint8_t pin = 0; pin < 16; ++pin) {
+    if (!(GPIO_InitStruct->GPIO_Pin & (1 << pin))) {
+      continue;
+    }
+    __IO uint32_t* config = pin < 8 ? &GPIOx->CRL : &GPIOx->CRH;
+    uint8_t shift = (pin & 7) * 4;
+    *config = (*config & ~(0xf << shift)) | (mode << shift);
+    if (GPIO_InitStruct->GPIO_Mode == GPIO_Mode_IPU) {
+      GPIOx->ODR |= 1 << pin;
+      GPIOx->IDR |= 1 << pin;
+    } else if (GPIO_InitStruct->GPIO_Mode == GPIO_Mode_IPD) {
+      GPIOx->ODR &= ~(1 << pin);
+    }
+  }
+}
+
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+  return GPIOx->IDR & GPIO_Pin ? Bit_SET : Bit_RESET;
+}
+
+void GPIO_WriteBit(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, BitAction BitVal) {
+  if (BitVal != Bit_RESET) {
+    GPIOx->ODR |= GPIO_Pin;
+  } else {
+    GPIOx->ODR &= ~GPIO_Pin;
+  }
+}
+
+// RCC, NVIC, SysTick: clocks and interrupts are driven by the tests.
+
+void RCC_AHBPeriphClockCmd(uint32_t, FunctionalState) { }
+void RCC_APB2PeriphClockCmd(uint32_t, FunctionalState) { }
+void RCC_APB1PeriphClockCmd(uint32_t, FunctionalState) { }
+void NVIC_Init(NVIC_InitTypeDef*) { }
+void NVIC_SetVectorTable(uint32_t, uint32_t) { }
+void NVIC_PriorityGroupConfig(uint32_t) { }
+uint32_t SysTick_Config(uint32_t) { return 0; }
+void SystemInit(void) { }
+
+// Timers
+
+void TIM_TimeBaseInit(
+    TIM_TypeDef* TIMx, TIM_TimeBaseInitTypeDef* TIM_TimeBaseInitStruct) {
+  TIMx->CR1 = (TIMx->CR1 & ~0x0370) |
+      TIM_TimeBaseInitStruct->TIM_CounterMode |
+      TIM_TimeBaseInitStruct->TIM_ClockDivision;
+  TIMx->ARR = TIM_TimeBaseInitStruct->TIM_Period;
+  TIMx->PSC = TIM_TimeBaseInitStruct->TIM_Prescaler;
+  if (TIMx == TIM1) {
+    TIMx->RCR = TIM_TimeBaseInitStruct->TIM_RepetitionCounter;
+  }
+  TIMx->EGR = 0x0001;
+}
+
+void TIM_InternalClockConfig(TIM_TypeDef* TIMx) {
+  TIMx->SMCR &= ~0x0007;
+}
+
+void TIM_Cmd(TIM_TypeDef* TIMx, FunctionalState NewState) {
+  if (NewState != DISABLE) {
+    TIMx->CR1 |= 0x0001;
+  } else {
+    TIMx->CR1 &= ~0x0001;
+  }
+}
+
+void TIM_OCStructInit(TIM_OCInitTypeDef* TIM_OCInitStruct) {
+  TIM_OCInitStruct->TIM_OCMode = TIM_OCMode_Timing;
+  TIM_OCInitStruct->TIM_OutputState = 0;
+  TIM_OCInitStruct->TIM_OutputNState = 0;
+  TIM_OCInitStruct->TIM_Pulse = 0;
+  TIM_OCInitStruct->TIM_OCPolarity = 0;
+  TIM_OCInitStruct->TIM_OCNPolarity = 0;
+  TIM_OCInitStruct->TIM_OCIdleState = 0;
+  TIM_OCInitStruct->TIM_OCNIdleState = 0;
+}
+
+void TIM_OC1Init(TIM_TypeDef* TIMx, TIM_OCInitTypeDef* TIM_OCInitStruct) {
+  TIMx->CCMR1 = (TIMx->CCMR1 & 0xff00) | TIM_OCInitStruct->TIM_OCMode;
+  TIMx->CCR1 = TIM_OCInitStruct->TIM_Pulse;
+}
+
+void TIM_OC2Init(TIM_TypeDef* TIMx, TIM_OCInitTypeDef* TIM_OCInitStruct) {
+  TIMx->CCMR1 = (TIMx->CCMR1 & 0x00ff) | (TIM_OCInitStruct->TIM_OCMode << 8);
+  TIMx->CCR2 = TIM_OCInitStruct->TIM_Pulse;
+}
+
+void TIM_OC3Init(TIM_TypeDef* TIMx, TIM_OCInitTypeDef* TIM_OCInitStruct) {
+  TIMx->CCMR2 = (TIMx->CCMR2 & 0xff00) | TIM_OCInitStruct->TIM_OCMode;
+  TIMx->CCR3 = TIM_OCInitStruct->TIM_Pulse;
+}
+
+void TIM_OC4Init(TIM_TypeDef* TIMx, TIM_OCInitTypeDef* TIM_OCInitStruct) {
+  TIMx->CCMR2 = (TIMx->CCMR2 & 0x00ff) | (TIM_OCInitStruct->TIM_OCMode << 8);
+  TIMx->CCR4 = TIM_OCInitStruct->TIM_Pulse;
+}
+
+void TIM_SetCompare1(TIM_TypeDef* TIMx, uint16_t Compare1) {
+  TIMx->CCR1 = Compare1;
+}
+
+void TIM_SetCompare2(TIM_TypeDef* TIMx, uint16_t Compare2) {
+  TIMx->CCR2 = Compare2;
+}
+
+void TIM_SetCompare3(TIM_TypeDef* TIMx, uint16_t Compare3) {
+  TIMx->CCR3 = Compare3;
+}
+
+void TIM_SetCompare4(TIM_TypeDef* TIMx, uint16_t Compare4) {
+  TIMx->CCR4 = Compare4;
+}
+
+void TIM_ITConfig(TIM_TypeDef* TIMx, uint16_t TIM_IT, FunctionalState NewState) {
+  if (NewState != DISABLE) {
+    TIMx->DIER |= TIM_IT;
+  } else {
+    TIMx->DIER &= ~TIM_IT;
+  }
+}
+
+ITStatus TIM_GetITStatus(TIM_TypeDef* TIMx, uint16_t TIM_IT) {
+  return (TIMx->SR & TIM_IT) && (TIMx->DIER & TIM_IT) ? SET : RESET;
+}
+
+void TIM_ClearITPendingBit(TIM_TypeDef* TIMx, uint16_t TIM_IT) {
+  TIMx->SR = ~TIM_IT & TIMx->SR;
+}
+
+void TIM_DMACmd(
+    TIM_TypeDef* TIMx, uint16_t TIM_DMASource, FunctionalState NewState) {
+  if (NewState != DISABLE) {
+    TIMx->DIER |= TIM_DMASource;
+  } else {
+    TIMx->DIER &= ~TIM_DMASource;
+  }
+}
+
+// DMA
+
+namespace {
+
+const uint8_t kNumDmaChannels = 7;
+const uint32_t kDmaChannelStride = 0x14;
+
+// Size of the transfer each channel was set up with, reloaded in circular
+// mode. The hardware keeps it in a shadow register.
+uint32_t dma_buffer_size[kNumDmaChannels];
+
+bool bus_log_enabled;
+std::vector<MockBusWrite> bus_log;
+
+uint8_t DmaChannelIndex(DMA_Channel_TypeDef* DMAy_Channelx) {
+  return (reinterpret_cast<uintptr_t>(DMAy_Channelx) - DMA1_Channel1_BASE) /
+      kDmaChannelStride;
+}
+
+DMA_Channel_TypeDef* DmaChannel(uint8_t index) {
+  return reinterpret_cast<DMA_Channel_TypeDef*>(
+      DMA1_Channel1_BASE + index * kDmaChannelStride);
+}
+
+// Host buffers, each mapped to a window of the SRAM region by MockDmaAddress.
+const uint32_t kSramBase = 0x20000000;
+const uint32_t kSramWindowSize = 0x10000;
+std::vector<uintptr_t> sram_windows;
+
+void* HostPointer(uint32_t address) {
+  uint32_t window = (address - kSramBase) / kSramWindowSize;
+  if (address >= kSramBase && window < sram_windows.size()) {
+    return reinterpret_cast<void*>(
+        sram_windows[window] + (address - kSramBase) % kSramWindowSize);
+  }
+  return reinterpret_cast<void*>(address);
+}
+
+uint32_t BusRead(uint32_t address, uint8_t size) {
+  uint32_t value = 0;
+  memcpy(&value, HostPointer(address), size);
+  return value;
+}
+
+void BusWrite(uint32_t address, uint32_t value, uint8_t size) {
+  GPIO_TypeDef* const ports[] = { GPIOA, GPIOB, GPIOC };
+  bool written = false;
+  for (uint8_t i = 0; i < 3; ++i) {
+    if (address == reinterpret_cast<uintptr_t>(&ports[i]->BSRR)) {
+      ports[i]->ODR = (ports[i]->ODR & ~(value >> 16)) | (value & 0xffff);
+      written = true;
+    } else if (address == reinterpret_cast<uintptr_t>(&ports[i]->BRR)) {
+      ports[i]->ODR &= ~(value & 0xffff);
+      written = true;
+    }
+  }
+  if (!written) {
+    memcpy(HostPointer(address), &value, size);
+  }
+}
+
+void DmaTransfer(uint8_t index) {
+  DMA_Channel_TypeDef* channel = DmaChannel(index);
+  uint32_t ccr = channel->CCR;
+  if (!(ccr & DMA_CCR_EN) || !channel->CNDTR) {
+    return;
+  }
+  uint32_t done = dma_buffer_size[index] - channel->CNDTR;
+  uint8_t peripheral_size = 1 << ((ccr >> 8) & 3);
+  uint8_t memory_size = 1 << ((ccr >> 10) & 3);
+  uint32_t peripheral = channel->CPAR;
+  if (ccr & DMA_PeripheralInc_Enable) {
+    peripheral += done * peripheral_size;
+  }
+  uint32_t memory = channel->CMAR;
+  if (ccr & DMA_MemoryInc_Enable) {
+    memory += done * memory_size;
+  }
+  if (ccr & DMA_DIR_PeripheralDST) {
+    uint32_t value = BusRead(memory, memory_size);
+    BusWrite(peripheral, value, peripheral_size);
+    if (bus_log_enabled) {
+      MockBusWrite write = { peripheral, value, GPIOB->ODR };
+      bus_log.push_back(write);
+    }
+  } else {
+    BusWrite(memory, BusRead(peripheral, peripheral_size), memory_size);
+  }
+
+  uint32_t flags = 0;
+  if (--channel->CNDTR == dma_buffer_size[index] / 2) {
+    flags |= DMA_IT_HT;
+  }
+  if (channel->CNDTR == 0) {
+    flags |= DMA_IT_TC;
+    if (ccr & DMA_Mode_Circular) {
+      channel->CNDTR = dma_buffer_size[index];
+    }
+  }
+  if (flags) {
+    // Global flag, then transfer complete, half transfer and error.
+    DMA1->ISR |= (flags | 1) << (4 * index);
+  }
+}
+
+}  // namespace
+
+uint32_t MockDmaAddress(const volatile void* pointer) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+  if (address >= PERIPH_BASE && address < PERIPH_BASE + PERIPH_SIZE) {
+    return address;
+  }
+  // A buffer already mapped, or one inside it
+  for (uint32_t i = 0; i < sram_windows.size(); ++i) {
+    if (address >= sram_windows[i] &&
+        address - sram_windows[i] < kSramWindowSize) {
+      return kSramBase + i * kSramWindowSize + (address - sram_windows[i]);
+    }
+  }
+  sram_windows.push_back(address);
+  return kSramBase + (sram_windows.size() - 1) * kSramWindowSize;
+}
+
+void DMA_DeInit(DMA_Channel_TypeDef* DMAy_Channelx) {
+  DMAy_Channelx->CCR &= ~DMA_CCR_EN;
+  DMAy_Channelx->CCR = 0;
+  DMAy_Channelx->CNDTR = 0;
+  DMAy_Channelx->CPAR = 0;
+  DMAy_Channelx->CMAR = 0;
+  DMA1->ISR &= ~(0xf << (4 * DmaChannelIndex(DMAy_Channelx)));
+}
+
+void DMA_Init(
+    DMA_Channel_TypeDef* DMAy_Channelx, DMA_InitTypeDef* DMA_InitStruct) {
+  // Like the library, this keeps the enable and interrupt bits as they are
+  DMAy_Channelx->CCR = (DMAy_Channelx->CCR & 0xffff800f) |
+      DMA_InitStruct->DMA_DIR | DMA_InitStruct->DMA_Mode |
+      DMA_InitStruct->DMA_PeripheralInc | DMA_InitStruct->DMA_MemoryInc |
+      DMA_InitStruct->DMA_PeripheralDataSize |
+      DMA_InitStruct->DMA_MemoryDataSize |
+      DMA_InitStruct->DMA_Priority | DMA_InitStruct->DMA_M2M;
+  // The count and addresses are read-only while the channel is enabled
+  if (DMAy_Channelx->CCR & DMA_CCR_EN) {
+    return;
+  }
+  DMAy_Channelx->CNDTR = DMA_InitStruct->DMA_BufferSize;
+  dma_buffer_size[DmaChannelIndex(DMAy_Channelx)] =
+      DMA_InitStruct->DMA_BufferSize;
+  DMAy_Channelx->CPAR = DMA_InitStruct->DMA_PeripheralBaseAddr;
+  DMAy_Channelx->CMAR = DMA_InitStruct->DMA_MemoryBaseAddr;
+}
+
+void DMA_Cmd(DMA_Channel_TypeDef* DMAy_Channelx, FunctionalState NewState) {
+  if (NewState != DISABLE) {
+    DMAy_Channelx->CCR |= DMA_CCR_EN;
+  } else {
+    DMAy_Channelx->CCR &= ~DMA_CCR_EN;
+  }
+}
+
+void DMA_ITConfig(
+    DMA_Channel_TypeDef* DMAy_Channelx, uint32_t DMA_IT,
+    FunctionalState NewState) {
+  if (NewState != DISABLE) {
+    DMAy_Channelx->CCR |= DMA_IT;
+  } else {
+    DMAy_Channelx->CCR &= ~DMA_IT;
+  }
+}
+
+ITStatus DMA_GetITStatus(uint32_t DMAy_IT) {
+  return DMA1->ISR & DMAy_IT ? SET : RESET;
+}
+
+void DMA_ClearITPendingBit(uint32_t DMAy_IT) {
+  DMA1->ISR &= ~DMAy_IT;
+}
+
+// SPI
+
+void SPI_Init(SPI_TypeDef* SPIx, SPI_InitTypeDef* SPI_InitStruct) {
+  SPIx->CR1 = (SPIx->CR1 & 0x3040) |
+      SPI_InitStruct->SPI_Direction | SPI_InitStruct->SPI_Mode |
+      SPI_InitStruct->SPI_DataSize | SPI_InitStruct->SPI_CPOL |
+      SPI_InitStruct->SPI_CPHA | SPI_InitStruct->SPI_NSS |
+      SPI_InitStruct->SPI_BaudRatePrescaler | SPI_InitStruct->SPI_FirstBit;
+  SPIx->CRCPR = SPI_InitStruct->SPI_CRCPolynomial;
+}
+
+void SPI_Cmd(SPI_TypeDef* SPIx, FunctionalState NewState) {
+  if (NewState != DISABLE) {
+    SPIx->CR1 |= 0x0040;
+  } else {
+    SPIx->CR1 &= ~0x0040;
+  }
+}
+
+// USART
+
+void USART_Init(USART_TypeDef* USARTx, USART_InitTypeDef* USART_InitStruct) {
+  USARTx->CR1 = (USARTx->CR1 & 0xe9f3) |
+      USART_InitStruct->USART_WordLength | USART_InitStruct->USART_Parity |
+      USART_InitStruct->USART_Mode;
+  USARTx->CR2 = (USARTx->CR2 & 0xcfff) | USART_InitStruct->USART_StopBits;
+  USARTx->CR3 = (USARTx->CR3 & 0xfcff) |
+      USART_InitStruct->USART_HardwareFlowControl;
+  // The transmitter is always ready on the host
+  USARTx->SR = USART_FLAG_TXE;
+}
+
+void USART_Cmd(USART_TypeDef* USARTx, FunctionalState NewState) {
+  if (NewState != DISABLE) {
+    USARTx->CR1 |= 0x2000;
+  } else {
+    USARTx->CR1 &= ~0x2000;
+  }
+}
+
+// Host side: hardware events
+
+namespace {
+
+// DMA1 channel serving each timer event, numbered from 1: update, then
+// compare 1 to 4. 0 when the event has no request.
+struct TimerDmaRequests {
+  TIM_TypeDef* timer;
+  uint8_t channel[5];
+};
+
+const TimerDmaRequests timer_dma_requests[] = {
+  { TIM1, { 5, 2, 3, 6, 4 } },
+  { TIM2, { 2, 5, 7, 1, 7 } },
+  { TIM4, { 7, 1, 4, 5, 0 } },
+};
+
+void RaiseTimerEvents(TIM_TypeDef* TIMx, uint16_t flags) {
+  TIMx->SR |= flags;
+  for (const TimerDmaRequests& requests : timer_dma_requests) {
+    if (requests.timer != TIMx) {
+      continue;
+    }
+    for (uint8_t event = 0; event < 5; ++event) {
+      uint16_t flag = 1 << event;
+      if ((flags & flag) && (TIMx->DIER & (flag << 8)) &&
+          requests.channel[event]) {
+        DmaTransfer(requests.channel[event] - 1);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void MockResetPeripherals(void) {
+  memset(reinterpret_cast<void*>(PERIPH_BASE), 0, PERIPH_SIZE);
+  std::fill(&dma_buffer_size[0], &dma_buffer_size[kNumDmaChannels], 0);
+  bus_log_enabled = false;
+  bus_log.clear();
+}
+
+void MockCountTimer(
+    TIM_TypeDef* TIMx, uint32_t num_ticks, void (*handler)(void)) {
+  while (num_ticks-- && (TIMx->CR1 & 0x0001)) {
+    uint16_t count = TIMx->CNT == TIMx->ARR ? 0 : TIMx->CNT + 1;
+    TIMx->CNT = count;
+    uint16_t flags = count == 0 ? TIM_IT_Update : 0;
+    flags |= count == TIMx->CCR1 ? TIM_IT_CC1 : 0;
+    flags |= count == TIMx->CCR2 ? TIM_IT_CC2 : 0;
+    flags |= count == TIMx->CCR3 ? TIM_IT_CC3 : 0;
+    flags |= count == TIMx->CCR4 ? TIM_IT_CC4 : 0;
+    RaiseTimerEvents(TIMx, flags);
+    if (handler && (TIMx->SR & TIMx->DIER & 0x001f)) {
+      handler();
+    }
+  }
+}
+
+void MockRunTimer(TIM_TypeDef* TIMx, uint32_t num_periods) {
+  while (num_periods-- && (TIMx->CR1 & 0x0001)) {
+    uint16_t compare[4] = { TIMx->CCR1, TIMx->CCR2, TIMx->CCR3, TIMx->CCR4 };
+    uint8_t order[4] = { 0, 1, 2, 3 };
+    // Stable, so that equal compare values keep the channel order
+    for (uint8_t i = 1; i < 4; ++i) {
+      for (uint8_t j = i; j > 0 && compare[order[j]] < compare[order[j - 1]];
+          --j) {
+        uint8_t swap = order[j];
+        order[j] = order[j - 1];
+        order[j - 1] = swap;
+      }
+    }
+    for (uint8_t i = 0; i < 4; ++i) {
+      if (compare[order[i]] <= TIMx->ARR) {
+        TIMx->CNT = compare[order[i]];
+        RaiseTimerEvents(TIMx, TIM_IT_CC1 << order[i]);
+      }
+    }
+    TIMx->CNT = 0;
+    RaiseTimerEvents(TIMx, TIM_IT_Update);
+  }
+}
+
+void MockStartBusLog(void) {
+  bus_log.clear();
+  bus_log_enabled = true;
+}
+
+void MockStopBusLog(void) {
+  bus_log_enabled = false;
+}
+
+uint32_t MockBusLogSize(void) {
+  return bus_log.size();
+}
+
+const MockBusWrite& MockBusLog(uint32_t index) {
+  return bus_log[index];
+}
@@ -0,0 +1,1909 @@
+// Copyright 2020 Chris Rogers.
+//
+// Author: Chris Rogers (teukros@gmail.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// See http://creativecommons.org/licenses/MIT/ for more information.
+//
+// -----------------------------------------------------------------------------
+//
+// Host tests for the Yarns firmware.
+
+#include <stm32f10x_conf.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "stmlib/utils/random.h"
+#include "stmlib/utils/stream_buffer.h"
+
+#include "yarns/drivers/dac.h"
+#include "yarns/drivers/display.h"
+#include "yarns/drivers/gate_output.h"
+#include "yarns/midi_handler.h"
+#include "yarns/multi.h"
+#include "yarns/oscillator.h"
+#include "yarns/part.h"
+#include "yarns/resources.h"
+#include "yarns/settings.h"
+#include "yarns/storage_manager.h"
+#include "yarns/voice.h"
+
+using namespace stmlib;
+using namespace yarns;
+
+// From yarns.cc
+extern Dac dac;
+extern GateOutput gate_output;
+void Init();
+void RunLowPriorityTasks();
+
+extern "C" {
+extern bool has_audio_source[kNumChannels];
+extern bool has_envelope[kNumChannels];
+extern bool gate[kNumGateOutputs];
+extern uint16_t gate_time[kNumGateOutputs];
+void SysTick_Handler();
+void TIM2_IRQHandler();
+void DMA1_Channel4_IRQHandler();
+}
+
+const uint32_t kFrameRate = 40000;
+const uint32_t kMidiByteRate = 31250 / 10;
+
+inline uint64_t Nanoseconds() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<uint64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+const uint16_t kGatePins[kNumGateOutputs] = {
+  GPIO_Pin_10, GPIO_Pin_11, GPIO_Pin_0, GPIO_Pin_1
+};
+
+// A gate level change, in microseconds since the simulator was initialized.
+// For the levels the refresh hands to the gate scheduler, |due| is when the
+// edge should reach the output.
+struct GateEvent {
+  uint8_t channel;
+  bool level;
+  uint32_t time;
+  uint32_t due;
+};
+
+class FirmwareSimulator;
+extern FirmwareSimulator simulator;
+
+// Runs the firmware one 40kHz DAC frame at a time, with each interrupt at its
+// hardware rate: TIM2 counting microseconds, SysTick at 8kHz, and TIM1
+// driving the DAC DMA, which asks for a refill every kDacBlockSize frames. The main loop gets one pass after
+// each SysTick. MIDI input arrives on USART1 at the wire rate.
+class FirmwareSimulator {
+ public:
+  void Init() {
+    MockResetPeripherals();
+    ::Init();
+    frame_ = 0;
+    midi_phase_ = 0;
+    midi_input_ = NULL;
+    midi_input_size_ = 0;
+    max_main_loop_time_ = 0;
+    total_main_loop_time_ = 0;
+    num_main_loop_passes_ = 0;
+    logging_gates_ = false;
+  }
+
+  // The bytes must outlive the run.
+  void SetMidiInput(const uint8_t* bytes, size_t size) {
+    midi_input_ = bytes;
+    midi_input_size_ = size;
+  }
+
+  void Run(uint32_t num_frames) {
+    while (num_frames--) {
+      frame_counter_ = TIM2->CNT;
+      MockCountTimer(TIM2, 1000000 / kFrameRate, &OnGateTimer);
+
+      midi_phase_ += kMidiByteRate;
+      if (midi_phase_ >= kFrameRate) {
+        midi_phase_ -= kFrameRate;
+        if (midi_input_size_) {
+          USART1->DR = *midi_input_++;
+          USART1->SR |= USART_FLAG_RXNE;
+          --midi_input_size_;
+          if (logging_gates_) {
+            midi_arrivals_.push_back(Microseconds());
+          }
+        }
+      }
+
+      if (frame_ % (kFrameRate / 8000) == 0) {
+        SysTick_Handler();
+        ProbeGates();
+        // Reading the data register clears the flag
+        USART1->SR &= ~USART_FLAG_RXNE;
+
+        uint64_t start = Nanoseconds();
+        RunLowPriorityTasks();
+        uint64_t elapsed = Nanoseconds() - start;
+        total_main_loop_time_ += elapsed;
+        if (elapsed > max_main_loop_time_) {
+          max_main_loop_time_ = elapsed;
+        }
+        ++num_main_loop_passes_;
+      }
+      RunDac(1);
+      ++frame_;
+    }
+  }
+
+  // TIM1 paces the DAC DMA channels, one period for each channel of a frame.
+  void RunDac(uint32_t num_frames) {
+    while (num_frames--) {
+      MockRunTimer(TIM1, kNumChannels);
+      // Channel 4 flags are the fourth nibble of the status register
+      if ((DMA1->ISR >> 12) & DMA1_Channel4->CCR & (DMA_IT_HT | DMA_IT_TC)) {
+        DMA1_Channel4_IRQHandler();
+      }
+    }
+  }
+
+  // Logs the edges seen on the gate pins, the levels submitted by the
+  // refresh, and the arrival time of each MIDI byte.
+  void StartGateLog() {
+    logging_gates_ = true;
+    gate_edges_.clear();
+    gate_sources_.clear();
+    midi_arrivals_.clear();
+    for (uint8_t i = 0; i < kNumGateOutputs; ++i) {
+      output_level_[i] = GPIOB->ODR & kGatePins[i];
+      source_level_[i] = gate[i];
+    }
+  }
+
+  // Time on the TIM2 counter, which counts microseconds
+  inline uint32_t Microseconds() const {
+    return frame_ * (1000000 / kFrameRate) +
+        static_cast<uint16_t>(TIM2->CNT - frame_counter_);
+  }
+
+  inline const std::vector<GateEvent>& gate_edges() const {
+    return gate_edges_;
+  }
+  inline const std::vector<GateEvent>& gate_sources() const {
+    return gate_sources_;
+  }
+  inline const std::vector<uint32_t>& midi_arrivals() const {
+    return midi_arrivals_;
+  }
+
+  inline bool midi_input_done() const { return midi_input_size_ == 0; }
+  inline uint64_t max_main_loop_time() const { return max_main_loop_time_; }
+  inline uint64_t mean_main_loop_time() const {
+    return num_main_loop_passes_ ?
+        total_main_loop_time_ / num_main_loop_passes_ : 0;
+  }
+
+ private:
+  static void OnGateTimer() {
+    TIM2_IRQHandler();
+    simulator.ProbeGates();
+  }
+
+  void ProbeGates() {
+    if (!logging_gates_) {
+      return;
+    }
+    uint32_t now = Microseconds();
+    for (uint8_t i = 0; i < kNumGateOutputs; ++i) {
+      bool level = GPIOB->ODR & kGatePins[i];
+      if (level != output_level_[i]) {
+        output_level_[i] = level;
+        GateEvent edge = { i, level, now, now };
+        gate_edges_.push_back(edge);
+      }
+      if (gate[i] != source_level_[i]) {
+        source_level_[i] = gate[i];
+        int16_t delay = gate_time[i] + kGateLatency - TIM2->CNT;
+        GateEvent source = { i, gate[i], now, now + delay };
+        gate_sources_.push_back(source);
+      }
+    }
+  }
+
+  uint32_t frame_;
+  uint16_t frame_counter_;
+  uint32_t midi_phase_;
+  const uint8_t* midi_input_;
+  size_t midi_input_size_;
+
+  uint64_t max_main_loop_time_;
+  uint64_t total_main_loop_time_;
+  uint32_t num_main_loop_passes_;
+
+  bool logging_gates_;
+  bool output_level_[kNumGateOutputs];
+  bool source_level_[kNumGateOutputs];
+  std::vector<GateEvent> gate_edges_;
+  std::vector<GateEvent> gate_sources_;
+  std::vector<uint32_t> midi_arrivals_;
+};
+
+FirmwareSimulator simulator;
+
+bool Report(const char* test, bool pass) {
+  printf("%s: %s\n", pass ? "PASS" : "FAIL", test);
+  return pass;
+}
+
+// Settings changed from the main loop reach the firmware at the next refresh,
+// in the order they were made. A setting changed again before then only keeps
+// its last value, and a burst of more changes than the queue holds drops the
+// rest instead of waiting on the refresh.
+bool TestSettingQueue() {
+  simulator.Init();
+  Layout old_layout = multi.layout();
+  multi.ApplySetting(SETTING_LAYOUT, 0, LAYOUT_QUAD_POLY);
+  const Setting& layout = setting_defs.get(SETTING_LAYOUT);
+  bool deferred_ok = multi.layout() == old_layout &&
+      multi.GetSetting(layout, 0) == LAYOUT_QUAD_POLY;
+  multi.ApplyPendingSettings();
+  deferred_ok = deferred_ok && multi.layout() == LAYOUT_QUAD_POLY;
+
+  // A change on each side of a layout change, which must not be reordered:
+  // the new layout resets portamento
+  const Setting& portamento = setting_defs.get(SETTING_VOICING_PORTAMENTO);
+  multi.ApplySetting(portamento, 2, 10);
+  multi.ApplySetting(SETTING_LAYOUT, 0, LAYOUT_QUAD_MONO);
+  multi.ApplySetting(portamento, 2, 20);
+  multi.ApplyPendingSettings();
+  bool ordered_ok = multi.part(2).voicing_settings().portamento == 20 &&
+      multi.layout() == LAYOUT_QUAD_MONO;
+
+  // A knob turned through a hundred values before the refresh
+  for (uint8_t value = 1; value <= 100; ++value) {
+    multi.ApplySetting(portamento, 0, value);
+  }
+  bool coalesced_ok = multi.GetSetting(portamento, 0) == 100;
+  multi.ApplyPendingSettings();
+  coalesced_ok = coalesced_ok &&
+      multi.part(0).voicing_settings().portamento == 100;
+
+  // Thirty-two distinct settings in a row
+  uint8_t old_values[kNumParts][8];
+  uint8_t num_queued = 0;
+  for (uint8_t part = 0; part < kNumParts; ++part) {
+    for (uint8_t i = 0; i < 8; ++i) {
+      const Setting& setting = setting_defs.get(
+          SETTING_VOICING_ENV_INIT_ATTACK + i);
+      old_values[part][i] = multi.GetSetting(setting, part);
+      multi.ApplySetting(setting, part, (old_values[part][i] + 1) & 0x3f);
+      num_queued += multi.GetSetting(setting, part) != old_values[part][i];
+    }
+  }
+  multi.ApplyPendingSettings();
+  uint8_t num_committed = 0;
+  for (uint8_t part = 0; part < kNumParts; ++part) {
+    for (uint8_t i = 0; i < 8; ++i) {
+      const Setting& setting = setting_defs.get(
+          SETTING_VOICING_ENV_INIT_ATTACK + i);
+      num_committed += multi.GetSetting(setting, part) != old_values[part][i];
+    }
+  }
+  bool overflow_ok = num_queued == kParameterQueueSize - 1 &&
+      num_committed == num_queued;
+
+  printf(
+      "Setting queue: %d of 32 distinct changes queued, %d committed\n",
+      num_queued,
+      num_committed);
+  return Report(
+      "setting queue",
+      deferred_ok && ordered_ok && coalesced_ok && overflow_ok);
+}
+
+// A dense MPE performance: up to four fingers held at once, each on its own
+// member channel, with bend, pressure and timbre streaming between the note
+// events for as long as there are bytes left. Expression is sent ahead of
+// each note-on, as the MPE specification asks.
+class MPECapture {
+ public:
+  static const uint8_t kNumFingers = 4;
+
+  void Generate(size_t size) {
+    size_ = 0;
+    num_messages_ = 0;
+    next_channel_ = 1;
+    Random::Seed(0x4d5045);
+    for (uint8_t i = 0; i < kNumFingers; ++i) {
+      finger_[i].down = false;
+    }
+    while (size_ + 3 * 4 <= size) {
+      Finger* finger = &finger_[(Random::GetWord() >> 16) % kNumFingers];
+      uint32_t dice = (Random::GetWord() >> 16) % 64;
+      if (!finger->down) {
+        finger->channel = NextChannel();
+        finger->note = NextNote();
+        finger->bend = 8192;
+        finger->pressure = 0;
+        finger->timbre = 64;
+        Write3(0xe0 | finger->channel, finger->bend & 0x7f, finger->bend >> 7);
+        Write2(0xd0 | finger->channel, finger->pressure);
+        Write3(0xb0 | finger->channel, kCCMPETimbre, finger->timbre);
+        Write3(0x90 | finger->channel, finger->note, 100);
+        finger->down = true;
+      } else if (dice == 0 && size_ + 3 * 4 * kNumFingers < size) {
+        Write3(0x80 | finger->channel, finger->note, 0);
+        finger->down = false;
+      } else if (dice < 22) {
+        finger->bend = Walk(finger->bend, 256, 16383);
+        Write3(0xe0 | finger->channel, finger->bend & 0x7f, finger->bend >> 7);
+      } else if (dice < 43) {
+        finger->pressure = Walk(finger->pressure, 4, 127);
+        Write2(0xd0 | finger->channel, finger->pressure);
+      } else {
+        finger->timbre = Walk(finger->timbre, 4, 127);
+        Write3(0xb0 | finger->channel, kCCMPETimbre, finger->timbre);
+      }
+    }
+  }
+
+  // The gated voices must carry the pressure of the fingers still down.
+  bool Check(const Part& part) const {
+    uint8_t num_down = 0;
+    uint8_t num_matched = 0;
+    for (uint8_t i = 0; i < kNumFingers; ++i) {
+      if (!finger_[i].down) {
+        continue;
+      }
+      ++num_down;
+      for (uint8_t v = 0; v < part.num_voices(); ++v) {
+        const Voice* voice = part.voice(v);
+        if (voice->gate() &&
+            voice->mod_aux(MOD_AUX_AFTERTOUCH) >> 9 == finger_[i].pressure) {
+          ++num_matched;
+          break;
+        }
+      }
+    }
+    uint8_t num_gated = 0;
+    for (uint8_t v = 0; v < part.num_voices(); ++v) {
+      num_gated += part.voice(v)->gate() ? 1 : 0;
+    }
+    return num_down == num_gated && num_down == num_matched;
+  }
+
+  inline const uint8_t* bytes() const { return bytes_; }
+  inline size_t size() const { return size_; }
+  inline size_t num_messages() const { return num_messages_; }
+
+ private:
+  struct Finger {
+    bool down;
+    uint8_t channel;
+    uint8_t note;
+    uint16_t bend;
+    uint8_t pressure;
+    uint8_t timbre;
+  };
+
+  uint8_t NextChannel() {
+    // Member channels 2-16, skipping the ones held by other fingers
+    while (true) {
+      uint8_t channel = next_channel_;
+      next_channel_ = next_channel_ == 15 ? 1 : next_channel_ + 1;
+      bool taken = false;
+      for (uint8_t i = 0; i < kNumFingers; ++i) {
+        taken = taken || (finger_[i].down && finger_[i].channel == channel);
+      }
+      if (!taken) {
+        return channel;
+      }
+    }
+  }
+
+  uint8_t NextNote() {
+    // Over a fifth, so that fingers often land on the same pitch
+    return 60 + (Random::GetWord() >> 16) % 8;
+  }
+
+  int32_t Walk(int32_t value, int32_t step, int32_t max) {
+    value += static_cast<int32_t>((Random::GetWord() >> 16) % (2 * step + 1)) -
+        step;
+    CONSTRAIN(value, 0, max);
+    return value;
+  }
+
+  void Write2(uint8_t a, uint8_t b) {
+    bytes_[size_++] = a;
+    bytes_[size_++] = b;
+    ++num_messages_;
+  }
+
+  void Write3(uint8_t a, uint8_t b, uint8_t c) {
+    bytes_[size_++] = a;
+    bytes_[size_++] = b;
+    bytes_[size_++] = c;
+    ++num_messages_;
+  }
+
+  static const size_t kMaxSize = 65536;
+
+  uint8_t bytes_[kMaxSize];
+  size_t size_;
+  size_t num_messages_;
+  Finger finger_[kNumFingers];
+  uint8_t next_channel_;
+};
+
+MPECapture mpe_capture;
+
+void SetUpMPE() {
+  simulator.Init();
+  multi.ApplySetting(SETTING_LAYOUT, 0, LAYOUT_QUAD_POLY);
+  multi.ApplySetting(SETTING_MIDI_CHANNEL, 0, kMidiChannelMPE);
+  // Committed by the next refresh, which the burst test does not run
+  multi.ApplyPendingSettings();
+}
+
+bool TestMPEThroughput() {
+  // Ten seconds of a saturated MIDI link, replayed at the wire rate
+  mpe_capture.Generate(10 * kMidiByteRate);
+  SetUpMPE();
+  simulator.SetMidiInput(mpe_capture.bytes(), mpe_capture.size());
+  uint32_t num_frames = 0;
+  uint64_t start = Nanoseconds();
+  while (!simulator.midi_input_done()) {
+    simulator.Run(kFrameRate / 100);
+    num_frames += kFrameRate / 100;
+  }
+  simulator.Run(kFrameRate / 100);
+  uint64_t elapsed = Nanoseconds() - start;
+  bool wire_rate_ok = mpe_capture.Check(multi.part(0));
+  printf(
+      "MPE at wire rate: %zu messages in %.2fs, simulated in %.1f ms, "
+      "main loop pass mean %llu ns, max %llu ns\n",
+      mpe_capture.num_messages(),
+      static_cast<float>(num_frames) / kFrameRate,
+      elapsed / 1e6f,
+      static_cast<unsigned long long>(simulator.mean_main_loop_time()),
+      static_cast<unsigned long long>(simulator.max_main_loop_time()));
+
+  // The same capture handed to the MIDI handler as fast as it digests it,
+  // to see how much headroom is left above the wire rate.
+  SetUpMPE();
+  const uint8_t* bytes = mpe_capture.bytes();
+  size_t remaining = mpe_capture.size();
+  start = Nanoseconds();
+  while (remaining) {
+    // Less than the input buffer holds, so nothing gets overwritten
+    size_t chunk = remaining < 96 ? remaining : 96;
+    for (size_t i = 0; i < chunk; ++i) {
+      midi_handler.PushByte(*bytes++);
+    }
+    remaining -= chunk;
+    midi_handler.ProcessInput();
+    multi.LowPriority();
+  }
+  elapsed = Nanoseconds() - start;
+  simulator.Run(kFrameRate / 100);
+  bool burst_ok = mpe_capture.Check(multi.part(0));
+  printf(
+      "MPE as fast as possible: %.0f messages/s, %.1fx the wire rate\n",
+      1e9f * mpe_capture.num_messages() / elapsed,
+      1e9f * mpe_capture.size() / elapsed / kMidiByteRate);
+  return Report("MPE throughput", wire_rate_ok && burst_ok);
+}
+
+// Sends a channel message straight to the MIDI handler.
+void SendMessage(uint8_t status, uint8_t data_1) {
+  midi_handler.PushByte(status);
+  midi_handler.PushByte(data_1);
+  midi_handler.ProcessInput();
+}
+
+void SendMessage(uint8_t status, uint8_t data_1, uint8_t data_2) {
+  midi_handler.PushByte(status);
+  midi_handler.PushByte(data_1);
+  midi_handler.PushByte(data_2);
+  midi_handler.ProcessInput();
+}
+
+uint8_t NumGatedVoices(const Part& part) {
+  uint8_t num_gated = 0;
+  for (uint8_t v = 0; v < part.num_voices(); ++v) {
+    num_gated += part.voice(v)->gate() ? 1 : 0;
+  }
+  return num_gated;
+}
+
+// Two fingers on the same pitch, on their own member channels, are two notes:
+// each gets a voice and its own pressure, and releasing either one leaves the
+// other sounding. On a monophonic part, they share the voice until both are
+// released.
+bool TestMPESharedPitch() {
+  SetUpMPE();
+  const Part& part = multi.part(0);
+  SendMessage(0xd1, 30);  // Pressure of the finger on channel 2...
+  SendMessage(0x91, 60, 100);
+  SendMessage(0xd2, 90);  // ...and of the one on channel 3
+  SendMessage(0x92, 60, 100);
+  bool poly_ok = NumGatedVoices(part) == 2;
+  SendMessage(0x81, 60, 0);
+  uint8_t remaining_pressure = 0;
+  for (uint8_t v = 0; v < part.num_voices(); ++v) {
+    if (part.voice(v)->gate()) {
+      remaining_pressure = part.voice(v)->mod_aux(MOD_AUX_AFTERTOUCH) >> 9;
+    }
+  }
+  poly_ok = poly_ok && NumGatedVoices(part) == 1 && remaining_pressure == 90;
+  SendMessage(0x82, 60, 0);
+  poly_ok = poly_ok && NumGatedVoices(part) == 0 && !part.has_notes();
+
+  // The hold pedal, on the master channel, keeps a released finger's note
+  SendMessage(0x91, 60, 100);
+  SendMessage(0xb0, stmlib_midi::kCCHoldPedal, 127);
+  SendMessage(0x81, 60, 0);
+  bool sustain_ok = NumGatedVoices(part) == 1;
+  SendMessage(0xb0, stmlib_midi::kCCHoldPedal, 0);
+  sustain_ok = sustain_ok && NumGatedVoices(part) == 0;
+
+  multi.ApplySetting(SETTING_LAYOUT, 0, LAYOUT_MONO);
+  multi.ApplyPendingSettings();
+  SendMessage(0x91, 60, 100);
+  SendMessage(0x92, 60, 100);
+  SendMessage(0x81, 60, 0);
+  bool mono_ok = NumGatedVoices(part) == 1;
+  SendMessage(0x82, 60, 0);
+  mono_ok = mono_ok && NumGatedVoices(part) == 0;
+
+  return Report("MPE shared pitch", poly_ok && sustain_ok && mono_ok);
+}
+
+// The main loop has to keep up with SysTick, which feeds it at 8kHz.
+const uint64_t kSysTickPeriod = 1000000000 / 8000;
+
+// Host timing is noisy, so each scenario reports the run with the lowest
+// mean out of several.
+const uint8_t kMainLoopRuns = 5;
+
+const char* const main_loop_scenarios[] = {
+  // Nothing but the UI polling its controls and the idle flashes
+  "idle",
+  // Recording status is polled, and formatted once per display refresh
+  "sequencer recording",
+  // Setting changes by CC, at the wire rate, which the UI shows live
+  "CC stream",
+};
+
+// Runs one second of a scenario from a fresh start, and returns whether it
+// played out as set up.
+bool RunMainLoopScenario(uint8_t scenario) {
+  static uint8_t cc_stream[kMidiByteRate / 3 * 3];
+  simulator.Init();
+  bool ok = true;
+  switch (scenario) {
+    case 1:
+      multi.ApplySetting(SETTING_SEQUENCER_PLAY_MODE, 0, PLAY_MODE_SEQUENCER);
+      multi.ApplyPendingSettings();
+      multi.Start(false);
+      multi.StartRecording(0);
+      simulator.Run(kFrameRate);
+      ok = multi.recording();
+      multi.StopRecording(0);
+      multi.Stop();
+      break;
+    case 2:
+      for (size_t i = 0; i < sizeof(cc_stream); i += 3) {
+        cc_stream[i] = 0xb0;
+        cc_stream[i + 1] = 5;  // Portamento
+        cc_stream[i + 2] = (i / 3) & 0x7f;
+      }
+      simulator.SetMidiInput(cc_stream, sizeof(cc_stream));
+      simulator.Run(kFrameRate);
+      ok = simulator.midi_input_done();
+      break;
+    default:
+      simulator.Run(kFrameRate);
+      break;
+  }
+  return ok;
+}
+
+// Figures in ns, best of six runs of this test on one host. "Before" is the
+// same test with the UI formatting polled content on every pass again:
+//
+//                        before             after
+//   idle                 mean 43, max 266   mean 51, max 343
+//   sequencer recording  mean 60, max 767   mean 58, max 6913
+//   CC stream            mean 65, max 1267  mean 70, max 3905
+//
+// On the host the formatting that the UI now skips is below the noise, and
+// the maxima are preemptions of the test process. Only the means are checked.
+bool TestMainLoopStats() {
+  bool ok = true;
+  for (uint8_t scenario = 0; scenario < 3; ++scenario) {
+    uint64_t best_mean = UINT64_MAX;
+    uint64_t best_max = 0;
+    for (uint8_t run = 0; run < kMainLoopRuns; ++run) {
+      ok = RunMainLoopScenario(scenario) && ok;
+      if (simulator.mean_main_loop_time() < best_mean) {
+        best_mean = simulator.mean_main_loop_time();
+        best_max = simulator.max_main_loop_time();
+      }
+    }
+    printf(
+        "Main loop, %s: pass mean %llu ns, max %llu ns\n",
+        main_loop_scenarios[scenario],
+        static_cast<unsigned long long>(best_mean),
+        static_cast<unsigned long long>(best_max));
+    ok = best_mean < kSysTickPeriod && ok;
+  }
+  return Report("main loop stats", ok);
+}
+
+// Stands in for the storage stream, holding one preset
+struct PresetBuffer {
+  PackedMulti packed;
+
+  void Write(const PackedMulti& data) { packed = data; }
+  void Read(PackedMulti* data) { *data = packed; }
+};
+
+PresetBuffer preset;
+
+bool TestLegacyOscillatorQuality() {
+  simulator.Init();
+  multi.ApplySetting(SETTING_VOICING_OSCILLATOR_QUALITY, 0,
+      OSCILLATOR_QUALITY_OVERSAMPLED);
+  multi.ApplyPendingSettings();
+  multi.Serialize(&preset);
+  multi.Deserialize(&preset, false);
+  bool current_ok = multi.part(0).voicing_settings().oscillator_quality ==
+      OSCILLATOR_QUALITY_OVERSAMPLED;
+
+  // Presets from before the setting existed have junk in its bits
+  bool legacy_ok = true;
+  for (uint8_t junk = 0; junk < 4; ++junk) {
+    for (uint8_t i = 0; i < kNumParts; ++i) {
+      preset.packed.parts[i].oscillator_quality = junk;
+    }
+    preset.packed.version = kPackedMultiVersion - 1;
+    multi.Deserialize(&preset, false);
+    for (uint8_t i = 0; i < kNumParts; ++i) {
+      legacy_ok = legacy_ok &&
+          multi.part(i).voicing_settings().oscillator_quality ==
+          OSCILLATOR_QUALITY_STANDARD;
+    }
+    multi.Serialize(&preset);
+  }
+  return Report("legacy oscillator quality", current_ok && legacy_ok);
+}
+
+// Long enough to resolve the harmonics of a note apart from the aliases.
+const size_t kSpectrumSize = 16384;
+
+// Renders a steady note, and returns the host time per output sample in ns.
+double RenderOscillator(
+    OscillatorShape shape, OscillatorQuality quality, int16_t pitch,
+    int16_t timbre, std::vector<int16_t>* samples) {
+  static Oscillator oscillator;
+  oscillator.Init(0x8000);
+  oscillator.set_shape(shape);
+  oscillator.set_quality(quality);
+  samples->clear();
+  uint64_t elapsed = 0;
+  // The first blocks let the timbre and gain settle
+  for (size_t block = 0; samples->size() < kSpectrumSize; ++block) {
+    oscillator.Refresh(pitch, timbre, 0xffff);
+    uint64_t start = Nanoseconds();
+    oscillator.Render();
+    elapsed += Nanoseconds() - start;
+    for (size_t i = 0; i < kAudioBlockSize; ++i) {
+      int16_t sample = oscillator.ReadSample();
+      if (block >= 4) samples->push_back(sample);
+    }
+  }
+  return static_cast<double>(elapsed) / (kSpectrumSize + 4 * kAudioBlockSize);
+}
+
+void FFT(std::vector<std::complex<double> >* x) {
+  const size_t n = x->size();
+  for (size_t i = 1, j = 0; i < n; ++i) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) std::swap((*x)[i], (*x)[j]);
+  }
+  for (size_t length = 2; length <= n; length <<= 1) {
+    std::complex<double> w = std::polar(1.0, -2 * M_PI / length);
+    for (size_t i = 0; i < n; i += length) {
+      std::complex<double> wk = 1.0;
+      for (size_t k = 0; k < length / 2; ++k) {
+        std::complex<double> even = (*x)[i + k];
+        std::complex<double> odd = (*x)[i + k + length / 2] * wk;
+        (*x)[i + k] = even + odd;
+        (*x)[i + k + length / 2] = even - odd;
+        wk *= w;
+      }
+    }
+  }
+}
+
+// Power outside the harmonics of the note, relative to the total, in dB.
+// Foldover and the images of the half rate both count.
+double AliasingLevel(const std::vector<int16_t>& samples, int16_t pitch) {
+  std::vector<std::complex<double> > spectrum(kSpectrumSize);
+  for (size_t i = 0; i < kSpectrumSize; ++i) {
+    // Blackman-Harris, whose leakage stays below the 16-bit noise floor
+    double phase = 2 * M_PI * i / kSpectrumSize;
+    double window = 0.35875 - 0.48829 * cos(phase) +
+        0.14128 * cos(2 * phase) - 0.01168 * cos(3 * phase);
+    spectrum[i] = window * samples[i];
+  }
+  FFT(&spectrum);
+  const double bin = static_cast<double>(kFrameRate) / kSpectrumSize;
+  const double frequency = 440.0 * pow(2.0, (pitch / 128.0 - 69.0) / 12.0);
+  double harmonic_power = 0.0;
+  double other_power = 0.0;
+  // Skip DC and the window's leakage of it
+  for (size_t k = 4; k < kSpectrumSize / 2; ++k) {
+    double power = std::norm(spectrum[k]);
+    double harmonic = k * bin / frequency;
+    double distance = fabs(harmonic - floor(harmonic + 0.5)) * frequency / bin;
+    if (harmonic >= 0.5 && distance <= 6.0) {
+      harmonic_power += power;
+    } else {
+      other_power += power;
+    }
+  }
+  return 10.0 * log10(other_power / (harmonic_power + other_power));
+}
+
+// Cost and aliasing of each tier, on shapes that LITE and OVERSAMPLED both
+// apply to. LITE must also leave notes too high for the half rate at the
+// full rate, rather than saturate their phase increments.
+bool TestOscillatorQualityTiers() {
+  const char* tier_names[] = { "lite", "standard", "oversampled" };
+  const OscillatorQuality tiers[] = {
+    OSCILLATOR_QUALITY_LITE,
+    OSCILLATOR_QUALITY_STANDARD,
+    OSCILLATOR_QUALITY_OVERSAMPLED
+  };
+  const struct {
+    const char* name;
+    OscillatorShape shape;
+  } shapes[] = {
+    { "fold sine", OSC_SHAPE_FOLD_SINE },
+    { "tanh sine", OSC_SHAPE_TANH_SINE },
+    { "FM 1:1", OSC_SHAPE_FM },
+  };
+  const int16_t kPitch = 72 << 7;
+  const int16_t kTimbre = 0x3000;
+  std::vector<int16_t> samples;
+
+  bool ok = true;
+  for (const auto& s : shapes) {
+    double aliasing[OSCILLATOR_QUALITY_LAST];
+    for (uint8_t i = 0; i < OSCILLATOR_QUALITY_LAST; ++i) {
+      double ns = RenderOscillator(s.shape, tiers[i], kPitch, kTimbre, &samples);
+      aliasing[tiers[i]] = AliasingLevel(samples, kPitch);
+      printf(
+          "Oscillator, %s, %s: %.1f ns/sample, aliasing %.1f dB\n",
+          s.name, tier_names[i], ns, aliasing[tiers[i]]);
+    }
+    ok = ok && aliasing[OSCILLATOR_QUALITY_OVERSAMPLED] <
+        aliasing[OSCILLATOR_QUALITY_STANDARD];
+  }
+
+  // A note, or its FM modulator, above the Nyquist frequency of the half rate
+  // renders exactly as it does at STANDARD
+  std::vector<int16_t> reference;
+  const int16_t kHighPitch = 123 << 7;
+  const OscillatorShape high_shapes[] = {
+    OSC_SHAPE_CZ_SAW_LP, OSC_SHAPE_FOLD_SINE, OSC_SHAPE_FM_LAST
+  };
+  for (OscillatorShape shape : high_shapes) {
+    for (int16_t p = kHighPitch - (48 << 7); p < (128 << 7); p += 1 << 7) {
+      bool lite = p < kHighPitch && (shape != OSC_SHAPE_FM_LAST ||
+          p + lut_fm_modulator_intervals[OSC_SHAPE_FM_LAST - OSC_SHAPE_FM] <
+          kHighPitch);
+      if (lite) continue;
+      RenderOscillator(shape, OSCILLATOR_QUALITY_LITE, p, kTimbre, &samples);
+      RenderOscillator(shape, OSCILLATOR_QUALITY_STANDARD, p, kTimbre, &reference);
+      ok = ok && samples == reference;
+    }
+  }
+  return Report("oscillator quality tiers", ok);
+}
+
+// A voice's modulation settings, as Part::TouchVoices hands them over.
+struct ModRouteSettings {
+  uint8_t vibrato_range;
+  uint8_t vibrato_mod;
+  uint8_t tremolo_mod;
+  uint8_t timbre_mod_lfo;
+  uint8_t aux_cv;
+  uint8_t aux_cv_2;
+};
+
+void ApplyModRouteSettings(const ModRouteSettings& s, Voice* voice) {
+  voice->set_vibrato_range(s.vibrato_range);
+  voice->set_vibrato_mod(s.vibrato_mod);
+  voice->set_tremolo_mod(s.tremolo_mod);
+  voice->set_timbre_mod_lfo(s.timbre_mod_lfo);
+  voice->set_aux_cv(s.aux_cv);
+  voice->set_aux_cv_2(s.aux_cv_2);
+  voice->CompileModRoutes();
+}
+
+void InitModRouteVoice(Voice* voice, bool dense, CVOutput* audio_output) {
+  voice->Init();
+  voice->set_dense_mod_routes(dense);
+  voice->set_audio_output(audio_output);
+  voice->oscillator()->Init(0x8000);
+  voice->set_oscillator_mode(OSCILLATOR_MODE_ENVELOPED);
+  voice->set_oscillator_shape(OSC_SHAPE_CZ_SAW_LP);
+  voice->set_lfo_shape(LFO_ROLE_PITCH, LFO_SHAPE_TRIANGLE);
+  voice->set_lfo_shape(LFO_ROLE_TIMBRE, LFO_SHAPE_SAW_DOWN);
+  voice->set_lfo_shape(LFO_ROLE_AMPLITUDE, LFO_SHAPE_SQUARE);
+  voice->set_timbre_mod_envelope(0x2000);
+  voice->envelope()->SetADSR(UINT16_MAX, 20, 40, 80, 30);
+}
+
+// Time stamp counter, or ns where there is none
+inline uint64_t Cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return Nanoseconds();
+#endif
+}
+
+// Host cycles per Voice::Refresh, best of a few runs of one second.
+uint64_t TimeModRoutes(const ModRouteSettings& s, bool dense) {
+  static Voice voice;
+  CVOutput audio_output;
+  uint64_t best = UINT64_MAX;
+  for (uint8_t run = 0; run < 20; ++run) {
+    InitModRouteVoice(&voice, dense, &audio_output);
+    ApplyModRouteSettings(s, &voice);
+    voice.NoteOn(60 << 7, 100, 0, true);
+    uint64_t start = Cycles();
+    for (uint16_t i = 0; i < 4000; ++i) {
+      voice.Refresh();
+    }
+    best = std::min(best, (Cycles() - start) / 4000);
+  }
+  return best;
+}
+
+// The compiled routes must give the voice outputs of the dense path, which
+// computes every modulation on every refresh, including while a route that
+// was just turned off glides back to its neutral value. Host TSC cycles per
+// refresh (x86-64, -O2, best of 20 runs). The dense path goes through the
+// same loop as the routed one, over all six aux sources:
+//
+//                         dense  routed
+//   no LFO, aux vel/bend     75      53
+//   every LFO route          75      57
+bool TestModRouteEquivalence() {
+  const ModRouteSettings off = { 0, 0, 0, 0, MOD_AUX_VELOCITY, MOD_AUX_BEND };
+  const ModRouteSettings all = {
+    12, 90, 100, 80, MOD_AUX_VIBRATO_LFO, MOD_AUX_ENVELOPE
+  };
+  const ModRouteSettings settings[] = {
+    off,
+    all,
+    { 0, 90, 0, 0, MOD_AUX_FULL_LFO, MOD_AUX_MODULATION },
+    { 12, 0, 0, 0, MOD_AUX_VIBRATO_LFO, MOD_AUX_VIBRATO_LFO },
+    { 0, 0, 100, 0, MOD_AUX_ENVELOPE, MOD_AUX_AFTERTOUCH },
+    { 0, 0, 0, 80, MOD_AUX_BREATH, MOD_AUX_VELOCITY },
+    { 24, 127, 0, 0, MOD_AUX_PEDAL, MOD_AUX_FULL_LFO },
+  };
+  const uint8_t kNumSettings = sizeof(settings) / sizeof(settings[0]);
+  const uint16_t kRefreshesPerSetting = 1000;
+  static Voice dense;
+  static Voice routed;
+  CVOutput audio_output;
+
+  bool ok = true;
+  // Every setting, after every other: routes turn on and off mid-note
+  for (uint8_t first = 0; first < kNumSettings; ++first) {
+    InitModRouteVoice(&dense, true, &audio_output);
+    InitModRouteVoice(&routed, false, &audio_output);
+    for (uint8_t n = 0; n <= kNumSettings && ok; ++n) {
+      const ModRouteSettings& s = settings[(first + n) % kNumSettings];
+      ApplyModRouteSettings(s, &dense);
+      ApplyModRouteSettings(s, &routed);
+      Voice* voices[] = { &dense, &routed };
+      for (Voice* voice : voices) {
+        voice->NoteOn((48 + n) << 7, 40 + n * 10, n & 1 ? 40 : 0, true);
+        voice->PitchBend(8192 + n * 700);
+        voice->Aftertouch(n * 15);
+        voice->ControlChange(stmlib_midi::kCCBreathController, n * 12);
+      }
+      for (uint16_t i = 0; i < kRefreshesPerSetting && ok; ++i) {
+        if (i == kRefreshesPerSetting / 2) {
+          dense.NoteOff();
+          routed.NoteOff();
+        }
+        dense.Refresh();
+        routed.Refresh();
+        ok = dense.note() == routed.note() &&
+            dense.aux_cv_16bit() == routed.aux_cv_16bit() &&
+            dense.aux_cv_2_16bit() == routed.aux_cv_2_16bit();
+        if (i % 4 == 0) {
+          dense.RenderSamples();
+          routed.RenderSamples();
+          for (size_t j = 0; j < kAudioBlockSize; ++j) {
+            ok = dense.ReadSample() == routed.ReadSample() && ok;
+          }
+        }
+      }
+    }
+  }
+
+  printf(
+      "Mod routes, no LFO: dense %llu, routed %llu cycles/refresh\n",
+      static_cast<unsigned long long>(TimeModRoutes(off, true)),
+      static_cast<unsigned long long>(TimeModRoutes(off, false)));
+  printf(
+      "Mod routes, every LFO route: dense %llu, routed %llu cycles/refresh\n",
+      static_cast<unsigned long long>(TimeModRoutes(all, true)),
+      static_cast<unsigned long long>(TimeModRoutes(all, false)));
+  return Report("mod route equivalence", ok);
+}
+
+// Frames sent to the DAC, decoded from the DMA writes to GPIOB and SPI2.
+struct DacFrame {
+  uint16_t value[kNumChannels];
+};
+
+// Each TIM1 period must raise SS, lower it, and write the command word then
+// the data word of the next channel while SS is low. Any other order means a
+// compare event is served by the wrong DMA channel.
+bool DecodeDacFrames(std::vector<DacFrame>* frames) {
+  const uint32_t ss = GPIO_Pin_12;
+  const uint32_t bsrr = reinterpret_cast<uintptr_t>(&GPIOB->BSRR);
+  const uint32_t spi = reinterpret_cast<uintptr_t>(&SPI2->DR);
+  const uint32_t num_periods = MockBusLogSize() / 4;
+  if (MockBusLogSize() % 4 || num_periods % kNumChannels) {
+    return false;
+  }
+  for (uint32_t period = 0; period < num_periods; ++period) {
+    const MockBusWrite& ss_high = MockBusLog(period * 4);
+    const MockBusWrite& ss_low = MockBusLog(period * 4 + 1);
+    const MockBusWrite& command = MockBusLog(period * 4 + 2);
+    const MockBusWrite& data = MockBusLog(period * 4 + 3);
+    if (ss_high.address != bsrr || ss_high.value != ss ||
+        !(ss_high.gpiob_odr & ss) ||
+        ss_low.address != bsrr || ss_low.value != ss << 16 ||
+        command.address != spi || (command.gpiob_odr & ss) ||
+        data.address != spi || (data.gpiob_odr & ss)) {
+      return false;
+    }
+    // Write to buffer and update, with the channels in reverse order
+    uint8_t channel = period % kNumChannels;
+    uint32_t dac_channel = kNumChannels - 1 - channel;
+    if ((command.value & 0xf900) != 0x1000 ||
+        ((command.value >> 9) & 3) != dac_channel ||
+        (data.value & 0xff)) {
+      return false;
+    }
+    if (channel == 0) {
+      frames->push_back(DacFrame());
+    }
+    frames->back().value[channel] = (command.value << 8) | (data.value >> 8);
+  }
+  return true;
+}
+
+bool TestDacDma() {
+  // Without SysTick, nothing but the test writes the CV values, and no
+  // output renders audio or envelopes
+  simulator.Init();
+  std::fill(&has_audio_source[0], &has_audio_source[kNumChannels], false);
+  std::fill(&has_envelope[0], &has_envelope[kNumChannels], false);
+  const uint16_t old_values[kNumChannels] = { 0x0000, 0x5555, 0xaaaa, 0xffff };
+  const uint16_t new_values[kNumChannels] = { 0x1234, 0x5678, 0x9abc, 0xdef0 };
+  dac.Write(old_values);
+  simulator.RunDac(4 * kDacBlockSize);
+
+  // Written right after a refill, the worst case: the values must reach the
+  // DAC one full buffer later.
+  dac.Write(new_values);
+  MockStartBusLog();
+  simulator.RunDac(4 * kDacBlockSize);
+  MockStopBusLog();
+
+  std::vector<DacFrame> frames;
+  bool framing_ok = DecodeDacFrames(&frames);
+  bool values_ok = frames.size() == 4 * kDacBlockSize;
+  for (size_t i = 0; i < frames.size() && values_ok; ++i) {
+    const uint16_t* expected = i < 2 * kDacBlockSize ? old_values : new_values;
+    for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+      values_ok = values_ok && frames[i].value[channel] == expected[channel];
+    }
+  }
+  return Report("DAC DMA framing", framing_ok && values_ok);
+}
+
+// Display pins on GPIOB, as wired in display.cc.
+const uint32_t kDisplayClk = GPIO_Pin_7;
+const uint32_t kDisplayLatch = GPIO_Pin_8;
+const uint32_t kDisplayData = GPIO_Pin_9;
+const uint32_t kDisplayPositionPins[kDisplayWidth] = { GPIO_Pin_6, GPIO_Pin_5 };
+
+// Plays the logged GPIOB writes into a double of the two shift registers,
+// checking that a lit position always shows the segments of its character.
+// The first frame only fills the registers.
+bool CheckDisplayFrames(const char* text, uint32_t* lit_steps) {
+  uint32_t previous_odr = 0;
+  uint16_t shift_register = 0;
+  uint16_t storage_register = 0;
+  std::fill(&lit_steps[0], &lit_steps[kDisplayWidth], 0);
+  for (uint32_t i = 0; i < MockBusLogSize(); ++i) {
+    uint32_t odr = MockBusLog(i).gpiob_odr;
+    uint32_t rising = odr & ~previous_odr;
+    previous_odr = odr;
+    if (rising & kDisplayClk) {
+      shift_register >>= 1;
+      shift_register |= odr & kDisplayData ? 0x8000 : 0;
+    }
+    if (rising & kDisplayLatch) {
+      storage_register = shift_register;
+    }
+    if (i < kDisplayFrameSize) {
+      continue;
+    }
+    uint8_t num_lit = 0;
+    for (uint8_t position = 0; position < kDisplayWidth; ++position) {
+      if (!(odr & kDisplayPositionPins[position])) {
+        continue;
+      }
+      ++num_lit;
+      ++lit_steps[position];
+      uint8_t character = static_cast<uint8_t>(text[position]);
+      if (storage_register != chr_characters[character]) {
+        return false;
+      }
+    }
+    if (num_lit > 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Display display_double;
+
+bool TestDisplayFrames() {
+  // The firmware's display is already streaming, like the bootloader's is
+  // when the application starts, and this one takes the DMA channel over.
+  simulator.Init();
+  display_double.Init();
+  display_double.Print("AB");
+  display_double.RefreshSlow();
+  MockStartBusLog();
+  MockRunTimer(TIM4, 3 * kDisplayFrameSize);
+  MockStopBusLog();
+  uint32_t lit_steps[kDisplayWidth];
+  bool frames_ok = MockBusLogSize() == 3 * kDisplayFrameSize &&
+      CheckDisplayFrames("AB", lit_steps);
+  for (uint8_t position = 0; position < kDisplayWidth; ++position) {
+    frames_ok = frames_ok &&
+        lit_steps[position] == 2 * kDisplayBrightnessPWMMax;
+  }
+
+  // RefreshSlow patches the words that changed. Through a sweep of
+  // brightness and text, the frame must match one built from scratch.
+  const char* texts[] = { "AB", "CD", "C8", "88" };
+  bool patch_ok = true;
+  for (uint32_t i = 0; i < 64; ++i) {
+    uint16_t brightness = (i * 0x9e37) & 0xffff;
+    const char* text = texts[i % 4];
+    uint32_t patched_steps[kDisplayWidth];
+    display_double.set_brightness(brightness);
+    display_double.Print(text);
+    display_double.RefreshSlow();
+    MockStartBusLog();
+    MockRunTimer(TIM4, 3 * kDisplayFrameSize);
+    MockStopBusLog();
+    patch_ok = patch_ok && CheckDisplayFrames(text, patched_steps);
+
+    display_double.Init();
+    display_double.set_brightness(brightness);
+    display_double.Print(text);
+    display_double.RefreshSlow();
+    MockStartBusLog();
+    MockRunTimer(TIM4, 3 * kDisplayFrameSize);
+    MockStopBusLog();
+    patch_ok = patch_ok && CheckDisplayFrames(text, lit_steps) &&
+        std::equal(&lit_steps[0], &lit_steps[kDisplayWidth], patched_steps);
+  }
+
+  // Nothing may write to GPIOB once the next program has started.
+  display_double.Stop();
+  MockStartBusLog();
+  MockRunTimer(TIM4, kDisplayFrameSize);
+  MockStopBusLog();
+  bool stop_ok = MockBusLogSize() == 0 &&
+      !(DMA1_Channel7->CCR & DMA_CCR_EN);
+  return Report("display frames", frames_ok && patch_ok && stop_ok);
+}
+
+// Random steps: notes, rests, ties, and velocities from 1 to 127, slid or
+// not.
+void RandomSteps(
+    SequencerStep* step, uint8_t num_steps, bool rests, bool slides) {
+  for (uint8_t i = 0; i < num_steps; ++i) {
+    uint32_t dice = Random::GetWord() >> 8;
+    uint8_t velocity = 1 + (dice >> 8) % 127;
+    if (slides && (dice & 0x10000)) {
+      velocity |= 0x80;
+    }
+    if (rests && dice % 8 == 0) {
+      step[i] = SequencerStep(SEQUENCER_STEP_REST, 0);
+    } else if (rests && dice % 8 == 1) {
+      step[i] = SequencerStep(SEQUENCER_STEP_TIE, 0);
+    } else {
+      step[i] = SequencerStep((dice >> 1) & 0x7f, velocity);
+    }
+  }
+}
+
+bool SameSteps(const SequencerStep* a, const SequencerStep* b, uint8_t size) {
+  for (uint8_t i = 0; i < size; ++i) {
+    if (a[i].data[0] != b[i].data[0] ||
+        (a[i].has_note() && a[i].data[1] != b[i].data[1])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TestStepPacking() {
+  Random::Seed(0x5e9);
+  PackedPart packed;
+  SequencerStep step[kNumSteps];
+  SequencerStep unpacked[kNumSteps];
+  uint8_t num_steps;
+
+  // Every step is stored exactly. With 17 bits for the worst step, at least
+  // 27 of them always fit...
+  bool exact_ok = true;
+  for (uint16_t trial = 0; trial < 200; ++trial) {
+    uint8_t size = trial % 28;
+    RandomSteps(step, size, true, true);
+    SequencerSettings::PackSteps(step, size, packed.sequencer_data);
+    exact_ok = exact_ok &&
+        SequencerSettings::UnpackSteps(
+            packed.sequencer_data, unpacked, &num_steps) &&
+        num_steps == size && SameSteps(step, unpacked, size);
+  }
+
+  // ...and a longer sequence is cut to the steps that fit, rather than
+  // losing velocities, slides, or high notes.
+  bool cut_ok = true;
+  uint8_t min_kept = kNumSteps;
+  for (uint16_t trial = 0; trial < 50; ++trial) {
+    RandomSteps(step, kNumSteps, true, true);
+    SequencerSettings::PackSteps(step, kNumSteps, packed.sequencer_data);
+    cut_ok = cut_ok && SequencerSettings::UnpackSteps(
+        packed.sequencer_data, unpacked, &num_steps) &&
+        num_steps >= 27 && SameSteps(step, unpacked, num_steps);
+    min_kept = std::min(min_kept, num_steps);
+  }
+
+  // Repeated velocities are stored as runs, so 64 notes entered at one
+  // velocity fit whole, and 48 notes in 6 runs of accents.
+  bool runs_ok = true;
+  for (uint16_t trial = 0; trial < 50; ++trial) {
+    uint8_t size = trial & 1 ? kNumSteps : 48;
+    RandomSteps(step, size, true, false);
+    for (uint8_t i = 0; i < size; ++i) {
+      if (!step[i].has_note()) { continue; }
+      step[i].data[0] %= 125;
+      step[i].data[1] = size == kNumSteps ? 100 : 40 + (i / 8) * 16;
+    }
+    SequencerSettings::PackSteps(step, size, packed.sequencer_data);
+    runs_ok = runs_ok && SequencerSettings::UnpackSteps(
+        packed.sequencer_data, unpacked, &num_steps) &&
+        num_steps == size && SameSteps(step, unpacked, size);
+  }
+  printf("Step packing: random 64-step sequences keep %d steps or more\n",
+      min_kept);
+
+  // A whole multi, saved and loaded
+  simulator.Init();
+  for (uint8_t part = 0; part < kNumParts; ++part) {
+    SequencerSettings* seq = multi.mutable_part(part)->
+        mutable_sequencer_settings();
+    seq->num_steps = 8 + part * 6;
+    RandomSteps(seq->step, seq->num_steps, true, true);
+  }
+  SequencerSettings saved[kNumParts];
+  for (uint8_t part = 0; part < kNumParts; ++part) {
+    saved[part] = multi.part(part).sequencer_settings();
+  }
+  multi.Serialize(&preset);
+  multi.Init(true);
+  multi.Deserialize(&preset, false);
+  bool multi_ok = true;
+  for (uint8_t part = 0; part < kNumParts; ++part) {
+    const SequencerSettings& seq = multi.part(part).sequencer_settings();
+    multi_ok = multi_ok && seq.num_steps == saved[part].num_steps &&
+        SameSteps(seq.step, saved[part].step, seq.num_steps);
+  }
+
+  // Older presets hold 30 x {pitch, velocity}, and may have the current
+  // version in their uninitialized version byte.
+  bool legacy_ok = true;
+  for (uint8_t version = 0; version <= kPackedMultiVersion; ++version) {
+    for (uint8_t part = 0; part < kNumParts; ++part) {
+      PackedPart& packed_part = preset.packed.parts[part];
+      RandomSteps(step, 30, true, true);
+      for (uint8_t i = 0; i < 30; ++i) {
+        packed_part.sequencer_data[i * 2] = step[i].data[0];
+        packed_part.sequencer_data[i * 2 + 1] = step[i].data[1];
+      }
+      packed_part.legacy_num_steps = 30;
+      std::copy(&step[0], &step[30], &saved[part].step[0]);
+    }
+    preset.packed.version = version;
+    multi.Deserialize(&preset, false);
+    for (uint8_t part = 0; part < kNumParts; ++part) {
+      const SequencerSettings& seq = multi.part(part).sequencer_settings();
+      legacy_ok = legacy_ok && seq.num_steps == 30 &&
+          SameSteps(seq.step, saved[part].step, 30);
+    }
+  }
+
+  return Report("step packing",
+      exact_ok && cut_ok && runs_ok && multi_ok && legacy_ok);
+}
+
+// Checks that the values played back from a lane, after the first one seen,
+// follow the lane's events in loop order.
+bool PlayedInOrder(
+    const looper::Lane& lane, const std::vector<uint16_t>& played) {
+  if (played.size() != lane.size) {
+    return false;
+  }
+  uint8_t start = 0;
+  while (start < lane.size && lane.events[start].value != played[0]) {
+    ++start;
+  }
+  for (uint8_t i = 0; i < played.size(); ++i) {
+    if (start == lane.size ||
+        lane.events[(start + i) % lane.size].value != played[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Controller moves recorded by the looper come back on the following passes,
+// in loop order, and pitch bend keeps its 14 bits. A lane drops a repeated
+// value, lets a move replace the previous one when it is too close to it,
+// and once full, drops the event that changes the value the least.
+bool TestAutomationLanes() {
+  const uint32_t kLoopFrames = kFrameRate * 2;  // 1 bar at 120 BPM
+  const uint8_t kNumMoves = 32;
+  const uint8_t kJump = 16;
+  const uint8_t kFramesPerTick = kFrameRate / 8000;
+
+  simulator.Init();
+  multi.ApplySetting(SETTING_SEQUENCER_PLAY_MODE, 0, PLAY_MODE_SEQUENCER);
+  multi.ApplyPendingSettings();
+  multi.Start(false);
+  multi.StartRecording(0);
+  simulator.Run(kFrameRate / 100);
+
+  // Portamento ramps up in steps of 2, with one large jump. Each move is
+  // repeated, then replaced a few ticks later by the odd value above it.
+  // Every eighth move also bends the pitch.
+  std::vector<uint16_t> bends;
+  for (uint8_t i = 0; i < kNumMoves; ++i) {
+    uint8_t value = i == kJump ? 120 : 40 + 2 * i;
+    SendMessage(0xb0, 5, value);
+    SendMessage(0xb0, 5, value);
+    simulator.Run(kFramesPerTick * 4);
+    SendMessage(0xb0, 5, value + 1);
+    SendMessage(0xb0, 5, value + 1);
+    if (i % 8 == 4) {
+      uint16_t bend = 0x1a00 + bends.size() * 0x123;
+      SendMessage(0xe0, bend & 0x7f, bend >> 7);
+      bends.push_back(bend);
+    }
+    simulator.Run(kLoopFrames / kNumMoves - kFramesPerTick * 4);
+  }
+  multi.StopRecording(0);
+
+  const looper::Deck& deck = multi.part(0).looper();
+  const looper::Lane& cc_lane = deck.lane(0);
+  const looper::Lane& bend_lane = deck.lane(1);
+
+  bool thinning_ok = cc_lane.controller == 5 &&
+      cc_lane.size == looper::kMaxLaneEvents;
+  bool jump_kept = false;
+  for (uint8_t i = 0; i < cc_lane.size; ++i) {
+    const looper::ControlEvent& event = cc_lane.events[i];
+    thinning_ok = thinning_ok && (event.value & 1) &&
+        (i == 0 || event.pos > cc_lane.events[i - 1].pos);
+    jump_kept = jump_kept || event.value == 121;
+  }
+  thinning_ok = thinning_ok && jump_kept;
+
+  bool bend_ok = bend_lane.controller == looper::kControllerPitchBend &&
+      bend_lane.size == bends.size();
+  for (uint8_t i = 0; bend_ok && i < bend_lane.size; ++i) {
+    bend_ok = bend_lane.events[i].value == bends[i];
+  }
+
+  // One more pass, from other values, noting each value as it changes
+  multi.ApplySetting(SETTING_VOICING_PORTAMENTO, 0, 0);
+  multi.ApplyPendingSettings();
+  multi.mutable_voice(0)->PitchBend(8192);
+  std::vector<uint16_t> played_ccs;
+  std::vector<uint16_t> played_bends;
+  for (uint32_t t = 0; t < kLoopFrames; t += kFramesPerTick) {
+    simulator.Run(kFramesPerTick);
+    uint8_t portamento = multi.part(0).voicing_settings().portamento;
+    if (portamento && (played_ccs.empty() || played_ccs.back() != portamento)) {
+      played_ccs.push_back(portamento);
+    }
+    uint16_t bend = multi.voice(0).pitch_bend();
+    if (bend != 8192 && (played_bends.empty() || played_bends.back() != bend)) {
+      played_bends.push_back(bend);
+    }
+  }
+  multi.Stop();
+  bool playback_ok = PlayedInOrder(cc_lane, played_ccs) &&
+      PlayedInOrder(bend_lane, played_bends);
+
+  printf(
+      "Automation lanes: %d CC moves kept %d events, %d bends played %d\n",
+      kNumMoves, cc_lane.size,
+      static_cast<int>(bends.size()), static_cast<int>(played_bends.size()));
+  return Report("automation lanes", thinning_ok && bend_ok && playback_ok);
+}
+
+const uint8_t kYarnsSysExHeader[] = { 0xf0, 0x00, 0x21, 0x02, 0x00, 0x0b };
+
+// Hands a message longer than the MIDI input buffer to the handler.
+void SendBytes(const std::vector<uint8_t>& bytes) {
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    midi_handler.PushByte(bytes[i]);
+    midi_handler.ProcessInput();
+  }
+}
+
+// Sends a Yarns SysEx packet, nibblized with its checksum the way
+// MidiHandler::SysExSendPacket writes it.
+void SendYarnsPacket(
+    uint8_t command, uint8_t packet_index, const uint8_t* data, size_t size) {
+  std::vector<uint8_t> bytes(
+      kYarnsSysExHeader, kYarnsSysExHeader + sizeof(kYarnsSysExHeader));
+  bytes.push_back(command);
+  bytes.push_back(packet_index);
+  uint8_t checksum = 0;
+  for (size_t i = 0; i < size; ++i) {
+    checksum += data[i];
+    bytes.push_back(data[i] >> 4);
+    bytes.push_back(data[i] & 0x0f);
+  }
+  bytes.push_back(checksum >> 4);
+  bytes.push_back(checksum & 0x0f);
+  bytes.push_back(0xf7);
+  SendBytes(bytes);
+}
+
+inline int16_t TestTrim(uint8_t output, uint8_t octave) {
+  return (octave - 5) * 40 + output * 7;
+}
+
+// The calibration model: straight lines between the octave points, bent by
+// each half-octave trim, fully at the midpoint and fading out towards both
+// octave points.
+double ExpectedDacCode(const CVOutput& output, uint8_t note) {
+  uint8_t octave = note / 12;
+  double fraction = (note % 12) / 12.0;
+  double a = output.calibration_dac_code(octave);
+  double b = output.calibration_dac_code(octave + 1);
+  double weight = 1.0 - fabs(2.0 * fraction - 1.0);
+  return a + (b - a) * fraction + output.half_octave_trim(octave) * weight;
+}
+
+// Half-octave trims sent as calibration packets (SysEx 35) are saved, and the
+// pitch map compiled from them bends the DAC codes of the notes. A
+// calibration request (SysEx 34) sends them back.
+bool TestCalibrationTrims() {
+  simulator.Init();
+
+  // A calibration with trims, serialized by the firmware, then cleared
+  StreamBuffer<kMaxSize> calibration;
+  for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
+    for (uint8_t j = 0; j < kNumHalfOctaveTrims; ++j) {
+      multi.mutable_cv_output(i)->set_half_octave_trim(j, TestTrim(i, j));
+    }
+  }
+  multi.SerializeCalibration(&calibration);
+  for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
+    for (uint8_t j = 0; j < kNumHalfOctaveTrims; ++j) {
+      multi.mutable_cv_output(i)->set_half_octave_trim(j, 0);
+    }
+  }
+
+  const uint8_t* data = calibration.bytes();
+  size_t size = calibration.position();
+  uint8_t packet_index = 0;
+  for (size_t i = 0; i < size; i += kSysexMaxChunkSize) {
+    SendYarnsPacket(
+        SYSEX_COMMAND_CALIBRATION_PACKET, packet_index++,
+        data + i, std::min(kSysexMaxChunkSize, size - i));
+  }
+  SendYarnsPacket(SYSEX_COMMAND_CALIBRATION_PACKET, packet_index, NULL, 0);
+
+  bool trims_ok = true;
+  for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
+    for (uint8_t j = 0; j < kNumHalfOctaveTrims; ++j) {
+      trims_ok = trims_ok &&
+          multi.cv_output(i).half_octave_trim(j) == TestTrim(i, j);
+      multi.mutable_cv_output(i)->set_half_octave_trim(j, 0);
+    }
+  }
+  trims_ok = trims_ok && storage_manager.LoadCalibration();
+  for (uint8_t i = 0; i < kNumCVOutputs; ++i) {
+    for (uint8_t j = 0; j < kNumHalfOctaveTrims; ++j) {
+      trims_ok = trims_ok &&
+          multi.cv_output(i).half_octave_trim(j) == TestTrim(i, j);
+    }
+  }
+
+  // Every note of the range, through the voice and the refresh. Whole tones
+  // are pitch map entries; the semitones between them are interpolated.
+  const CVOutput& output = multi.cv_output(0);
+  double max_error = 0.0;
+  for (uint8_t note = 0; note < 120; ++note) {
+    SendMessage(0x90, note, 100);
+    simulator.Run(kFrameRate / 1000);
+    double error = output.note_dac_code() - ExpectedDacCode(output, note);
+    max_error = std::max(max_error, fabs(error));
+    SendMessage(0x80, note, 0);
+  }
+  bool codes_ok = max_error <= 2.0;
+
+  // Nothing drains the MIDI output during a host call, so the reply wraps
+  // around the output buffer. Its tail holds the last data packet, with the
+  // trims of the last two outputs, and the empty packet that ends it. This
+  // reads the whole ring, and picks the tail out by its position in the
+  // stream written since the flush.
+  MidiHandler::MidiBuffer* reply = midi_handler.mutable_output_buffer();
+  reply->Flush();
+  const uint8_t no_arguments[] = { 0, 0, 0 };
+  std::vector<uint8_t> request(
+      kYarnsSysExHeader, kYarnsSysExHeader + sizeof(kYarnsSysExHeader));
+  request.push_back(SYSEX_COMMAND_REQUEST_CALIBRATION);
+  request.insert(request.end(), no_arguments, no_arguments + 3);
+  request.push_back(0xf7);
+  SendBytes(request);
+  const size_t kCapacity = reply->capacity();
+  size_t last_size = size % kSysexMaxChunkSize;
+  // The request goes out first, through the MIDI thru
+  size_t reply_size = request.size() +
+      (size / kSysexMaxChunkSize + 2) * 11 + size * 2;
+  std::vector<uint8_t> ring(kCapacity);
+  reply->ImmediateRead(&ring[0], kCapacity);
+  std::vector<uint8_t> tail;
+  for (size_t i = reply_size - (11 + 2 * last_size) - 11; i < reply_size; ++i) {
+    tail.push_back(ring[i % kCapacity]);
+  }
+  bool reply_ok = tail[6] == SYSEX_COMMAND_CALIBRATION_PACKET &&
+      tail[7] == packet_index - 1 && tail.back() == 0xf7;
+  for (size_t i = 0; i < last_size; ++i) {
+    uint8_t byte = tail[8 + 2 * i] << 4 | tail[9 + 2 * i];
+    reply_ok = reply_ok && byte == data[size - last_size + i];
+  }
+
+  // Calibration mode only starts and ends on complete messages
+  std::vector<uint8_t> calibrate(
+      kYarnsSysExHeader, kYarnsSysExHeader + sizeof(kYarnsSysExHeader));
+  calibrate.push_back(SYSEX_COMMAND_CALIBRATE);
+  calibrate.push_back(0x03);  // Output 1, octave 3
+  std::vector<uint8_t> truncated(calibrate);
+  truncated.push_back(0xf7);
+  calibrate.insert(calibrate.end(), 4, 0x08);
+  calibrate.push_back(0xf7);
+  SendBytes(truncated);
+  bool mode_ok = !midi_handler.calibrating();
+  SendBytes(calibrate);
+  mode_ok = mode_ok && midi_handler.calibrating();
+  truncated[7] = calibrate[7] = 0x7f;
+  SendBytes(truncated);
+  mode_ok = mode_ok && midi_handler.calibrating();
+  SendBytes(calibrate);
+  mode_ok = mode_ok && !midi_handler.calibrating();
+
+  printf("Calibration trims: DAC code error max %.2f LSB\n", max_error);
+  return Report(
+      "calibration trims", trims_ok && codes_ok && reply_ok && mode_ok);
+}
+
+// Sends a song dump, as smf_to_song.py --syx writes it, with num_sent of its
+// events.
+void SendSong(
+    uint8_t clock_tempo, const SongEvent* events, uint16_t num_events,
+    uint16_t num_sent) {
+  std::vector<uint8_t> data;
+  PackedSongHeader header = { num_events, clock_tempo, { 8, 13, 20, 23 }, 0 };
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&header);
+  data.insert(data.end(), bytes, bytes + sizeof(header));
+  bytes = reinterpret_cast<const uint8_t*>(events);
+  data.insert(data.end(), bytes, bytes + num_sent * sizeof(SongEvent));
+  uint8_t packet_index = 0;
+  for (size_t i = 0; i < data.size(); i += kSysexMaxChunkSize) {
+    size_t size = std::min(data.size() - i, kSysexMaxChunkSize);
+    SendYarnsPacket(SYSEX_COMMAND_SONG_PACKET, packet_index++, &data[i], size);
+  }
+  SendYarnsPacket(SYSEX_COMMAND_SONG_PACKET, packet_index, NULL, 0);
+}
+
+// The note a song holds on a part at a tick, or -1.
+int16_t SongNoteAt(
+    const SongEvent* events, uint16_t num_events, uint8_t part,
+    uint32_t tick) {
+  uint32_t loop_length = 0;
+  for (uint16_t i = 0; i < num_events; ++i) {
+    loop_length += events[i].delta;
+  }
+  int16_t note = -1;
+  uint32_t latest_start = 0;
+  for (uint32_t loop = 0; loop * loop_length <= tick; ++loop) {
+    uint32_t start = loop * loop_length;
+    for (uint16_t i = 0; i < num_events; ++i) {
+      start += events[i].delta;
+      const SongEvent& e = events[i];
+      if (e.velocity && e.part == part && start <= tick &&
+          tick < start + e.length && start >= latest_start) {
+        latest_start = start;
+        note = e.note;
+      }
+    }
+  }
+  return note;
+}
+
+// A song uploaded over SysEx plays from the flash page it is kept in, and
+// loops, with every part holding its notes for their lengths. Songs that
+// never move time forward are turned down.
+bool TestSongPlayback() {
+  const SongEvent events[] = {
+    { 0, 12, 0, 60, 100 },
+    { 0, 6, 1, 64, 90 },
+    { 6, 6, 1, 65, 80 },
+    { 6, 12, 2, 67, 70 },
+    { 0, 3, 3, 72, 60 },
+    { 12, 0, 0, 0, 0 },
+    // Plays on the tick where the song loops
+    { 0, 4, 3, 74, 50 },
+  };
+  const uint16_t kNumEvents = sizeof(events) / sizeof(SongEvent);
+  const SongEvent stalled[] = {
+    { 0, 12, 0, 60, 100 },
+    { 0, 0, 0, 0, 0 },
+  };
+
+  simulator.Init();
+  Song song;
+  SendSong(120, stalled, 2, 2);
+  bool rejected_ok = !storage_manager.LoadSong(&song);
+  SendSong(120, events, kNumEvents, kNumEvents);
+  // More events than its header counts
+  SendSong(120, events, kNumEvents - 1, kNumEvents);
+  rejected_ok = rejected_ok && storage_manager.LoadSong(&song) &&
+      song.num_events == kNumEvents;
+
+  // The demo song plays first
+  multi.StartSong();
+  multi.StartSong();
+  bool notes_ok = multi.playing_song();
+  const uint32_t kNumTicks = 3 * 24 + 5;
+  const uint8_t kFramesPerTick = kFrameRate / 8000;
+  uint32_t tick = multi.tick_counter();
+  for (uint32_t frame = 0; frame < kFrameRate * 3 && notes_ok; ) {
+    simulator.Run(kFramesPerTick);
+    frame += kFramesPerTick;
+    if (multi.tick_counter() == tick) {
+      continue;
+    }
+    tick = multi.tick_counter();
+    if (tick >= kNumTicks) {
+      break;
+    }
+    // The voices pick the notes up on the next refresh
+    simulator.Run(kFramesPerTick * 2);
+    frame += kFramesPerTick * 2;
+    for (uint8_t part = 0; part < kNumParts; ++part) {
+      const Voice& voice = multi.voice(part);
+      int16_t note = SongNoteAt(events, kNumEvents, part, tick);
+      notes_ok = notes_ok && voice.gate_on() == (note != -1) &&
+          (note == -1 || (voice.note() + 64) >> 7 == note);
+    }
+  }
+  notes_ok = notes_ok && tick == kNumTicks;
+  multi.Stop();
+  return Report("song playback", rejected_ok && notes_ok);
+}
+
+// A program loaded while the clock runs must land on the next bar, without
+// stopping the clock or releasing a held note. Part 1 steps through a
+// sequence of one note, which the program changes: the step that opens the
+// bar must already play the new note.
+bool TestProgramChangeLatency() {
+  const uint8_t kTempo = 120;
+  const uint8_t kBarDuration = 4;  // Quarter notes
+  const uint32_t kBarTicks = kBarDuration * 24;
+  const uint32_t kBarFrames = kFrameRate * 60 / kTempo * kBarDuration;
+  const uint8_t kPortamento = 42;
+  const uint8_t kOldNote = 48;
+  const uint8_t kNewNote = 72;
+  static const uint8_t note_on[] = { 0x90, 60, 100 };
+
+  simulator.Init();
+  multi.ApplySetting(SETTING_LAYOUT, 0, LAYOUT_DUAL_MONO);
+  multi.ApplySetting(SETTING_CLOCK_TEMPO, 0, kTempo);
+  multi.ApplySetting(SETTING_CLOCK_BAR_DURATION, 0, kBarDuration);
+  multi.ApplySetting(SETTING_VOICING_PORTAMENTO, 0, kPortamento);
+  multi.ApplySetting(SETTING_MIDI_CHANNEL, 1, 1);
+  multi.ApplySetting(SETTING_SEQUENCER_PLAY_MODE, 1, PLAY_MODE_SEQUENCER);
+  multi.ApplySetting(SETTING_SEQUENCER_CLOCK_QUANTIZATION, 1, 1);
+  simulator.Run(kFrameRate / 100);
+  SequencerSettings* seq = multi.mutable_part(1)->mutable_sequencer_settings();
+  seq->num_steps = 1;
+  seq->step[0] = SequencerStep(kNewNote, 100);
+  storage_manager.SaveMulti(0);
+
+  bool ok = true;
+  uint32_t max_wait = 0;
+  uint32_t total_wait = 0;
+  uint32_t max_latency = 0;
+  const uint8_t kNumTrials = 8;
+  for (uint8_t trial = 0; trial < kNumTrials; ++trial) {
+    multi.ApplySetting(SETTING_VOICING_PORTAMENTO, 0, 0);
+    seq->step[0] = SequencerStep(kOldNote, 100);
+    multi.Start(false);
+    simulator.SetMidiInput(note_on, sizeof(note_on));
+    // Requests land at different points of the bar
+    simulator.Run(kFrameRate / 10 + trial * kBarFrames / kNumTrials);
+
+    // A second load replaces the first, and saving the running program
+    // meanwhile does not land either of them early
+    storage_manager.LoadMulti(1);
+    storage_manager.LoadMulti(0);
+    storage_manager.SaveMulti(1);
+    ok = ok && multi.part(0).voicing_settings().portamento == 0;
+    const Voice& voice = *multi.part(1).voice(0);
+    uint32_t tick = multi.tick_counter();
+    uint32_t frames = 0;
+    uint32_t boundary = 0;
+    uint32_t landed = 0;
+    uint32_t played = 0;
+    while (!played && frames <= 2 * kBarFrames) {
+      simulator.Run(1);
+      ++frames;
+      if (multi.tick_counter() != tick) {
+        tick = multi.tick_counter();
+        if (!boundary && tick % kBarTicks == 0) {
+          boundary = frames;
+        }
+      }
+      if (!landed &&
+          multi.part(0).voicing_settings().portamento == kPortamento) {
+        landed = frames;
+      }
+      if (voice.gate_on() && (voice.note() >> 7) == kNewNote) {
+        played = frames;
+      }
+    }
+    // The program lands on the tick that opens the bar, and its first step
+    // within a refresh of that
+    uint32_t latency = played - boundary;
+    max_wait = std::max(max_wait, landed);
+    total_wait += landed;
+    max_latency = std::max(max_latency, latency);
+    ok = ok && boundary && landed == boundary && played >= boundary &&
+        latency <= kFrameRate / 4000 && multi.running() &&
+        multi.voice(0).gate_on();
+    multi.Stop();
+    simulator.Run(kFrameRate / 100);
+  }
+  printf(
+      "Program change: wait for the bar mean %.1f ms, max %.1f ms "
+      "(bar %.1f ms); bar to first new note max %.3f ms; "
+      "main loop pass max %llu ns\n",
+      1000.0f * total_wait / kNumTrials / kFrameRate,
+      1000.0f * max_wait / kFrameRate,
+      1000.0f * kBarFrames / kFrameRate,
+      1000.0f * max_latency / kFrameRate,
+      static_cast<unsigned long long>(simulator.max_main_loop_time()));
+  return Report("program change latency", ok);
+}
+
+// Gate edges come out kGateLatency after the note event that caused them,
+// whatever the phase of the refresh; clock and reset edges at the refresh
+// itself. An output switched to another source does not wait on that
+// source's old timestamp, and edges that are already due all go out at once.
+bool TestGateTiming() {
+  const uint8_t kNumNotes = 64;
+  const uint16_t kSysTickMicros = 1000000 / 8000;
+
+  // Monophonic notes, with 3 to 10 bytes of active sensing between messages
+  simulator.Init();
+  multi.ApplySetting(SETTING_LAYOUT, 0, LAYOUT_MONO);
+  simulator.Run(kFrameRate / 100);
+  std::vector<uint8_t> midi;
+  std::vector<size_t> message_end;
+  Random::Seed(0x676174);
+  for (uint8_t i = 0; i < 2 * kNumNotes; ++i) {
+    midi.push_back(i & 1 ? 0x80 : 0x90);
+    midi.push_back(48 + (i >> 1) % 24);
+    midi.push_back(100);
+    message_end.push_back(midi.size() - 1);
+    midi.insert(midi.end(), 3 + (Random::GetWord() >> 16) % 8, 0xfe);
+  }
+  simulator.StartGateLog();
+  simulator.SetMidiInput(&midi[0], midi.size());
+  while (!simulator.midi_input_done()) {
+    simulator.Run(kFrameRate / 100);
+  }
+  simulator.Run(kFrameRate / 100);
+
+  std::vector<GateEvent> edges, sources;
+  for (size_t i = 0; i < simulator.gate_edges().size(); ++i) {
+    if (simulator.gate_edges()[i].channel == 0) {
+      edges.push_back(simulator.gate_edges()[i]);
+    }
+  }
+  for (size_t i = 0; i < simulator.gate_sources().size(); ++i) {
+    if (simulator.gate_sources()[i].channel == 0) {
+      sources.push_back(simulator.gate_sources()[i]);
+    }
+  }
+  bool ok = edges.size() == 2 * kNumNotes && sources.size() == edges.size();
+  int32_t max_error = 0;
+  uint32_t min_latency = 0xffffffff;
+  uint32_t max_latency = 0;
+  for (size_t i = 0; ok && i < edges.size(); ++i) {
+    int32_t error = edges[i].time - sources[i].due;
+    max_error = std::max(max_error, error < 0 ? -error : error);
+    uint32_t latency =
+        edges[i].time - simulator.midi_arrivals()[message_end[i]];
+    min_latency = std::min(min_latency, latency);
+    max_latency = std::max(max_latency, latency);
+    ok = edges[i].level == !(i & 1);
+  }
+  // A byte waits at most one SysTick before the main loop picks it up
+  ok = ok && max_error <= 1 && min_latency >= kGateLatency &&
+      max_latency <= kGateLatency + kSysTickMicros;
+
+  // Clock and reset/playing outputs, against the refresh that changed them
+  simulator.StartGateLog();
+  multi.Start(false);
+  simulator.Run(2 * kFrameRate);
+  multi.Stop();
+  simulator.Run(kFrameRate / 100);
+  uint32_t num_clock_edges = 0;
+  uint32_t max_clock_latency = 0;
+  for (size_t i = 0, j = 0; i < simulator.gate_sources().size(); ++i) {
+    const GateEvent& source = simulator.gate_sources()[i];
+    if (source.channel < 2) {
+      continue;
+    }
+    while (j < simulator.gate_edges().size() &&
+        simulator.gate_edges()[j].channel != source.channel) {
+      ++j;
+    }
+    if (j == simulator.gate_edges().size()) {
+      ok = false;
+      break;
+    }
+    max_clock_latency = std::max(
+        max_clock_latency, simulator.gate_edges()[j++].time - source.time);
+    ++num_clock_edges;
+  }
+  ok = ok && num_clock_edges >= 4 && max_clock_latency <= 1;
+
+  // Output 4 of a 4-voice layout, switched to the reset/playing flag (low
+  // while stopped) and back to a voice whose note is older than a wrap of the
+  // counter
+  simulator.Init();
+  multi.ApplySetting(SETTING_LAYOUT, 0, LAYOUT_QUAD_POLY);
+  simulator.Run(kFrameRate / 100);
+  static const uint8_t chord[] = {
+    0x90, 60, 100, 64, 100, 67, 100, 71, 100
+  };
+  simulator.SetMidiInput(chord, sizeof(chord));
+  simulator.Run(kFrameRate / 10);
+  multi.ApplySetting(SETTING_CLOCK_OVERRIDE, 0, 1);
+  simulator.Run(kFrameRate / 100);
+  simulator.StartGateLog();
+  multi.ApplySetting(SETTING_CLOCK_OVERRIDE, 0, 0);
+  simulator.Run(kFrameRate / 10);
+  uint32_t switch_latency = 0xffffffff;
+  for (size_t i = 0; i < simulator.gate_sources().size(); ++i) {
+    const GateEvent& source = simulator.gate_sources()[i];
+    for (size_t j = 0; source.channel == 3 && source.level &&
+        j < simulator.gate_edges().size(); ++j) {
+      const GateEvent& edge = simulator.gate_edges()[j];
+      if (edge.channel == 3 && edge.level) {
+        switch_latency = edge.time - source.time;
+        break;
+      }
+    }
+  }
+  ok = ok && switch_latency <= kGateLatency;
+
+  // Two edges already due when the refresh gets to them
+  simulator.Init();
+  uint16_t now = gate_scheduler.now();
+  gate_scheduler.Submit(0, true, now - 3 * kGateLatency);
+  gate_scheduler.Submit(0, false, now - 2 * kGateLatency);
+  gate_output.Schedule(&gate_scheduler);
+  ok = ok && !(GPIOB->ODR & kGatePins[0]) && !gate_output.armed(0);
+
+  printf(
+      "Gate timing: error max %d us; note latency %u..%u us; "
+      "clock latency max %u us; switch latency %u us\n",
+      static_cast<int>(max_error),
+      static_cast<unsigned>(min_latency), static_cast<unsigned>(max_latency),
+      static_cast<unsigned>(max_clock_latency),
+      static_cast<unsigned>(switch_latency));
+  return Report("gate timing", ok);
+}
+
+int main(void) {
+  uint8_t num_failures = 0;
+  num_failures += !TestSettingQueue();
+  num_failures += !TestMPEThroughput();
+  num_failures += !TestMPESharedPitch();
+  num_failures += !TestMainLoopStats();
+  num_failures += !TestLegacyOscillatorQuality();
+  num_failures += !TestOscillatorQualityTiers();
+  num_failures += !TestModRouteEquivalence();
+  num_failures += !TestStepPacking();
+  num_failures += !TestAutomationLanes();
+  num_failures += !TestCalibrationTrims();
+  num_failures += !TestSongPlayback();
+  num_failures += !TestProgramChangeLatency();
+  num_failures += !TestGateTiming();
+  num_failures += !TestDacDma();
+  num_failures += !TestDisplayFrames();
+  printf("%d failure(s)\n", num_failures);
+  return num_failures ? 1 : 0;
+}
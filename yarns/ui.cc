@@ -150,6 +150,9 @@ void Ui::Init() {
   
   start_stop_press_time_ = 0;
   
+  display_tick_ = 0;
+  settings_version_ = multi.settings_version();
+  
   push_it_note_ = kC4;
   modes_[UI_MODE_MAIN_MENU].incremented_variable = &command_index_;
   modes_[UI_MODE_LOAD_SELECT_PROGRAM].incremented_variable = &program_index_;
@@ -891,10 +894,24 @@ void Ui::DoEvents() {
     }
   }
 
-  if (multi.recording()) {
+  // Polled content (recording status, sequencer phase, idle flashes) is only
+  // formatted once per display refresh, at 1kHz
+  uint32_t now = system_clock.milliseconds();
+  bool display_tick = now != display_tick_;
+  display_tick_ = now;
+
+  if (multi.recording() && display_tick) {
     refresh_display = true;
   }
 
+  if (multi.settings_version() != settings_version_) {
+    // Settings can also be written by CC, program change, or SysEx
+    settings_version_ = multi.settings_version();
+    if (mode_ == UI_MODE_PARAMETER_EDIT) {
+      refresh_display = true;
+    }
+  }
+
   if (mode_ == UI_MODE_LEARNING && !multi.learning()) {
     OnClickLearning(Event());
   }
@@ -965,7 +982,7 @@ void Ui::DoEvents() {
     }
     return;
   }
-  if (display_.scrolling()) { return; }
+  if (display_.scrolling() || !display_tick) { return; }
 
   // If display is idle, flash various statuses
   bool print_latch =
@@ -1052,6 +1069,6 @@ void Ui::PrintLatch() {
 }
 
 /* extern */
-Ui ui;
+INSTANCE_STATE Ui ui;
 
 }  // namespace yarns
@@ -39,6 +39,7 @@
 #include "yarns/drivers/encoder.h"
 #include "yarns/drivers/switches.h"
 
+#include "yarns/instance_state.h"
 #include "yarns/settings.h"
 #include "yarns/menu.h"
 #include "yarns/storage_manager.h"
@@ -116,9 +117,6 @@ class Ui {
   void Init();
   void Poll();
   void PollSwitch(const UiSwitch ui_switch, uint32_t& press_time, bool& long_press_event_sent);
-  void PollFast() {
-    display_.RefreshFast();
-  }
   void DoEvents();
   void FlushEvents();
   void SplashOn(Splash splash);
@@ -311,10 +309,13 @@ class Ui {
   bool tap_tempo_resolved_;
   uint32_t previous_tap_time_;
   
+  uint32_t display_tick_;
+  uint8_t settings_version_;
+  
   DISALLOW_COPY_AND_ASSIGN(Ui);
 };
 
-extern Ui ui;
+extern INSTANCE_STATE Ui ui;
 
 }  // namespace yarns
 
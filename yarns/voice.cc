@@ -46,6 +46,13 @@ const int32_t kOctave = 12 << 7;
 const int32_t kMaxNote = 120 << 7;
 const int32_t kQuadrature = 0x40000000;
 
+#ifdef TEST
+// The aux sources that Refresh computes rather than MIDI events
+const uint8_t kRefreshAuxSources[] = {
+  MOD_AUX_VELOCITY, MOD_AUX_MODULATION, MOD_AUX_BEND,
+  MOD_AUX_VIBRATO_LFO, MOD_AUX_FULL_LFO, MOD_AUX_ENVELOPE
+};
+#endif  // TEST
 const uint8_t kLowFreqRefresh = 32; // 4 kHz / 32 = 125 Hz (the ~minimum that doesn't cause obvious LFO sampling error)
 
 void Voice::Init() {
@@ -53,6 +60,7 @@ void Voice::Init() {
   note_ = -1;
   note_source_ = note_target_ = note_portamento_ = 60 << 7;
   gate_ = false;
+  gate_time_ = 0;
   
   mod_velocity_ = 0x7f;
   ResetAllControllers();
@@ -69,6 +77,14 @@ void Voice::Init() {
   timbre_init_current_ = 0;
 
   refresh_counter_ = 0;
+  num_aux_routes_ = 0;
+  mod_routes_ = 0;
+  // Glides all interpolators to their neutral value during the first period
+  mod_routes_last_ = MOD_ROUTE_ALL;
+  mod_routes_running_ = MOD_ROUTE_ALL;
+#ifdef TEST
+  dense_mod_routes_ = false;
+#endif  // TEST
   pitch_lfo_interpolator_.Init(kLowFreqRefresh);
   timbre_lfo_interpolator_.Init(kLowFreqRefresh);
   amplitude_lfo_interpolator_.Init(kLowFreqRefresh);
@@ -96,7 +112,12 @@ void CVOutput::Init(bool reset_calibration) {
     for (uint8_t i = 0; i < kNumOctaves; ++i) {
       calibrated_dac_code_[i] = 54586 - 5133 * i;
     }
+    std::fill(
+        &half_octave_trim_[0],
+        &half_octave_trim_[kNumHalfOctaveTrims],
+        0);
   }
+  CompilePitchMap();
   dirty_ = false;
 
   dac_interpolator_.Init(10); // 40 kHz / 4 kHz
@@ -108,6 +129,28 @@ void CVOutput::Calibrate(uint16_t* calibrated_dac_code) {
       &calibrated_dac_code[0],
       &calibrated_dac_code[kNumOctaves],
       &calibrated_dac_code_[0]);
+  dirty_ = true;
+}
+
+void CVOutput::CompilePitchMap() {
+  const uint8_t kSegmentsPerOctave = kOctave >> kPitchMapSegmentBits;
+  const uint8_t kSegmentsPerHalfOctave = kSegmentsPerOctave >> 1;
+  for (uint8_t i = 0; i < kPitchMapSize; ++i) {
+    uint8_t octave = i / kSegmentsPerOctave;
+    uint8_t segment = i % kSegmentsPerOctave;
+    int32_t code = calibrated_dac_code_[octave];
+    if (segment) {
+      int32_t b = calibrated_dac_code_[octave + 1];
+      code += (b - code) * segment / kSegmentsPerOctave;
+      // The trim is fully applied at the half octave and fades out towards
+      // both octave points
+      uint8_t weight = segment <= kSegmentsPerHalfOctave
+          ? segment : kSegmentsPerOctave - segment;
+      code += half_octave_trim_[octave] * weight / kSegmentsPerHalfOctave;
+      CONSTRAIN(code, 0, 65535);
+    }
+    pitch_map_[i] = code;
+  }
 }
 
 uint16_t CVOutput::NoteToDacCode(int32_t note) const {
@@ -117,21 +160,16 @@ uint16_t CVOutput::NoteToDacCode(int32_t note) const {
   if (note >= kMaxNote) {
     note = kMaxNote - 1;
   }
-  uint8_t octave = 0;
-  while (note >= kOctave) {
-    note -= kOctave;
-    ++octave;
-  }
-  
-  // Note is now between 0 and kOctave
-  // Octave indicates the octave. Look up in the DAC code table.
-  int32_t a = calibrated_dac_code_[octave];
-  int32_t b = calibrated_dac_code_[octave + 1];
-  return a + ((b - a) * note / kOctave);
+  int32_t a = pitch_map_[note >> kPitchMapSegmentBits];
+  int32_t b = pitch_map_[(note >> kPitchMapSegmentBits) + 1];
+  int32_t fraction = note & ((1 << kPitchMapSegmentBits) - 1);
+  return a + ((b - a) * fraction >> kPitchMapSegmentBits);
 }
 
 void Voice::ResetAllControllers() {
   mod_pitch_bend_ = 8192;
+  mod_note_pitch_bend_ = 8192;
+  mod_note_timbre_ = 64;
   vibrato_mod_ = 0;
   std::fill(&mod_aux_[0], &mod_aux_[MOD_AUX_LAST - 1], 0);
 }
@@ -167,6 +205,7 @@ void Voice::Refresh() {
   
   // Add pitch-bend.
   note += static_cast<int32_t>(mod_pitch_bend_ - 8192) * pitch_bend_range_ >> 6;
+  note += static_cast<int32_t>(mod_note_pitch_bend_ - 8192) * kMPENotePitchBendRange >> 6;
   
   // Add transposition/fine tuning.
   note += tuning_;
@@ -179,27 +218,59 @@ void Voice::Refresh() {
   int32_t vibrato_lfo = lfo_value(LFO_ROLE_PITCH);
 
   if (refresh_counter_ == 0) {
-    uint16_t tremolo_lfo = 32767 - lfo_value(LFO_ROLE_AMPLITUDE);
-    uint16_t scaled_tremolo_lfo = tremolo_lfo * tremolo_mod_current_ >> 16;
-    amplitude_lfo_interpolator_.SetTarget((UINT16_MAX - scaled_tremolo_lfo) >> 1);
-    amplitude_lfo_interpolator_.ComputeSlope();
-
-    int32_t timbre_lfo_15 = lfo_value(LFO_ROLE_TIMBRE) * timbre_mod_lfo_current_ >> (31 - 15);
-    timbre_lfo_interpolator_.SetTarget(timbre_lfo_15);
-    timbre_lfo_interpolator_.ComputeSlope();
-
-    scaled_vibrato_lfo_interpolator_.SetTarget(vibrato_lfo * vibrato_mod_ >> 8);
-    scaled_vibrato_lfo_interpolator_.ComputeSlope();
-    int32_t pitch_lfo_15 = scaled_vibrato_lfo_interpolator_.target() * vibrato_range_ >> 8;
-    pitch_lfo_interpolator_.SetTarget(pitch_lfo_15);
-    pitch_lfo_interpolator_.ComputeSlope();
+    uint8_t routes = mod_routes_;
+    // Depths are slewed: a route stays on until its depth has faded out
+    if (tremolo_mod_current_) {
+      routes |= MOD_ROUTE_TREMOLO;
+    }
+    if (timbre_mod_lfo_current_) {
+      routes |= MOD_ROUTE_TIMBRE_LFO;
+    }
+    // A route that just went off glides back to its neutral value over one
+    // more period, and is then left alone
+    uint8_t stopping = mod_routes_last_ & ~routes;
+    mod_routes_last_ = routes;
+    mod_routes_running_ = routes | stopping;
+
+    if (routes & MOD_ROUTE_TREMOLO) {
+      uint16_t tremolo_lfo = 32767 - lfo_value(LFO_ROLE_AMPLITUDE);
+      uint16_t scaled_tremolo_lfo = tremolo_lfo * tremolo_mod_current_ >> 16;
+      amplitude_lfo_interpolator_.SetTarget((UINT16_MAX - scaled_tremolo_lfo) >> 1);
+      amplitude_lfo_interpolator_.ComputeSlope();
+    } else if (stopping & MOD_ROUTE_TREMOLO) {
+      amplitude_lfo_interpolator_.SetTarget(UINT16_MAX >> 1);
+      amplitude_lfo_interpolator_.ComputeSlope();
+    }
+
+    if (mod_routes_running_ & MOD_ROUTE_TIMBRE_LFO) {
+      int32_t timbre_lfo_15 = routes & MOD_ROUTE_TIMBRE_LFO
+          ? lfo_value(LFO_ROLE_TIMBRE) * timbre_mod_lfo_current_ >> (31 - 15)
+          : 0;
+      timbre_lfo_interpolator_.SetTarget(timbre_lfo_15);
+      timbre_lfo_interpolator_.ComputeSlope();
+    }
+
+    if (mod_routes_running_ & MOD_ROUTE_VIBRATO) {
+      scaled_vibrato_lfo_interpolator_.SetTarget(routes & MOD_ROUTE_VIBRATO
+          ? vibrato_lfo * vibrato_mod_ >> 8 : 0);
+      scaled_vibrato_lfo_interpolator_.ComputeSlope();
+      int32_t pitch_lfo_15 = scaled_vibrato_lfo_interpolator_.target() * vibrato_range_ >> 8;
+      pitch_lfo_interpolator_.SetTarget(pitch_lfo_15);
+      pitch_lfo_interpolator_.ComputeSlope();
+    }
   }
   refresh_counter_ = (refresh_counter_ + 1) % kLowFreqRefresh;
 
-  pitch_lfo_interpolator_.Tick();
-  timbre_lfo_interpolator_.Tick();
-  amplitude_lfo_interpolator_.Tick();
-  scaled_vibrato_lfo_interpolator_.Tick();
+  if (mod_routes_running_ & MOD_ROUTE_VIBRATO) {
+    pitch_lfo_interpolator_.Tick();
+    scaled_vibrato_lfo_interpolator_.Tick();
+  }
+  if (mod_routes_running_ & MOD_ROUTE_TIMBRE_LFO) {
+    timbre_lfo_interpolator_.Tick();
+  }
+  if (mod_routes_running_ & MOD_ROUTE_TREMOLO) {
+    amplitude_lfo_interpolator_.Tick();
+  }
 
   note += pitch_lfo_interpolator_.value();
 
@@ -207,22 +278,49 @@ void Voice::Refresh() {
   int32_t timbre_15 =
     (timbre_init_current_ >> (16 - 15)) +
     (timbre_envelope_31 >> (31 - 15)) +
-    timbre_lfo_interpolator_.value();
+    timbre_lfo_interpolator_.value() +
+    ((mod_note_timbre_ - 64) << (15 - 7));
   CONSTRAIN(timbre_15, 0, (1 << 15) - 1);
 
   uint16_t tremolo_drone = amplitude_lfo_interpolator_.value() << 1;
-  uint16_t tremolo_envelope = envelope_.value() * tremolo_drone >> 16;
+  uint16_t tremolo_envelope = static_cast<uint32_t>(envelope_.value()) * tremolo_drone >> 16;
   uint16_t gain = oscillator_mode_ == OSCILLATOR_MODE_ENVELOPED ?
     tremolo_envelope : tremolo_drone;
 
   oscillator_.Refresh(note, timbre_15, gain);
 
-  mod_aux_[MOD_AUX_VELOCITY] = mod_velocity_ << 9;
-  mod_aux_[MOD_AUX_MODULATION] = vibrato_mod_ << 9;
-  mod_aux_[MOD_AUX_BEND] = static_cast<uint16_t>(mod_pitch_bend_) << 2;
-  mod_aux_[MOD_AUX_VIBRATO_LFO] = (scaled_vibrato_lfo_interpolator_.value() << 1) + 32768;
-  mod_aux_[MOD_AUX_FULL_LFO] = vibrato_lfo + 32768;
-  mod_aux_[MOD_AUX_ENVELOPE] = tremolo_envelope;
+  const uint8_t* aux_routes = aux_routes_;
+  uint8_t num_aux_routes = num_aux_routes_;
+#ifdef TEST
+  if (dense_mod_routes_) {
+    aux_routes = kRefreshAuxSources;
+    num_aux_routes = sizeof(kRefreshAuxSources);
+  }
+#endif  // TEST
+  for (uint8_t i = 0; i < num_aux_routes; ++i) {
+    uint16_t value = 0;
+    switch (aux_routes[i]) {
+      case MOD_AUX_VELOCITY:
+        value = mod_velocity_ << 9;
+        break;
+      case MOD_AUX_MODULATION:
+        value = vibrato_mod_ << 9;
+        break;
+      case MOD_AUX_BEND:
+        value = static_cast<uint16_t>(mod_pitch_bend_) << 2;
+        break;
+      case MOD_AUX_VIBRATO_LFO:
+        value = (scaled_vibrato_lfo_interpolator_.value() << 1) + 32768;
+        break;
+      case MOD_AUX_FULL_LFO:
+        value = vibrato_lfo + 32768;
+        break;
+      case MOD_AUX_ENVELOPE:
+        value = tremolo_envelope;
+        break;
+    }
+    mod_aux_[aux_routes[i]] = value;
+  }
 
   if (retrigger_delay_) {
     --retrigger_delay_;
@@ -245,12 +343,16 @@ void Voice::Refresh() {
 
 void CVOutput::Refresh() {
   if (is_audio()) return;
+  bool recalibrated = dirty_;
+  if (recalibrated) {
+    CompilePitchMap();
+    dirty_ = false;
+  }
   if (dc_role_ == DC_PITCH) {
     int32_t note = dc_voice_->note();
-    if (dirty_ || note_ != note) {
+    if (recalibrated || note_ != note) {
       note_dac_code_ = NoteToDacCode(note);
     }
-    dirty_ = false;
     note_ = note;
   }
   dac_interpolator_.SetTarget((this->*dc_fn_table_[dc_role_])() >> 1);
@@ -270,7 +372,11 @@ void Voice::NoteOn(
 
   portamento_phase_ = 0;
   uint32_t split_point = LUT_PORTAMENTO_INCREMENTS_SIZE >> 1;
-  if (portamento < split_point) {
+  if (!portamento) {
+    // Nothing to glide over, and the table stops one entry short of it
+    portamento_phase_increment_ = 1U << 31;
+    portamento_exponential_shape_ = true;
+  } else if (portamento < split_point) {
     portamento_phase_increment_ = lut_portamento_increments[(split_point - portamento) << 1];
     portamento_exponential_shape_ = true;
   } else {
@@ -285,6 +391,9 @@ void Voice::NoteOn(
 
   if (gate_ && trigger) {
     retrigger_delay_ = 3;
+    gate_time_ = gate_scheduler.now() + kRetriggerDip;
+  } else if (!gate_) {
+    gate_time_ = gate_scheduler.now();
   }
   if (trigger) {
     trigger_pulse_ = trigger_duration_ * 2;
@@ -297,10 +406,53 @@ void Voice::NoteOn(
 }
 
 void Voice::NoteOff() {
+  if (gate_) {
+    gate_time_ = gate_scheduler.now();
+  }
   gate_ = false;
   envelope_.GateOff();
 }
 
+void Voice::CompileModRoutes() {
+  mod_routes_ = 0;
+#ifdef TEST
+  if (dense_mod_routes_) {
+    mod_routes_ = MOD_ROUTE_ALL;
+    return;
+  }
+#endif  // TEST
+  // The scaled vibrato LFO is kept up to date even without a pitch range, so
+  // that an aux output switched to it starts from the same value
+  if (vibrato_mod_ ||
+      aux_cv_source_ == MOD_AUX_VIBRATO_LFO ||
+      aux_cv_source_2_ == MOD_AUX_VIBRATO_LFO) {
+    mod_routes_ |= MOD_ROUTE_VIBRATO;
+  }
+  if (timbre_mod_lfo_target_) {
+    mod_routes_ |= MOD_ROUTE_TIMBRE_LFO;
+  }
+  if (tremolo_mod_target_) {
+    mod_routes_ |= MOD_ROUTE_TREMOLO;
+  }
+
+  num_aux_routes_ = 0;
+  uint8_t sources[2] = { aux_cv_source_, aux_cv_source_2_ };
+  for (uint8_t i = 0; i < 2; ++i) {
+    switch (sources[i]) {
+      case MOD_AUX_VELOCITY:
+      case MOD_AUX_MODULATION:
+      case MOD_AUX_BEND:
+      case MOD_AUX_VIBRATO_LFO:
+      case MOD_AUX_FULL_LFO:
+      case MOD_AUX_ENVELOPE:
+        if (!num_aux_routes_ || aux_routes_[0] != sources[i]) {
+          aux_routes_[num_aux_routes_++] = sources[i];
+        }
+        break;
+    }
+  }
+}
+
 void Voice::ControlChange(uint8_t controller, uint8_t value) {
   switch (controller) {
     case kCCBreathController:
@@ -34,6 +34,7 @@
 #include "stmlib/utils/ring_buffer.h"
 
 #include "yarns/envelope.h"
+#include "yarns/gate_scheduler.h"
 #include "yarns/oscillator.h"
 #include "yarns/interpolator.h"
 #include "yarns/synced_lfo.h"
@@ -42,6 +43,19 @@
 namespace yarns {
 
 const uint16_t kNumOctaves = 11;
+// Length of the gap between two retriggered notes, in gate scheduler ticks
+// (3 refreshes at 4 kHz)
+const uint16_t kRetriggerDip = 750;
+// Optional trims at the midpoint of each octave, relative to the straight line
+// between the octave calibration points
+const uint16_t kNumHalfOctaveTrims = kNumOctaves - 1;
+// The calibration compiles into one pitch map entry per whole tone, so that a
+// 7-bit fractional note splits into segment and fraction with shifts alone.
+// This costs 61 x 2 = 122 bytes of RAM per output, 488 bytes in all.
+const uint8_t kPitchMapSegmentBits = 8;
+const uint16_t kPitchMapSize = ((120 << 7) >> kPitchMapSegmentBits) + 1;
+// The MPE default for member channels, in semitones
+const uint8_t kMPENotePitchBendRange = 48;
 
 enum TriggerShape {
   TRIGGER_SHAPE_SQUARE,
@@ -83,6 +97,14 @@ enum ModAux {
   MOD_AUX_LAST
 };
 
+// LFO modulations a voice has to compute, compiled from its settings
+enum ModRoute {
+  MOD_ROUTE_VIBRATO = 1 << 0,  // Pitch LFO to pitch or to an aux output
+  MOD_ROUTE_TIMBRE_LFO = 1 << 1,
+  MOD_ROUTE_TREMOLO = 1 << 2,
+  MOD_ROUTE_ALL = (1 << 3) - 1
+};
+
 // A role used by a CV output when it is not acting as an audio oscillator
 enum DCRole {
   DC_PITCH,
@@ -122,6 +144,12 @@ class Voice {
   void Aftertouch(uint8_t velocity) {
     mod_aux_[MOD_AUX_AFTERTOUCH] = velocity << 9;
   }
+  // MPE per-note bend, pressure, and CC74
+  void NoteExpression(uint16_t pitch_bend, uint8_t pressure, uint8_t timbre) {
+    mod_note_pitch_bend_ = pitch_bend;
+    mod_aux_[MOD_AUX_AFTERTOUCH] = pressure << 9;
+    mod_note_timbre_ = timbre;
+  }
 
   void garbage(uint8_t x);
   inline void set_pitch_bend_range(uint8_t pitch_bend_range) {
@@ -152,8 +180,15 @@ class Voice {
   }
   inline void set_aux_cv(uint8_t i) { aux_cv_source_ = i; }
   inline void set_aux_cv_2(uint8_t i) { aux_cv_source_2_ = i; }
+  // Once the setters are done, lists the modulations that Refresh computes
+  void CompileModRoutes();
+#ifdef TEST
+  // Reference for the host tests: every route computed on every refresh
+  inline void set_dense_mod_routes(bool dense) { dense_mod_routes_ = dense; }
+#endif  // TEST
   
   inline int32_t note() const { return note_; }
+  inline uint16_t pitch_bend() const { return mod_pitch_bend_; }
   inline uint8_t velocity() const { return mod_velocity_; }
   inline uint16_t mod_aux(ModAux s) const { return mod_aux_[s]; }
   inline uint16_t aux_cv_16bit() const { return mod_aux_[aux_cv_source_]; }
@@ -164,6 +199,12 @@ class Voice {
   inline bool gate_on() const { return gate_; }
 
   inline bool gate() const { return gate_ && !retrigger_delay_; }
+  // Also reports when the current gate level started, for the edge scheduler
+  inline bool gate(uint16_t* time) const {
+    bool level = gate();
+    *time = gate_ && !level ? gate_time_ - kRetriggerDip : gate_time_;
+    return level;
+  }
   inline bool trigger() const  {
     return gate_ && trigger_pulse_;
   }
@@ -176,6 +217,9 @@ class Voice {
   inline void set_oscillator_shape(uint8_t s) {
     oscillator_.set_shape(static_cast<OscillatorShape>(s));
   }
+  inline void set_oscillator_quality(uint8_t q) {
+    oscillator_.set_quality(static_cast<OscillatorQuality>(q));
+  }
   inline void set_timbre_init(uint8_t n) {
     timbre_init_target_ = n << (16 - 7); }
   inline void set_timbre_mod_lfo(uint8_t n) {
@@ -238,6 +282,8 @@ class Voice {
   bool gate_;
   
   int16_t mod_pitch_bend_;
+  int16_t mod_note_pitch_bend_;
+  uint8_t mod_note_timbre_;
   uint16_t mod_aux_[MOD_AUX_LAST];
   uint8_t mod_velocity_;
   
@@ -253,6 +299,16 @@ class Voice {
   LFOShape lfo_shapes_[LFO_ROLE_LAST];
   uint8_t aux_cv_source_;
   uint8_t aux_cv_source_2_;
+  // Aux sources that are computed by Refresh rather than set by MIDI events
+  uint8_t aux_routes_[2];
+  uint8_t num_aux_routes_;
+  uint8_t mod_routes_;
+  // Routes that were on during the previous low-frequency period
+  uint8_t mod_routes_last_;
+  uint8_t mod_routes_running_;
+#ifdef TEST
+  bool dense_mod_routes_;
+#endif  // TEST
   
   uint32_t portamento_phase_;
   uint32_t portamento_phase_increment_;
@@ -263,6 +319,9 @@ class Voice {
   // retrigger command. This happens with note-stealing; or when sending a MIDI
   // sequence with overlapping notes.
   uint16_t retrigger_delay_;
+  // When the gate opened (or is due to reopen, after a retrigger dip) or
+  // closed, in gate scheduler ticks
+  uint16_t gate_time_;
   
   uint16_t trigger_pulse_;
   uint32_t trigger_phase_increment_;
@@ -307,7 +366,7 @@ class CVOutput {
     num_audio_voices_ = num_audio;
     zero_dac_code_ = volts_dac_code(0);
     uint16_t scale = volts_dac_code(0) - volts_dac_code(5); // 5Vpp
-    scale /= num_audio_voices_;
+    if (num_audio_voices_) scale /= num_audio_voices_; // DC-only outputs
     for (uint8_t i = 0; i < num_audio_voices_; ++i) {
       Voice* audio_voice = audio_voices_[i] = dc_voice_ + i;
       audio_voice->oscillator()->Init(scale);
@@ -322,6 +381,12 @@ class CVOutput {
     }
     return false;
   }
+  inline bool gate(uint16_t* time) const {
+    if (!is_audio()) return dc_voice_->gate(time);
+    // Combined gate of several voices: timestamped at the refresh
+    *time = gate_scheduler.now();
+    return gate();
+  }
   inline bool trigger() const {
     if (!is_audio()) return dc_voice_->trigger();
     for (uint8_t i = 0; i < num_audio_voices_; ++i) {
@@ -404,12 +469,22 @@ class CVOutput {
     dirty_ = true;
   }
 
+  inline int16_t half_octave_trim(uint8_t octave) const {
+    return half_octave_trim_[octave];
+  }
+
+  inline void set_half_octave_trim(uint8_t octave, int16_t trim) {
+    half_octave_trim_[octave] = trim;
+    dirty_ = true;
+  }
+
   inline uint16_t volts_dac_code(int8_t volts) const {
     return calibration_dac_code(volts + 3);
   }
 
  private:
   uint16_t NoteToDacCode(int32_t note) const;
+  void CompilePitchMap();
 
   Voice* dc_voice_;
   Voice* audio_voices_[kNumMaxVoicesPerPart];
@@ -421,6 +496,8 @@ class CVOutput {
   bool dirty_;  // Set to true when the calibration settings have changed.
   uint16_t zero_dac_code_;
   uint16_t calibrated_dac_code_[kNumOctaves];
+  int16_t half_octave_trim_[kNumHalfOctaveTrims];
+  uint16_t pitch_map_[kPitchMapSize];
   Interpolator dac_interpolator_;
 
   DISALLOW_COPY_AND_ASSIGN(CVOutput);
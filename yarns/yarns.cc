@@ -65,6 +65,7 @@ extern "C" {
 
 uint16_t cv[4];
 bool gate[4];
+uint16_t gate_time[4];
 bool has_audio_source[4];
 bool has_envelope[4];
 uint16_t factory_testing_counter;
@@ -77,7 +78,6 @@ void SysTick_Handler() {
     ui.Poll();
     system_clock.Tick();
   }
-  ui.PollFast(); // Display refresh at 8kHz
   
   // Try to read some MIDI input if available.
   if (midi_io.readable()) {
@@ -99,16 +99,10 @@ void SysTick_Handler() {
   }
 
   bool refresh = (counter & 1) == 0; // Sample rate = 4 kHz
-  if (refresh) {
-    // Observe that the gate output is written with a systick * 2 (0.25 ms) delay
-    // compared to the CV output. This ensures that the CV output will have been
-    // refreshed to the right value when the trigger/gate is sent.
-    gate_output.Write(gate);
-  }
   multi.ClockFast();
   if (refresh) {
     multi.Refresh();
-    multi.GetCvGate(cv, gate);
+    multi.GetCvGate(cv, gate, gate_time);
 
     has_audio_source[0] = multi.cv_output(0).is_audio();
     has_audio_source[1] = multi.cv_output(1).is_audio();
@@ -141,28 +135,40 @@ void SysTick_Handler() {
     }
     
     dac.Write(cv);
+
+    // Gate edges are output kGateLatency after their source, which is late
+    // enough for the CV written above to have reached the DAC.
+    for (uint8_t i = 0; i < kNumGateOutputs; ++i) {
+      gate_scheduler.Submit(i, gate[i], gate_time[i]);
+    }
+    gate_output.Schedule(&gate_scheduler);
   }
 }
 
-void TIM1_UP_IRQHandler(void) {
-  // DAC refresh at 4x 40kHz.
-  if (TIM_GetITStatus(TIM1, TIM_IT_Update) == RESET) {
-    return;
-  }
-  TIM_ClearITPendingBit(TIM1, TIM_IT_Update);
-
-  dac.Cycle();
-  if (has_audio_source[dac.channel()]) {
-    dac.Write(multi.mutable_cv_output(dac.channel())->GetAudioSample());
-  } else if (has_envelope[dac.channel()]) {
-    dac.Write(multi.mutable_cv_output(dac.channel())->GetEnvelopeSample());
-  } else {
-    // Use value written there during previous CV refresh.
-    dac.Write();
-  }
-  
-  if (dac.channel() == 0) {
-    // Internal clock refresh at 40kHz
+void TIM2_IRQHandler(void) {
+  // Gate edges, each at its scheduled microsecond.
+  gate_output.OnCompare();
+}
+
+void DMA1_Channel4_IRQHandler(void) {
+  // DAC refresh at 4x 40kHz, one block at a time.
+  uint8_t half = dac.AcknowledgeTransfer();
+  for (uint8_t frame = 0; frame < kDacBlockSize; ++frame) {
+    for (uint8_t channel = 0; channel < kNumChannels; ++channel) {
+      uint16_t value;
+      if (has_audio_source[channel]) {
+        value = multi.mutable_cv_output(channel)->GetAudioSample();
+      } else if (has_envelope[channel]) {
+        value = multi.mutable_cv_output(channel)->GetEnvelopeSample();
+      } else {
+        // Use value written there during previous CV refresh.
+        value = dac.value(channel);
+      }
+      dac.WriteSample(half, frame, channel, value);
+    }
+    // Internal clock refresh at 40kHz, in bursts of one block. A tick can be
+    // counted up to 100us early, under 1.5% of the shortest tick (240 BPM at
+    // full swing), and the main loop that plays it adds more jitter anyway.
     multi.RefreshInternalClock();
   }
 }
@@ -171,6 +177,8 @@ void TIM1_UP_IRQHandler(void) {
 
 void Init() {
   sys.Init();
+  gate_output.Init();
+  gate_scheduler.Init(gate_output.mutable_counter());
   
   setting_defs.Init();
   multi.Init(true);
@@ -181,22 +189,29 @@ void Init() {
   storage_manager.LoadCalibration(); // Can disable to reset calibration
   
   system_clock.Init();
-  gate_output.Init();
   dac.Init();
   midi_io.Init();
   midi_handler.Init();
   sys.StartTimers();
 }
 
+void RunLowPriorityTasks() {
+  ui.DoEvents();
+  midi_handler.ProcessInput();
+  multi.LowPriority();
+  if (midi_handler.factory_testing_requested()) {
+    midi_handler.AcknowledgeFactoryTestingRequest();
+    ui.StartFactoryTesting();
+  }
+}
+
+#ifndef TEST
+
 int main(void) {
   Init();
   while (1) {
-    ui.DoEvents();
-    midi_handler.ProcessInput();
-    multi.LowPriority();
-    if (midi_handler.factory_testing_requested()) {
-      midi_handler.AcknowledgeFactoryTestingRequest();
-      ui.StartFactoryTesting();
-    }
+    RunLowPriorityTasks();
   }
 }
+
+#endif  // TEST